@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hft {
+namespace bench {
+
+// Keeps the optimizer from discarding a benchmarked result
+template <typename T>
+inline void keep(const T& v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &v;
+    (void)sink;
+#endif
+}
+
+// Heap traffic seen by the replaced operator new in bench_main.cpp
+inline std::atomic<std::size_t>& alloc_count() {
+    static std::atomic<std::size_t> n{0};
+    return n;
+}
+inline std::atomic<std::size_t>& alloc_bytes() {
+    static std::atomic<std::size_t> n{0};
+    return n;
+}
+
+// Process peak resident set in KiB; reset_peak_rss() restarts the high-water
+// mark where the OS allows it (Linux), elsewhere the peak only grows
+std::size_t peak_rss_kb();
+void reset_peak_rss();
+
+struct Result {
+    std::string label;
+    std::size_t items = 0;         // elements (bars, rows, ...) per call
+    std::size_t iterations = 0;
+    double ns_per_item = 0;
+    double items_per_sec = 0;
+    double gb_per_sec = 0;         // 0 unless the case reported bytes
+    double allocs_per_iter = 0;
+    double alloc_bytes_per_iter = 0;
+    std::size_t peak_rss_kb = 0;
+};
+
+class Runner;
+
+// A registered case; every label it measures starts with group
+struct Case {
+    const char* name;
+    const char* group;
+    void (*fn)(Runner&);
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const char* name, const char* group, void (*fn)(Runner&)) { registry().push_back({name, group, fn}); }
+};
+
+class Runner {
+public:
+    // min_seconds > 0 overrides every case's own minimum
+    explicit Runner(std::string filter, double min_seconds = 0)
+        : filter_(std::move(filter)), min_seconds_(min_seconds) {}
+
+    // Times fn() (which processes `items` elements per call) until at least
+    // min_seconds have elapsed and reports ns per element, heap allocations
+    // per call and the peak RSS reached while the case ran. A non-zero
+    // `bytes` (input bytes touched per call) adds a GB/s column.
+    template <class Fn>
+    void measure(const std::string& label, std::size_t items, Fn&& fn, double min_seconds = 0.2,
+                 std::size_t bytes = 0) {
+        if (!filter_.empty() && label.find(filter_) == std::string::npos) return;
+        if (min_seconds_ > 0) min_seconds = min_seconds_;
+        reset_peak_rss();
+        fn(); // warm-up
+        std::size_t a0 = alloc_count().load(std::memory_order_relaxed);
+        std::size_t b0 = alloc_bytes().load(std::memory_order_relaxed);
+        std::size_t iters = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        double secs = 0;
+        do {
+            fn();
+            ++iters;
+            secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        } while (secs < min_seconds);
+        std::size_t allocs = alloc_count().load(std::memory_order_relaxed) - a0;
+        std::size_t alloc_bytes_used = alloc_bytes().load(std::memory_order_relaxed) - b0;
+
+        Result res;
+        res.label = label;
+        res.items = items;
+        res.iterations = iters;
+        res.ns_per_item = secs * 1e9 / ((double)iters * (items ? items : 1));
+        res.items_per_sec = 1e9 / res.ns_per_item;
+        if (bytes) res.gb_per_sec = (double)bytes * iters / secs / 1e9;
+        res.allocs_per_iter = (double)allocs / iters;
+        res.alloc_bytes_per_iter = (double)alloc_bytes_used / iters;
+        res.peak_rss_kb = peak_rss_kb();
+        std::printf("%-48s %12.2f ns/item %14.0f items/s %10.1f allocs %8.1f MB", label.c_str(), res.ns_per_item,
+                    res.items_per_sec, res.allocs_per_iter, res.peak_rss_kb / 1024.0);
+        if (bytes) std::printf(" %8.2f GB/s", res.gb_per_sec);
+        std::printf("\n");
+        results_.push_back(std::move(res));
+    }
+
+    // Whether a case of this group can have a label the filter selects, so
+    // its setup is worth running. A filter inside some group's name or
+    // starting with it picks those groups; any other filter can only match
+    // label tails, which every group may have.
+    bool wants(const std::string& group) const {
+        if (filter_.empty()) return true;
+        auto names = [&](const std::string& g) {
+            return g.find(filter_) != std::string::npos || filter_.compare(0, g.size(), g) == 0;
+        };
+        for (const Case& c : registry()) {
+            if (names(c.group)) return names(group);
+        }
+        return true;
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    std::string filter_;
+    double min_seconds_;
+    std::vector<Result> results_;
+};
+
+}
+}
+
+// Defines and registers a benchmark case whose labels all start with group:
+// HFT_BENCH(name, "group/") { r.measure("group/...", ...); }
+#define HFT_BENCH(name, group)                                                \
+    static void name(::hft::bench::Runner& r);                                \
+    static ::hft::bench::Registrar name##_registrar(#name, group, &name);     \
+    static void name(::hft::bench::Runner& r)
@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "backtester_t.hpp"
+#include "strategies/mean_reversion.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// Same run through the virtual Strategy interface and through BacktesterT
+// instantiated on the final strategy class; items are bars
+HFT_BENCH(bench_backtester, "backtest/") {
+    const int n = 1000000;
+    auto cols = generate_random_walk_columns(n);
+    BarView v = cols.view();
+    CostModel costs{0.0, 1.0};
+
+    r.measure("backtest/momentum/virtual/1000000", n, [&] {
+        MomentumStrategy s(20, 1);
+        Strategy& base = s;
+        bench::keep(Backtester::run(v, base, costs).final_equity);
+    });
+    r.measure("backtest/momentum/template/1000000", n, [&] {
+        MomentumStrategy s(20, 1);
+        bench::keep(BacktesterT<MomentumStrategy>::run(v, s, costs).final_equity);
+    });
+    r.measure("backtest/meanrev/virtual/1000000", n, [&] {
+        MeanReversionStrategy s(20, 0.003, 1);
+        Strategy& base = s;
+        bench::keep(Backtester::run(v, base, costs).final_equity);
+    });
+    r.measure("backtest/meanrev/template/1000000", n, [&] {
+        MeanReversionStrategy s(20, 0.003, 1);
+        bench::keep(BacktesterT<MeanReversionStrategy>::run(v, s, costs).final_equity);
+    });
+
+    // Streaming: only online aggregates, so the per-bar step dominates
+    r.measure("backtest/momentum_stream/virtual/1000000", n, [&] {
+        MomentumStrategy s(20, 1);
+        Strategy& base = s;
+        ViewBarSource src(v);
+        bench::keep(Backtester::run_stream(src, base, costs).final_equity);
+    });
+    r.measure("backtest/momentum_stream/template/1000000", n, [&] {
+        MomentumStrategy s(20, 1);
+        ViewBarSource src(v);
+        bench::keep(BacktesterT<MomentumStrategy>::run_stream(src, s, costs).final_equity);
+    });
+}
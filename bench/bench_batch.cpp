@@ -0,0 +1,38 @@
+#include "bench.hpp"
+#include "backtester_t.hpp"
+#include "batch_momentum.hpp"
+#include "simd_kernels.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// 256 momentum lookbacks over the same bars: one streaming run each versus
+// one batched pass; items are bar x configuration steps
+HFT_BENCH(bench_batch, "batch/") {
+    const int n = 100000;
+    auto cols = generate_random_walk_columns(n);
+    BarView v = cols.view();
+    CostModel costs{0.0, 1.0};
+    std::vector<MomentumParams> params;
+    for (int lb = 2; lb < 2 + 256; ++lb) params.push_back({lb, 1});
+    std::size_t steps = params.size() * (std::size_t)n;
+
+    r.measure("batch/momentum256/independent/100000", steps, [&] {
+        double sum = 0;
+        for (const auto& p : params) {
+            MomentumStrategy m(p.lookback, p.qty);
+            ViewBarSource src(v);
+            sum += BacktesterT<MomentumStrategy>::run_stream(src, m, costs).final_equity;
+        }
+        bench::keep(sum);
+    });
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Avx2}) {
+        simd::Isa saved = simd::active_isa();
+        if (!simd::set_isa(isa)) continue;
+        r.measure(std::string("batch/momentum256/batched_") + simd::isa_name(isa) + "/100000", steps, [&] {
+            bench::keep(BatchMomentum::run(v, params, costs).back().final_equity);
+        });
+        simd::set_isa(saved);
+    }
+}
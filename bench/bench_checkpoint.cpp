@@ -0,0 +1,39 @@
+#include "bench.hpp"
+#include "advanced_backtester.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include <cstdio>
+
+using namespace hft;
+
+// Appending one session (390 one-minute bars) to a 1M-bar history: a full
+// rerun over everything versus resume() from the checkpoint at the old end.
+// Items are the appended bars, so ns/item is the cost of each new bar.
+HFT_BENCH(bench_checkpoint, "checkpoint/") {
+    const std::size_t history = 1000000, session = 390;
+    auto bars = generate_random_walk(history + session, 100.0, 0.0002, 0.01);
+    BarView all = BarView::of(bars);
+    RiskControl risk;
+    OrderBook lob{100.0, 2.0, 2.0, 0.5};
+    MomentumStrategy s0(20, 1);
+    AdvancedCheckpoint base;
+    AdvancedBacktester::run("bench", all.slice(0, history), s0, CostModel{}, risk, lob, &base);
+
+    r.measure("checkpoint/full_rerun/390", session, [&] {
+        MomentumStrategy s(20, 1);
+        bench::keep(AdvancedBacktester::run("bench", all, s, CostModel{}, risk, lob).final_equity);
+    });
+    AdvancedCheckpoint cp;
+    AssetBacktest out;
+    r.measure("checkpoint/resume/390", session, [&] {
+        cp = base;
+        MomentumStrategy s(20, 1);
+        AdvancedBacktester::resume("bench", all.slice(history, session), s, CostModel{}, risk, lob, cp, out);
+        bench::keep(out.final_equity);
+    });
+    r.measure("checkpoint/save_load", 1, [&] {
+        const char* path = "bench_checkpoint_tmp.hftk";
+        bench::keep(base.write(path) && cp.read(path));
+        std::remove(path);
+    });
+}
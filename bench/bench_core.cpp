@@ -0,0 +1,60 @@
+#include "bench.hpp"
+#include "advanced_backtester.hpp"
+#include "advanced_reports.hpp"
+#include "backtester.hpp"
+#include "data_loader.hpp"
+#include "indicators.hpp"
+#include "report_writer.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include <cstdio>
+
+using namespace hft;
+
+// Regression suite over the hot paths at three sizes (`hft_bench core`):
+// CSV loading, indicators, both engines and the report writers. Items are
+// bars (report rows for the writers).
+HFT_BENCH(bench_core, "core/") {
+    const char* csv = "bench_core_tmp.csv";
+    const char* report = "bench_core_report_tmp";
+    for (int n : {10000, 100000, 1000000}) {
+        std::string sz = "/" + std::to_string(n);
+        auto bars = generate_random_walk(n);
+        {
+            BufferedWriter w(csv);
+            w.text("ts,open,high,low,close,volume\n");
+            for (const auto& b : bars) {
+                w.integer(b.ts); w.put(','); w.real(b.open); w.put(','); w.real(b.high); w.put(',');
+                w.real(b.low); w.put(','); w.real(b.close); w.put(','); w.real(b.volume); w.put('\n');
+            }
+            w.close();
+        }
+        r.measure("core/load_csv" + sz, bars.size(), [&] { bench::keep(DataLoader::load_csv(csv).size()); });
+        r.measure("core/load_csv_mmap" + sz, bars.size(), [&] { bench::keep(DataLoader::load_csv_mmap(csv).size()); });
+
+        std::vector<double> close(bars.size());
+        for (std::size_t i = 0; i < bars.size(); ++i) close[i] = bars[i].close;
+        r.measure("core/indicators/sma" + sz, close.size(), [&] { bench::keep(sma(close, 20).back()); });
+        r.measure("core/indicators/ema" + sz, close.size(), [&] { bench::keep(ema(close, 20).back()); });
+        r.measure("core/indicators/rsi" + sz, close.size(), [&] { bench::keep(rsi(close, 14).back()); });
+
+        r.measure("core/backtester" + sz, bars.size(), [&] {
+            MomentumStrategy s(20, 1);
+            bench::keep(Backtester::run(bars, s, CostModel{0.0, 1.0}).final_equity);
+        });
+        std::vector<AssetBacktest> results(1);
+        r.measure("core/advanced" + sz, bars.size(), [&] {
+            MomentumStrategy s(20, 1);
+            RiskControl risk;
+            OrderBook lob{100.0, 2.0, 2.0, 0.5};
+            results[0] = AdvancedBacktester::run("bench", bars, s, CostModel{}, risk, lob);
+            bench::keep(results[0].final_equity);
+        });
+
+        r.measure("core/report_csv" + sz, bars.size(), [&] { bench::keep(write_advanced_csv(report, results)); });
+        r.measure("core/report_columnar" + sz, bars.size(), [&] { bench::keep(write_advanced_columnar(report, results)); });
+    }
+    std::remove(csv);
+    for (const char* sfx : {"_summary.csv", "_details.csv", "_equity.csv", ".hftc"})
+        std::remove((std::string(report) + sfx).c_str());
+}
@@ -0,0 +1,55 @@
+#include "bench.hpp"
+#include "feed_replay.hpp"
+#include "itch_feed.hpp"
+#include <cstdio>
+
+using namespace hft;
+
+namespace {
+
+struct Count : MarketEventHandler {
+    std::size_t trades = 0;
+    void on_trade(const TradeEvent&) override { ++trades; }
+};
+
+}
+
+HFT_BENCH(bench_feed, "feed/") {
+    const char* path = "bench_feed_tmp.itch";
+    const std::size_t n = 1000000;
+    if (!write_synthetic_feed(path, {"AAPL", "MSFT", "NVDA", "AMZN"}, n)) return;
+    {
+        FeedReader reader(path);
+        std::size_t bytes = reader.bytes();
+
+        // Decode only: fields straight out of the mapping
+        r.measure("feed/decode/1000000", n, [&] {
+            reader.rewind();
+            MarketEvent ev;
+            std::int64_t sum = 0;
+            while (reader.next(ev)) sum += ev.book.ts_ns;
+            bench::keep(sum);
+        }, 0.2, bytes);
+
+        // Decode + per-symbol L3 books + priced executions
+        r.measure("feed/replay_books/1000000", n, [&] {
+            reader.rewind();
+            Count c;
+            BookReplay books(&c);
+            reader.replay(books);
+            bench::keep(c.trades);
+        }, 0.2, bytes);
+
+        // ... + 1s bars for every symbol
+        r.measure("feed/replay_bars/1000000", n, [&] {
+            reader.rewind();
+            std::size_t bars = 0;
+            BarAggregator agg(1000, [&](std::uint16_t, const Bar&) { ++bars; });
+            BookReplay books(&agg);
+            reader.replay(books);
+            agg.flush();
+            bench::keep(bars);
+        }, 0.2, bytes);
+    }
+    std::remove(path);
+}
@@ -0,0 +1,59 @@
+#include "bench.hpp"
+#include "advanced_backtester.hpp"
+#include "backtester.hpp"
+#include "bar_columns.hpp"
+#include "risk.hpp"
+#include "simd_kernels.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// The same series as std::vector<Bar> (AoS) and BarColumns (SoA), run
+// through close-only loops and through both engines via BarView.
+HFT_BENCH(bench_layout, "layout/") {
+    for (int n : {100000, 1000000}) {
+        auto aos = generate_random_walk(n);
+        auto soa = generate_random_walk_columns(n);
+        struct Layout { const char* name; BarView v; };
+        const Layout layouts[] = {{"aos", BarView::of(aos)}, {"soa", soa.view()}};
+        std::string sz = "/" + std::to_string(n);
+
+        for (const auto& l : layouts) {
+            const BarView& v = l.v;
+            r.measure(std::string("layout/close_sum/") + l.name + sz, v.size(), [&] {
+                double acc = 0;
+                for (std::size_t i = 0; i < v.size(); ++i) acc += v.close(i);
+                bench::keep(acc);
+            });
+            r.measure(std::string("layout/rolling_vol/") + l.name + sz, v.size(), [&] {
+                RollingVolatility vol(20);
+                double acc = 0;
+                for (std::size_t i = 0; i < v.size(); ++i) { vol.update(v.close(i)); acc += vol.value(); }
+                bench::keep(acc);
+            });
+            r.measure(std::string("layout/backtester/") + l.name + sz, v.size(), [&] {
+                MomentumStrategy s(20, 1);
+                bench::keep(Backtester::run(v, s).final_equity);
+            });
+            r.measure(std::string("layout/advanced/") + l.name + sz, v.size(), [&] {
+                MomentumStrategy s(20, 1);
+                RiskControl risk;
+                OrderBook lob{100.0, 2.0, 2.0, 0.5};
+                bench::keep(AdvancedBacktester::run("bench", v, s, CostModel{}, risk, lob).final_equity);
+            });
+        }
+        // Batch SMA straight off the close column, versus gathering closes first
+        std::vector<double> out(soa.size());
+        r.measure("layout/sma_batch/aos_gather" + sz, aos.size(), [&] {
+            std::vector<double> closes(aos.size());
+            for (std::size_t i = 0; i < aos.size(); ++i) closes[i] = aos[i].close;
+            simd::kernels().sma(closes.data(), closes.size(), 20, out.data());
+            bench::keep(out[0]);
+        });
+        r.measure("layout/sma_batch/soa" + sz, soa.size(), [&] {
+            simd::kernels().sma(soa.close(), soa.size(), 20, out.data());
+            bench::keep(out[0]);
+        });
+    }
+}
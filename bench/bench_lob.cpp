@@ -0,0 +1,90 @@
+#include "bench.hpp"
+#include "limit_order_book.hpp"
+#include <random>
+
+using namespace hft;
+
+namespace {
+
+struct Op {
+    int kind; // 0 add, 1 cancel, 2 execute, 3 modify
+    OrderId id;
+    Side side;
+    double price;
+    std::int64_t qty;
+};
+
+// Add-heavy flow around a slowly moving mid, ~5k live orders
+std::vector<Op> make_flow(std::size_t n) {
+    std::mt19937_64 rng(11);
+    std::vector<Op> ops;
+    ops.reserve(n);
+    std::vector<OrderId> live;
+    OrderId next = 1;
+    double mid = 100.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 64 == 0) mid += ((int)(rng() % 3) - 1) * 0.01;
+        unsigned r = (unsigned)(rng() % 100);
+        if (live.size() < 5000 || r < 40) {
+            Side s = (rng() & 1) ? Side::Buy : Side::Sell;
+            double off = 0.01 * (1 + (int)(rng() % 50));
+            ops.push_back({0, next, s, s == Side::Buy ? mid - off : mid + off, 1 + (std::int64_t)(rng() % 500)});
+            live.push_back(next++);
+        } else {
+            std::size_t k = (std::size_t)(rng() % live.size());
+            OrderId id = live[k];
+            if (r < 75) { ops.push_back({1, id, Side::Buy, 0, 0}); live[k] = live.back(); live.pop_back(); }
+            else if (r < 90) ops.push_back({2, id, Side::Buy, 0, 1 + (std::int64_t)(rng() % 100)});
+            else ops.push_back({3, id, Side::Buy, 0, 1 + (std::int64_t)(rng() % 500)});
+        }
+    }
+    return ops;
+}
+
+}
+
+HFT_BENCH(bench_lob, "lob/") {
+    auto ops = make_flow(2000000);
+    r.measure("lob/updates/2000000", ops.size(), [&] {
+        LimitOrderBook book(0.01);
+        for (const Op& o : ops) {
+            switch (o.kind) {
+                case 0: book.add(o.id, o.side, o.price, o.qty); break;
+                case 1: book.cancel(o.id); break;
+                case 2: book.execute(o.id, o.qty); break;
+                default: book.modify(o.id, o.qty); break;
+            }
+        }
+        bench::keep(book.order_count());
+    });
+    // Same flow with a strategy quoting five ticks behind the top: a large
+    // simulated order every 20 updates, the oldest cancelled once 16 rest.
+    // The active set stays small while the history of placed orders grows.
+    r.measure("lob/updates+sims/2000000", ops.size(), [&] {
+        LimitOrderBook book(0.01);
+        std::vector<OrderId> quotes;
+        std::size_t i = 0;
+        for (const Op& o : ops) {
+            switch (o.kind) {
+                case 0: book.add(o.id, o.side, o.price, o.qty); break;
+                case 1: book.cancel(o.id); break;
+                case 2: book.execute(o.id, o.qty); break;
+                default: book.modify(o.id, o.qty); break;
+            }
+            if (++i % 20 == 0 && book.has_bid() && book.has_ask()) {
+                bool buy = (i / 20) & 1;
+                quotes.push_back(buy ? book.place(Side::Buy, book.best_bid() - 0.05, 1000000)
+                                     : book.place(Side::Sell, book.best_ask() + 0.05, 1000000));
+                if (quotes.size() > 16) { book.cancel(quotes.front()); quotes.erase(quotes.begin()); }
+                book.clear_fills();
+            }
+        }
+        bench::keep(book.order_count());
+    });
+    LimitOrderBook book(0.01);
+    for (const Op& o : ops) if (o.kind == 0) book.add(o.id, o.side, o.price, o.qty);
+    r.measure("lob/sweep_10k", 1, [&] {
+        double avg;
+        bench::keep(book.sweep(Side::Buy, 10000, &avg));
+    });
+}
@@ -0,0 +1,146 @@
+#include "bench.hpp"
+#include "simd_kernels.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Every allocation in the process is counted, so allocs/iter covers the
+// library code under test as well as the benchmark body
+void* operator new(std::size_t n) {
+    hft::bench::alloc_count().fetch_add(1, std::memory_order_relaxed);
+    hft::bench::alloc_bytes().fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace hft {
+namespace bench {
+
+std::size_t peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.PeakWorkingSetSize / 1024;
+    return 0;
+#else
+#ifdef __linux__
+    // VmHWM honours reset_peak_rss(); ru_maxrss does not
+    if (std::FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        std::size_t kb = 0;
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::strncmp(line, "VmHWM:", 6) == 0) { kb = std::strtoull(line + 6, nullptr, 10); break; }
+        }
+        std::fclose(f);
+        if (kb) return kb;
+    }
+#endif
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+    return (std::size_t)ru.ru_maxrss / 1024;  // bytes there
+#else
+    return (std::size_t)ru.ru_maxrss;
+#endif
+#endif
+}
+
+void reset_peak_rss() {
+#ifdef __linux__
+    if (std::FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+#endif
+}
+
+}
+}
+
+namespace {
+
+void json_string(std::FILE* f, const std::string& s) {
+    std::fputc('"', f);
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        if ((unsigned char)c < 0x20) { std::fprintf(f, "\\u%04x", (unsigned)c); continue; }
+        std::fputc(c, f);
+    }
+    std::fputc('"', f);
+}
+
+// JSON has no nan or inf; a zero-length timing or an empty case gives null
+void json_number(std::FILE* f, const char* key, double v) {
+    std::fprintf(f, ", \"%s\": ", key);
+    if (std::isfinite(v)) std::fprintf(f, "%.6g", v);
+    else std::fputs("null", f);
+}
+
+bool write_json(const std::string& path, const std::vector<hft::bench::Result>& results) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    char when[32] = "";
+    std::time_t now = std::time(nullptr);
+    if (const std::tm* t = std::gmtime(&now)) std::strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", t);
+    std::fprintf(f, "{\n  \"suite\": \"hft_bench\",\n  \"timestamp\": \"%s\",\n  \"isa\": \"%s\",\n", when,
+                 hft::simd::isa_name(hft::simd::active_isa()));
+#if defined(__clang__)
+    std::fprintf(f, "  \"compiler\": \"clang %d.%d\",\n", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+    std::fprintf(f, "  \"compiler\": \"gcc %d.%d\",\n", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+    std::fprintf(f, "  \"compiler\": \"msvc %d\",\n", _MSC_VER);
+#endif
+    std::fprintf(f, "  \"results\": [");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        std::fprintf(f, "%s\n    {\"name\": ", i ? "," : "");
+        json_string(f, r.label);
+        std::fprintf(f, ", \"items\": %llu, \"iterations\": %llu", (unsigned long long)r.items,
+                     (unsigned long long)r.iterations);
+        json_number(f, "ns_per_item", r.ns_per_item);
+        json_number(f, "items_per_sec", r.items_per_sec);
+        json_number(f, "gb_per_sec", r.gb_per_sec);
+        json_number(f, "allocs_per_iter", r.allocs_per_iter);
+        json_number(f, "alloc_bytes_per_iter", r.alloc_bytes_per_iter);
+        std::fprintf(f, ", \"peak_rss_kb\": %llu}", (unsigned long long)r.peak_rss_kb);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+}
+
+// hft_bench [filter] [--json out.json] [--min-time seconds]: runs every
+// registered case whose labels contain filter; compare two JSON runs with
+// bench/compare.py
+int main(int argc, char** argv) {
+    std::string filter, json;
+    double min_time = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--json" && i + 1 < argc) json = argv[++i];
+        else if (a == "--min-time" && i + 1 < argc) min_time = std::atof(argv[++i]);
+        else filter = a;
+    }
+    hft::bench::Runner runner(filter, min_time);
+    // Cases with no selected label skip their setup (data, files) entirely
+    for (const auto& c : hft::bench::registry()) {
+        if (runner.wants(c.group)) c.fn(runner);
+    }
+    if (!json.empty() && !write_json(json, runner.results())) {
+        std::fprintf(stderr, "cannot write %s\n", json.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "bench.hpp"
+#include "metrics.hpp"
+#include "simd_kernels.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// Sharpe, Sortino and drawdown of a 1M-point equity series. "post_run" is
+// the former approach (returns vector, then one pass per metric over the
+// stored curve); "online" is the accumulator's per-bar add, which the
+// engines pay inside their loop instead. In isolation the add is slower
+// (Welford's divide), but it overlaps the strategy work, needs no returns
+// vector and leaves nothing to do once the run ends.
+HFT_BENCH(bench_metrics, "metrics/") {
+    const int n = 1000000;
+    auto bars = generate_random_walk(n);
+    std::vector<double> eq(bars.size());
+    for (std::size_t i = 0; i < bars.size(); ++i) eq[i] = bars[i].close;
+
+    r.measure("metrics/post_run/1000000", eq.size(), [&] {
+        std::vector<double> rets;
+        rets.reserve(eq.size());
+        for (std::size_t i = 1; i < eq.size(); ++i) rets.push_back((eq[i] - eq[i - 1]) / eq[i - 1]);
+        double mean, var;
+        simd::kernels().mean_variance(rets.data(), rets.size(), &mean, &var);
+        double down = simd::kernels().downside_deviation(rets.data(), rets.size(), mean, nullptr);
+        bench::keep(sharpe_ratio(rets) + max_drawdown(eq) + down);
+    });
+    r.measure("metrics/online/1000000", eq.size(), [&] {
+        MetricsAccumulator m;
+        for (double v : eq) m.add(v);
+        bench::keep(m.sharpe() + m.max_drawdown() + m.sortino());
+    });
+}
@@ -0,0 +1,40 @@
+#include "bench.hpp"
+#include "monte_carlo.hpp"
+#include "philox.hpp"
+#include "strategies/momentum.hpp"
+#include <random>
+
+using namespace hft;
+
+// Normal draws: mt19937_64 + std::normal_distribution (what
+// generate_random_walk uses) vs Philox bulk fill. Then the path driver:
+// 256 GBM / GARCH paths of 2000 bars, momentum on each, one thread; items
+// are bars.
+HFT_BENCH(bench_montecarlo, "montecarlo/") {
+    const std::size_t n = 1 << 16;
+    std::vector<double> z(n);
+    std::mt19937_64 mt(42);
+    std::normal_distribution<double> nd(0.0, 1.0);
+    r.measure("montecarlo/normals/mt19937", n, [&] {
+        for (auto& x : z) x = nd(mt);
+        bench::keep(z[n - 1]);
+    });
+    Philox4x32 ph(42);
+    r.measure("montecarlo/normals/philox", n, [&] {
+        ph.fill_normal(z.data(), n);
+        bench::keep(z[n - 1]);
+    });
+
+    MonteCarloConfig cfg;
+    cfg.paths = 256;
+    cfg.spec.bars = 2000;
+    cfg.threads = 1;
+    auto make = [] { return std::unique_ptr<Strategy>(new MomentumStrategy(20, 1)); };
+    r.measure("montecarlo/paths/gbm", cfg.paths * cfg.spec.bars, [&] {
+        bench::keep(MonteCarlo::run(make, cfg).final_equity.mean);
+    });
+    cfg.spec.model = PathModel::Garch;
+    r.measure("montecarlo/paths/garch", cfg.paths * cfg.spec.bars, [&] {
+        bench::keep(MonteCarlo::run(make, cfg).final_equity.mean);
+    });
+}
@@ -0,0 +1,100 @@
+#include "bench.hpp"
+#include "advanced_backtester.hpp"
+#include "bar_source.hpp"
+#include "report_writer.hpp"
+#include "spsc_ring.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+using namespace hft;
+
+// A single-symbol run from CSV: "serial" decodes the file and then runs
+// AdvancedBacktester::run on one thread; "pipelined" overlaps decode, the
+// engine and result collection on three threads. The "+curve" cases also
+// write the full equity curve, serially after the run or from the
+// collection stage during it. The overlap needs three free cores; on one
+// core the remaining gain is from never holding the decoded bars in
+// memory. "spsc" is the raw ring at 256-item batches.
+HFT_BENCH(bench_pipeline, "pipeline/") {
+    const int n = 500000;
+    const char* csv = "bench_pipeline_tmp.csv";
+    auto bars = generate_random_walk(n);
+    {
+        BufferedWriter w(csv);
+        w.text("ts,open,high,low,close,volume\n");
+        for (const auto& b : bars) {
+            w.integer(b.ts); w.put(','); w.real(b.open); w.put(','); w.real(b.high); w.put(',');
+            w.real(b.low); w.put(','); w.real(b.close); w.put(','); w.real(b.volume); w.put('\n');
+        }
+        w.close();
+    }
+    RiskControl risk;
+    OrderBook lob{100.0, 2.0, 2.0, 0.5};
+
+    r.measure("pipeline/serial/500000", bars.size(), [&] {
+        CsvBarSource src(csv);
+        std::vector<Bar> loaded;
+        std::vector<Bar> chunk(4096);
+        for (std::size_t got; (got = src.next(chunk.data(), chunk.size())) > 0;)
+            loaded.insert(loaded.end(), chunk.begin(), chunk.begin() + got);
+        MomentumStrategy s(20, 1);
+        bench::keep(AdvancedBacktester::run("bench", loaded, s, CostModel{}, risk, lob).final_equity);
+    });
+    r.measure("pipeline/pipelined/500000", bars.size(), [&] {
+        CsvBarSource src(csv);
+        MomentumStrategy s(20, 1);
+        PipelineOptions opt;
+        opt.pin = std::thread::hardware_concurrency() >= 3;
+        bench::keep(AdvancedBacktester::run_pipelined("bench", src, s, CostModel{}, risk, lob, opt).final_equity);
+    });
+    const char* out = "bench_pipeline_curve_tmp.csv";
+    r.measure("pipeline/serial+curve/500000", bars.size(), [&] {
+        CsvBarSource src(csv);
+        std::vector<Bar> loaded;
+        std::vector<Bar> chunk(4096);
+        for (std::size_t got; (got = src.next(chunk.data(), chunk.size())) > 0;)
+            loaded.insert(loaded.end(), chunk.begin(), chunk.begin() + got);
+        MomentumStrategy s(20, 1);
+        auto res = AdvancedBacktester::run("bench", loaded, s, CostModel{}, risk, lob);
+        CurveWriter curve(out, 1);
+        for (std::size_t i = 0; i < loaded.size(); ++i) curve.add(i, loaded[i].ts, res.equity_curve[i]);
+        bench::keep(curve.finish());
+    });
+    r.measure("pipeline/pipelined+curve/500000", bars.size(), [&] {
+        CsvBarSource src(csv);
+        MomentumStrategy s(20, 1);
+        PipelineOptions opt;
+        opt.pin = std::thread::hardware_concurrency() >= 3;
+        opt.curve_path = out;
+        bench::keep(AdvancedBacktester::run_pipelined("bench", src, s, CostModel{}, risk, lob, opt).final_equity);
+    });
+    std::remove(out);
+    std::remove(csv);
+
+    r.measure("pipeline/spsc/1000000", 1000000, [&] {
+        SpscRing<double> ring(8192);
+        std::thread producer([&] {
+            double buf[256] = {};
+            Backoff backoff;
+            for (std::size_t sent = 0; sent < 1000000;) {
+                std::size_t k = ring.push(buf, std::min<std::size_t>(256, 1000000 - sent));
+                if (k) { sent += k; backoff.reset(); } else backoff.wait();
+            }
+            ring.close();
+        });
+        double buf[256], sum = 0;
+        Backoff backoff;
+        for (;;) {
+            std::size_t got = ring.pop(buf, 256);
+            if (!got && ring.closed()) got = ring.pop(buf, 256);
+            if (got) { for (std::size_t i = 0; i < got; ++i) sum += buf[i]; backoff.reset(); continue; }
+            if (ring.closed()) break;
+            backoff.wait();
+        }
+        producer.join();
+        bench::keep(sum);
+    });
+}
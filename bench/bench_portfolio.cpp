@@ -0,0 +1,35 @@
+#include "bench.hpp"
+#include "portfolio_backtester.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// Merged single-pass run over many symbols; items are bar events
+HFT_BENCH(bench_portfolio, "portfolio/") {
+    for (int symbols : {10, 1000}) {
+        int per = 2000000 / symbols;
+        std::vector<BarColumns> data;
+        std::vector<PortfolioAsset> universe;
+        data.reserve(symbols);
+        for (int i = 0; i < symbols; ++i) {
+            // Staggered clocks so the merge really interleaves
+            data.push_back(generate_random_walk_columns(per, 100.0, 0.0002, 0.005, 1731321600000 + i, 60000));
+            universe.push_back({"S" + std::to_string(i), data.back().view()});
+        }
+        OrderBook lob{100.0, 2.0, 2.0, 0.5};
+        PortfolioOptions opt;
+        opt.keep_curve = false;
+        std::string tag = "/" + std::to_string(symbols) + "x" + std::to_string(per);
+        r.measure("portfolio/merge_only" + tag, (std::size_t)symbols * per, [&] {
+            struct Idle : PortfolioStrategy {
+                void on_bar(std::size_t, const Bar&, const PortfolioBook&, std::vector<PortfolioFill>&) override {}
+            } idle;
+            bench::keep(PortfolioBacktester::run(universe, idle, CostModel{}, PortfolioRisk{}, lob, opt).events);
+        });
+        r.measure("portfolio/momentum" + tag, (std::size_t)symbols * per, [&] {
+            PerSymbolStrategy strat(universe.size(), [](std::size_t) { return std::make_unique<MomentumStrategy>(20, 1); });
+            bench::keep(PortfolioBacktester::run(universe, strat, CostModel{}, PortfolioRisk{}, lob, opt).final_equity);
+        });
+    }
+}
@@ -0,0 +1,27 @@
+#include "bench.hpp"
+#include "profiler.hpp"
+
+using namespace hft;
+
+// Cost of one profiled scope: two timestamps plus the histogram and trace
+// ring writes. This is what every HFT_PROFILE_SCOPE adds per bar and phase
+// in a profiling build (zero otherwise). histogram_record feeds it ticks()
+// so the values stay opaque; subtract the ticks case for the record alone.
+HFT_BENCH(bench_profiler, "profiler/") {
+    const std::size_t n = 100000;
+    r.measure("profiler/ticks", n, [&] {
+        std::uint64_t s = 0;
+        for (std::size_t i = 0; i < n; ++i) s += prof::ticks();
+        bench::keep((double)s);
+    });
+    prof::LatencyHistogram h;
+    r.measure("profiler/histogram_record", n, [&] {
+        for (std::size_t i = 0; i < n; ++i) h.record(prof::ticks() & 0xfff);
+        bench::keep((double)h.max());
+    });
+    prof::reset();
+    r.measure("profiler/scoped_timer", n, [&] {
+        for (std::size_t i = 0; i < n; ++i) prof::ScopedTimer t(prof::Phase::Strategy);
+    });
+    prof::reset();
+}
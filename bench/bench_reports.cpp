@@ -0,0 +1,52 @@
+#include "bench.hpp"
+#include "advanced_reports.hpp"
+#include "synthetic.hpp"
+#include <cstdio>
+#include <fstream>
+
+using namespace hft;
+
+// Details report (asset,bar_idx,equity,pnl) for 3 assets x 200k bars:
+// ofstream << with default formatting (the former writer, 6 significant
+// digits), the buffered shortest round-trip CSV, and the columnar .hftc.
+// Items are rows.
+HFT_BENCH(bench_reports, "reports/") {
+    const int n = 200000;
+    std::vector<AssetBacktest> results(3);
+    for (int a = 0; a < 3; ++a) {
+        auto bars = generate_random_walk(n, 100.0, 0.0002, 0.005, 1731321600000, 60000, 42 + a);
+        results[a].asset = "ASSET" + std::to_string(a);
+        for (const auto& b : bars) {
+            results[a].equity_curve.push_back(1000.0 * b.close);
+            results[a].pnl_series.push_back(b.close - b.open);
+        }
+    }
+    std::size_t rows = 3 * (std::size_t)n;
+    const char* path = "bench_reports_tmp";
+
+    r.measure("reports/details/ofstream", rows, [&] {
+        std::ofstream det(std::string(path) + "_details.csv");
+        det << "asset,bar_idx,equity,pnl\n";
+        for (const auto& res : results)
+            for (size_t i = 0; i < res.equity_curve.size(); ++i)
+                det << res.asset << "," << i << "," << res.equity_curve[i] << "," << res.pnl_series[i] << "\n";
+    });
+    r.measure("reports/details/buffered", rows, [&] {
+        BufferedWriter det(std::string(path) + "_details.csv");
+        det.text("asset,bar_idx,equity,pnl\n");
+        for (const auto& res : results) {
+            for (size_t i = 0; i < res.equity_curve.size(); ++i) {
+                det.text(res.asset); det.put(',');
+                det.integer((std::int64_t)i); det.put(',');
+                det.real(res.equity_curve[i]); det.put(',');
+                det.real(res.pnl_series[i]); det.put('\n');
+            }
+        }
+        bench::keep(det.close());
+    });
+    r.measure("reports/columnar", rows, [&] {
+        bench::keep(write_advanced_columnar(path, results));
+    });
+    std::remove((std::string(path) + "_details.csv").c_str());
+    std::remove((std::string(path) + ".hftc").c_str());
+}
@@ -0,0 +1,25 @@
+#include "bench.hpp"
+#include "risk.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// Per-bar volatility as the advanced engine used to do it (re-scan the
+// window of a growing price vector) versus the rolling estimator.
+HFT_BENCH(bench_volatility, "volatility/") {
+    for (int n : {10000, 100000, 1000000}) {
+        auto bars = generate_random_walk(n);
+        r.measure("volatility/recompute_per_bar/" + std::to_string(n), bars.size(), [&] {
+            std::vector<double> prices;
+            double acc = 0;
+            for (const auto& b : bars) { prices.push_back(b.close); acc += compute_volatility(prices, 20); }
+            bench::keep(acc);
+        });
+        r.measure("volatility/rolling/" + std::to_string(n), bars.size(), [&] {
+            RollingVolatility vol(20);
+            double acc = 0;
+            for (const auto& b : bars) { vol.update(b.close); acc += vol.value(); }
+            bench::keep(acc);
+        });
+    }
+}
@@ -0,0 +1,45 @@
+#include "bench.hpp"
+#include "job_scheduler.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include "thread_pool.hpp"
+
+using namespace hft;
+
+// 240 jobs over 24 symbols whose bar counts span 100x (500..50000), one
+// momentum lookback per job. "static" gives each thread a contiguous slice
+// of the job list up front (the partitioning the request replaces);
+// "stealing" is JobScheduler. Items are bars. The difference only shows
+// with several cores: with one, both are the same serial work.
+HFT_BENCH(bench_scheduler, "scheduler/") {
+    std::vector<std::vector<Bar>> data;
+    for (int s = 0; s < 24; ++s) data.push_back(generate_random_walk(s % 6 == 0 ? 50000 : 500 + 100 * s, 100.0, 0.0002, 0.01, (std::uint64_t)s));
+    StrategyFactory factory = [](const std::vector<double>& p) {
+        return std::unique_ptr<Strategy>(new MomentumStrategy((int)p[0], 1));
+    };
+    std::vector<BacktestJob> jobs;
+    std::size_t bars = 0;
+    for (std::size_t s = 0; s < data.size(); ++s) {
+        for (int lb = 5; lb <= 50; lb += 5) {
+            jobs.push_back({"S" + std::to_string(s), "S" + std::to_string(s), BarView::of(data[s]), factory,
+                            {(double)lb}, CostModel{}, RiskControl{}, OrderBook{100, 2, 2, 0.5}});
+            bars += data[s].size();
+        }
+    }
+
+    r.measure("scheduler/static/240", bars, [&] {
+        ThreadPool pool;
+        std::size_t per = (jobs.size() + pool.size() - 1) / pool.size();
+        std::vector<double> out(jobs.size());
+        pool.parallel_for(pool.size(), [&](std::size_t t, std::size_t) {
+            for (std::size_t j = t * per; j < jobs.size() && j < (t + 1) * per; ++j) {
+                auto strat = jobs[j].factory(jobs[j].params);
+                out[j] = AdvancedBacktester::run(jobs[j].name, jobs[j].bars, *strat, jobs[j].costs, jobs[j].risk, jobs[j].lob).final_equity;
+            }
+        });
+        bench::keep(out.back());
+    });
+    r.measure("scheduler/stealing/240", bars, [&] {
+        bench::keep(JobScheduler::run(jobs).results.back().final_equity);
+    });
+}
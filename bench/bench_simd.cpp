@@ -0,0 +1,46 @@
+#include "bench.hpp"
+#include "simd_kernels.hpp"
+#include "synthetic.hpp"
+
+using namespace hft;
+
+// Each kernel on every instruction set the CPU supports; GB/s counts the
+// input series read once per call.
+HFT_BENCH(bench_simd, "simd/") {
+    const int w = 20;
+    for (int n : {100000, 1000000}) {
+        auto bars = generate_random_walk(n);
+        std::vector<double> x(bars.size()), out(bars.size());
+        for (std::size_t i = 0; i < bars.size(); ++i) x[i] = bars[i].close;
+        std::size_t bytes = x.size() * sizeof(double);
+        std::string sz = "/" + std::to_string(n);
+        for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Avx2, simd::Isa::Avx512}) {
+            if (!simd::isa_supported(isa)) continue;
+            const simd::KernelTable& k = simd::kernels(isa);
+            std::string tag = std::string("/") + simd::isa_name(isa) + sz;
+            r.measure("simd/returns" + tag, x.size(), [&] {
+                k.simple_returns(x.data(), x.size(), out.data());
+                bench::keep(out[0]);
+            }, 0.2, bytes);
+            r.measure("simd/sma" + tag, x.size(), [&] {
+                k.sma(x.data(), x.size(), w, out.data());
+                bench::keep(out[0]);
+            }, 0.2, bytes);
+            r.measure("simd/rolling_variance" + tag, x.size(), [&] {
+                k.rolling_variance(x.data(), x.size(), w, out.data());
+                bench::keep(out[0]);
+            }, 0.2, bytes);
+            r.measure("simd/max_drawdown" + tag, x.size(), [&] {
+                bench::keep(k.max_drawdown(x.data(), x.size()));
+            }, 0.2, bytes);
+            r.measure("simd/mean_variance" + tag, x.size(), [&] {
+                double m, v;
+                k.mean_variance(x.data(), x.size(), &m, &v);
+                bench::keep(v);
+            }, 0.2, bytes);
+            r.measure("simd/downside_deviation" + tag, x.size(), [&] {
+                bench::keep(k.downside_deviation(x.data(), x.size(), 100.0, nullptr));
+            }, 0.2, bytes);
+        }
+    }
+}
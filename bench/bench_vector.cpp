@@ -0,0 +1,36 @@
+#include "bench.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include "vector_backtester.hpp"
+#include <cmath>
+
+using namespace hft;
+
+// Momentum(20, 1) over 1M columnar bars: the event loop through the virtual
+// Strategy, the array engine on precomputed targets, and the array engine
+// with the signal and targets built inside the measurement. Items are bars.
+HFT_BENCH(bench_vector, "vector/") {
+    const int n = 1000000, lookback = 20;
+    auto cols = generate_random_walk_columns(n);
+    BarView v = cols.view();
+    CostModel costs{0.0, 1.0};
+    std::vector<double> close(n), signal(n);
+    for (int i = 0; i < n; ++i) close[i] = v.close(i);
+    const double warmup = std::nan("");
+    auto make_targets = [&] {
+        for (int i = 0; i < n; ++i) signal[i] = i >= lookback - 1 ? close[i] - close[i - lookback + 1] : warmup;
+        return targets_from_signal(signal, 1);
+    };
+    std::vector<int> target = make_targets();
+
+    r.measure("vector/momentum/event_loop/1000000", n, [&] {
+        MomentumStrategy s(lookback, 1);
+        bench::keep(Backtester::run(v, s, costs).final_equity);
+    });
+    r.measure("vector/momentum/targets/1000000", n, [&] {
+        bench::keep(VectorBacktester::run(v, target, costs).final_equity);
+    });
+    r.measure("vector/momentum/signal+targets/1000000", n, [&] {
+        bench::keep(VectorBacktester::run(v, make_targets(), costs).final_equity);
+    });
+}
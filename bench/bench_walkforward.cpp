@@ -0,0 +1,40 @@
+#include "bench.hpp"
+#include "backtester.hpp"
+#include "strategies/momentum.hpp"
+#include "synthetic.hpp"
+#include "walk_forward.hpp"
+
+using namespace hft;
+
+// 20 lookbacks, 2000-bar train / 250-bar test windows over 50k bars, one
+// thread. "per_fold" re-runs every combination on every train window (the
+// naive loop); WalkForward runs each combination once. Items are folds.
+HFT_BENCH(bench_walkforward, "walkforward/") {
+    const int n = 50000;
+    auto cols = generate_random_walk_columns(n);
+    BarView v = cols.view();
+    ParamGrid grid;
+    grid.add("lookback", ParamGrid::range(5, 100, 5));
+    StrategyFactory factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+        return std::unique_ptr<Strategy>(new MomentumStrategy((int)p[0], 1));
+    };
+    WalkForwardConfig cfg;
+    cfg.train_bars = 2000;
+    cfg.test_bars = 250;
+    cfg.threads = 1;
+    std::size_t folds = (n - cfg.train_bars + cfg.test_bars - 1) / cfg.test_bars;
+
+    r.measure("walkforward/per_fold/50000", folds, [&] {
+        double sum = 0;
+        for (std::size_t s = 0; s + cfg.train_bars < (std::size_t)n; s += cfg.test_bars) {
+            for (std::size_t i = 0; i < grid.size(); ++i) {
+                auto strat = factory(grid.at(i));
+                sum += Backtester::run(v.slice(s, cfg.train_bars), *strat, cfg.costs).sharpe;
+            }
+        }
+        bench::keep(sum);
+    });
+    r.measure("walkforward/cached/50000", folds, [&] {
+        bench::keep(WalkForward::run(v, grid, factory, cfg).oos_return);
+    });
+}
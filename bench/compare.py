@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Compare two hft_bench --json runs and flag regressions.
+
+    python bench/compare.py baseline.json current.json [--threshold 0.10]
+
+A case regresses when its ns/item grows by more than --threshold (relative),
+its allocations per call grow by more than --alloc-slack, or its peak RSS
+grows by more than --rss-threshold. Exits 1 if any case regressed.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    for r in doc['results']:
+        # hft_bench writes null for a figure that is not finite
+        for k, v in r.items():
+            if v is None:
+                r[k] = float('nan')
+    return doc, {r['name']: r for r in doc['results']}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('baseline')
+    ap.add_argument('current')
+    ap.add_argument('--threshold', type=float, default=0.10, help='relative ns/item slowdown (default 0.10)')
+    ap.add_argument('--alloc-slack', type=float, default=0.5, help='extra allocations per call tolerated')
+    ap.add_argument('--rss-threshold', type=float, default=0.25, help='relative peak RSS growth (default 0.25)')
+    args = ap.parse_args()
+
+    try:
+        base_doc, base = load(args.baseline)
+    except FileNotFoundError:
+        print(f"no baseline at {args.baseline}; store one first (build target bench_baseline)")
+        return 2
+    cur_doc, cur = load(args.current)
+    for key in ('isa', 'compiler'):
+        if base_doc.get(key) != cur_doc.get(key):
+            print(f"note: {key} differs: {base_doc.get(key)} -> {cur_doc.get(key)}")
+
+    regressions = 0
+    print(f"{'case':48} {'base ns':>10} {'now ns':>10} {'change':>8} {'allocs':>15}  status")
+    for name, c in cur.items():
+        b = base.get(name)
+        if b is None:
+            print(f"{name:48} {'':>10} {c['ns_per_item']:10.2f} {'':>8} {'':>15}  new")
+            continue
+        change = c['ns_per_item'] / b['ns_per_item'] - 1.0 if b['ns_per_item'] > 0 else 0.0
+        reasons = []
+        if change > args.threshold:
+            reasons.append('time')
+        if c['allocs_per_iter'] > b['allocs_per_iter'] + args.alloc_slack:
+            reasons.append('allocs')
+        if b['peak_rss_kb'] > 0 and c['peak_rss_kb'] > b['peak_rss_kb'] * (1.0 + args.rss_threshold):
+            reasons.append('rss')
+        if reasons:
+            regressions += 1
+            status = 'REGRESSED (' + ', '.join(reasons) + ')'
+        elif change < -args.threshold:
+            status = 'improved'
+        else:
+            status = 'ok'
+        allocs = f"{b['allocs_per_iter']:.1f}->{c['allocs_per_iter']:.1f}"
+        print(f"{name:48} {b['ns_per_item']:10.2f} {c['ns_per_item']:10.2f} {change:+8.1%} {allocs:>15}  {status}")
+    for name in base:
+        if name not in cur:
+            print(f"{name:48} {base[name]['ns_per_item']:10.2f} {'':>10} {'':>8} {'':>15}  missing")
+
+    print(f"\n{regressions} regression(s) across {len(cur)} case(s)")
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,11 +3,60 @@
 HFT Backtester Visualization & Analysis
 Plots equity curves, PnL, and performance metrics
 """
+import struct
+import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
 import sys
 from pathlib import Path
 
+def read_hftc(path):
+    """Read a columnar .hftc report into {name: ndarray or list of str}"""
+    buf = Path(path).read_bytes()
+    magic, version, ncols, _ = struct.unpack_from('<4sIII', buf, 0)
+    if magic != b'HFTC' or version != 1:
+        raise ValueError(f'{path}: not an HFTC v1 file')
+    cols, at = {}, 16
+    for _ in range(ncols):
+        ctype, name_len, count, offset, nbytes = struct.unpack_from('<IIQQQ', buf, at)
+        at += 32
+        name = buf[at:at + name_len].decode()
+        at += (name_len + 7) & ~7
+        if ctype == 1:
+            cols[name] = np.frombuffer(buf, '<f8', count, offset)
+        elif ctype == 2:
+            cols[name] = np.frombuffer(buf, '<i8', count, offset)
+        elif ctype == 3:
+            strs, p = [], offset
+            for _ in range(count):
+                (n,) = struct.unpack_from('<I', buf, p)
+                strs.append(buf[p + 4:p + 4 + n].decode())
+                p += 4 + n
+            cols[name] = strs
+    return cols
+
+def load_report(base, fmt='auto'):
+    """(equity, summary) frames from <base>.hftc or the CSV reports.
+    fmt is 'csv', 'binary' or 'auto': whichever was written last, so a
+    stale file from an earlier run with another --report is not plotted"""
+    hftc = Path(f'{base}.hftc')
+    csv = Path(f'{base}_summary.csv')
+    if fmt == 'auto':
+        binary = hftc.exists() and (not csv.exists() or hftc.stat().st_mtime >= csv.stat().st_mtime)
+    else:
+        binary = fmt == 'binary'
+    if not binary:
+        return pd.read_csv(f'{base}_equity.csv'), pd.read_csv(csv)
+    cols = read_hftc(hftc)
+    summary = pd.DataFrame({k.split('/', 1)[1]: v for k, v in cols.items() if k.startswith('summary/')})
+    curves = {a: cols[f'equity/{a}'] for a in summary['asset']}
+    n = max((len(c) for c in curves.values()), default=0)
+    equity = pd.DataFrame({'bar_idx': np.arange(n)})
+    for a, c in curves.items():
+        # Shorter series hold their last value, as in the CSV writer
+        equity[a] = np.concatenate([c, np.full(n - len(c), c[-1] if len(c) else np.nan)])
+    return equity, summary
+
 def plot_results(momentum_equity, mr_equity, momentum_summary, mr_summary):
     """Generate comprehensive plots"""
     fig = plt.figure(figsize=(16, 12))
@@ -88,12 +137,14 @@ def plot_results(momentum_equity, mr_equity, momentum_summary, mr_summary):
 if __name__ == '__main__':
     try:
         base = Path('.')
+        # visualize.py [--format csv|binary]; by default the newer of the two
+        fmt = 'auto'
+        if '--format' in sys.argv[1:-1]:
+            fmt = sys.argv[sys.argv.index('--format') + 1]
         
-        # Load data
-        mom_eq = pd.read_csv(base / 'results_momentum_equity.csv')
-        mr_eq = pd.read_csv(base / 'results_meanreversion_equity.csv')
-        mom_sum = pd.read_csv(base / 'results_momentum_summary.csv')
-        mr_sum = pd.read_csv(base / 'results_meanreversion_summary.csv')
+        # Load data (columnar .hftc or CSV, see load_report)
+        mom_eq, mom_sum = load_report(base / 'results_momentum', fmt)
+        mr_eq, mr_sum = load_report(base / 'results_meanreversion', fmt)
         
         # Print summary statistics
         print("=" * 70)
@@ -3,10 +3,14 @@
 #include <string>
 #include <map>
 #include "data_loader.hpp"
+#include "bar_view.hpp"
+#include "bar_source.hpp"
+#include "streaming.hpp"
 #include "strategy.hpp"
 #include "risk.hpp"
 #include "orderbook.hpp"
 #include "costs.hpp"
+#include "pipeline.hpp"
 
 namespace hft {
 
@@ -19,16 +23,108 @@ struct AssetBacktest {
     double max_dd = 0;
     double final_equity = 0;
     int num_trades = 0;
+    MetricsAccumulator metrics;   // annualize with periods = 252 like sharpe
+};
+
+// Engine state after the last bar of a run: cash and position, the risk
+// accumulators (rolling volatility, daily P&L), the trade count, the
+// metric accumulators and the strategy snapshot. Fill-model state, if the
+// model has any, is not included. The bytes are for the same build only.
+struct AdvancedCheckpoint {
+    std::vector<unsigned char> bytes;
+
+    bool empty() const { return bytes.empty(); }
+    bool write(const std::string& path) const;
+    bool read(const std::string& path);
 };
 
 class AdvancedBacktester {
 public:
+    // With checkpoint, the end-of-run state is stored there for resume()
     static AssetBacktest run(const std::string& asset_name,
                              const std::vector<Bar>& bars,
                              Strategy& strat,
                              const CostModel& costs,
                              const RiskControl& risk,
-                             const OrderBook& lob);
+                             const OrderBook& lob,
+                             AdvancedCheckpoint* checkpoint = nullptr);
+    static AssetBacktest run(const std::string& asset_name,
+                             const BarView& bars,
+                             Strategy& strat,
+                             const CostModel& costs,
+                             const RiskControl& risk,
+                             const OrderBook& lob,
+                             AdvancedCheckpoint* checkpoint = nullptr);
+    // Orders are filled by `fills` (e.g. a BookFillModel over a
+    // LimitOrderBook) instead of the OrderBook formula
+    static AssetBacktest run(const std::string& asset_name,
+                             const BarView& bars,
+                             Strategy& strat,
+                             const CostModel& costs,
+                             const RiskControl& risk,
+                             FillModel& fills,
+                             AdvancedCheckpoint* checkpoint = nullptr);
+    // Continues a run from its checkpoint over the bars that follow it,
+    // with strat built like the original (its state is restored from the
+    // checkpoint) and the same costs and risk. out's equity_curve,
+    // pnl_series and trades cover new_bars only, to be appended to the
+    // earlier ones; num_trades, final_equity, sharpe, max_dd and metrics
+    // cover the whole history, exactly as a full rerun reports them. The
+    // checkpoint then moves to the new end. False, changing nothing, if
+    // the checkpoint is damaged, was made for another strategy or
+    // parameters, or new_bars do not start after its last bar.
+    static bool resume(const std::string& asset_name,
+                       const BarView& new_bars,
+                       Strategy& strat,
+                       const CostModel& costs,
+                       const RiskControl& risk,
+                       const OrderBook& lob,
+                       AdvancedCheckpoint& checkpoint,
+                       AssetBacktest& out);
+    static bool resume(const std::string& asset_name,
+                       const BarView& new_bars,
+                       Strategy& strat,
+                       const CostModel& costs,
+                       const RiskControl& risk,
+                       FillModel& fills,
+                       AdvancedCheckpoint& checkpoint,
+                       AssetBacktest& out);
+    // Pulls bars from src chunk by chunk and keeps only online aggregates
+    static StreamResult run_stream(const std::string& asset_name,
+                                   BarSource& src,
+                                   Strategy& strat,
+                                   const CostModel& costs,
+                                   const RiskControl& risk,
+                                   const OrderBook& lob,
+                                   const StreamOptions& opt = {});
+    static StreamResult run_stream(const std::string& asset_name,
+                                   BarSource& src,
+                                   Strategy& strat,
+                                   const CostModel& costs,
+                                   const RiskControl& risk,
+                                   FillModel& fills,
+                                   const StreamOptions& opt = {});
+    // Same result as run() over the same bars, with decoding, the engine
+    // and result collection on three threads connected by SPSC rings. With
+    // opt.curve_path set, the collection stage also writes the equity curve
+    // as bars come out of the engine. Per-stage counters go to stats when
+    // given.
+    static AssetBacktest run_pipelined(const std::string& asset_name,
+                                       BarSource& src,
+                                       Strategy& strat,
+                                       const CostModel& costs,
+                                       const RiskControl& risk,
+                                       const OrderBook& lob,
+                                       const PipelineOptions& opt = {},
+                                       std::vector<StageStats>* stats = nullptr);
+    static AssetBacktest run_pipelined(const std::string& asset_name,
+                                       BarSource& src,
+                                       Strategy& strat,
+                                       const CostModel& costs,
+                                       const RiskControl& risk,
+                                       FillModel& fills,
+                                       const PipelineOptions& opt = {},
+                                       std::vector<StageStats>* stats = nullptr);
 };
 
 }
@@ -1,45 +1,90 @@
 #pragma once
 #include <vector>
-#include <fstream>
-#include <sstream>
-#include <iomanip>
-#include <map>
+#include <string>
 #include "advanced_backtester.hpp"
-#include "performance.hpp"
+#include "report_writer.hpp"
 
 namespace hft {
 
-inline void write_advanced_report(const std::string& base_path, const std::vector<AssetBacktest>& results) {
+enum class ReportFormat { Csv, Binary, Both };
+
+inline double report_total_return(const AssetBacktest& r) {
+    return r.equity_curve.empty() ? 0 : (r.final_equity - 100000.0) / 100000.0;
+}
+
+// <base>_summary.csv, <base>_details.csv and <base>_equity.csv
+inline bool write_advanced_csv(const std::string& base_path, const std::vector<AssetBacktest>& results) {
     // Summary CSV
-    std::ofstream sum(base_path + "_summary.csv");
-    sum << "asset,sharpe,max_dd,final_equity,trades,total_return\n";
+    BufferedWriter sum(base_path + "_summary.csv");
+    sum.text("asset,sharpe,max_dd,final_equity,trades,total_return\n");
     for (const auto& r : results) {
-        double tr = (r.equity_curve.empty() ? 0 : (r.final_equity - 100000.0) / 100000.0);
-        sum << r.asset << "," << r.sharpe << "," << r.max_dd << "," << r.final_equity << "," << r.num_trades << "," << tr << "\n";
+        sum.text(r.asset); sum.put(',');
+        sum.real(r.sharpe); sum.put(',');
+        sum.real(r.max_dd); sum.put(',');
+        sum.real(r.final_equity); sum.put(',');
+        sum.integer(r.num_trades); sum.put(',');
+        sum.real(report_total_return(r)); sum.put('\n');
     }
-    
+
     // Detailed metrics CSV
-    std::ofstream det(base_path + "_details.csv");
-    det << "asset,bar_idx,equity,pnl\n";
+    BufferedWriter det(base_path + "_details.csv");
+    det.text("asset,bar_idx,equity,pnl\n");
     for (const auto& r : results) {
         for (size_t i = 0; i < r.equity_curve.size(); ++i) {
-            det << r.asset << "," << i << "," << r.equity_curve[i] << "," << r.pnl_series[i] << "\n";
+            det.text(r.asset); det.put(',');
+            det.integer((std::int64_t)i); det.put(',');
+            det.real(r.equity_curve[i]); det.put(',');
+            det.real(r.pnl_series[i]); det.put('\n');
         }
     }
-    
+
     // Combined equity curve for plotting
-    std::ofstream eq(base_path + "_equity.csv");
-    eq << "bar_idx";
-    for (const auto& r : results) eq << "," << r.asset;
-    eq << "\n";
+    BufferedWriter eq(base_path + "_equity.csv");
+    eq.text("bar_idx");
+    for (const auto& r : results) { eq.put(','); eq.text(r.asset); }
+    eq.put('\n');
     size_t max_bars = results.empty() ? 0 : results[0].equity_curve.size();
     for (size_t i = 0; i < max_bars; ++i) {
-        eq << i;
+        eq.integer((std::int64_t)i);
         for (const auto& r : results) {
-            eq << "," << (i < r.equity_curve.size() ? r.equity_curve[i] : r.equity_curve.back());
+            eq.put(',');
+            eq.real(i < r.equity_curve.size() ? r.equity_curve[i] : r.equity_curve.back());
         }
-        eq << "\n";
+        eq.put('\n');
     }
+    bool ok = sum.close();
+    ok = det.close() && ok;
+    return eq.close() && ok;
+}
+
+// <base>.hftc: summary/<field> columns (one row per asset) plus
+// equity/<asset> and pnl/<asset> series; read with ColumnarReader or
+// read_hftc() in visualize.py
+inline bool write_advanced_columnar(const std::string& base_path, const std::vector<AssetBacktest>& results) {
+    std::vector<std::string> asset;
+    std::vector<double> sharpe, max_dd, final_equity, total_return;
+    std::vector<std::int64_t> trades;
+    for (const auto& r : results) {
+        asset.push_back(r.asset);
+        sharpe.push_back(r.sharpe);
+        max_dd.push_back(r.max_dd);
+        final_equity.push_back(r.final_equity);
+        trades.push_back(r.num_trades);
+        total_return.push_back(report_total_return(r));
+    }
+    ColumnarWriter w;
+    w.add("summary/asset", asset).add("summary/sharpe", sharpe).add("summary/max_dd", max_dd)
+     .add("summary/final_equity", final_equity).add("summary/trades", trades).add("summary/total_return", total_return);
+    for (const auto& r : results) w.add("equity/" + r.asset, r.equity_curve).add("pnl/" + r.asset, r.pnl_series);
+    return w.write(base_path + ".hftc");
+}
+
+inline bool write_advanced_report(const std::string& base_path, const std::vector<AssetBacktest>& results,
+                                  ReportFormat fmt = ReportFormat::Csv) {
+    bool ok = true;
+    if (fmt != ReportFormat::Binary) ok = write_advanced_csv(base_path, results) && ok;
+    if (fmt != ReportFormat::Csv) ok = write_advanced_columnar(base_path, results) && ok;
+    return ok;
 }
 
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <vector>
 #include "data_loader.hpp"
+#include "bar_view.hpp"
+#include "bar_source.hpp"
+#include "streaming.hpp"
 #include "strategy.hpp"
 #include "metrics.hpp"
 #include "costs.hpp"
@@ -13,11 +16,15 @@ struct BacktestResult {
     double sharpe;
     double drawdown;
     double final_equity;
+    MetricsAccumulator metrics;
 };
 
 class Backtester {
 public:
     static BacktestResult run(const std::vector<Bar>& bars, Strategy& strat, const CostModel& costs = {}, int lot = 1);
+    static BacktestResult run(const BarView& bars, Strategy& strat, const CostModel& costs = {}, int lot = 1);
+    // Pulls bars from src chunk by chunk and keeps only online aggregates
+    static StreamResult run_stream(BarSource& src, Strategy& strat, const CostModel& costs = {}, const StreamOptions& opt = {});
 };
 
 }
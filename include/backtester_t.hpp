@@ -0,0 +1,142 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "backtester.hpp"
+#include "orderbook.hpp"
+#include "profiler.hpp"
+
+namespace hft {
+
+// Fill policies for BacktesterT: FillResult fill(const Bar&, const Trade&).
+
+// Orders execute in full at the price the strategy recorded (the
+// behaviour of Backtester::run)
+struct StrategyPriceFill {
+    FillResult fill(const Bar&, const Trade& t) const { return {t.quantity, t.entry_price}; }
+};
+
+// Adapts a FillModel. With a final model type (FormulaFillModel) the call
+// is resolved statically.
+template <class ModelT>
+struct ModelFill {
+    ModelT& model;
+    FillResult fill(const Bar& bar, const Trade& t) const { return model.fill(bar, t.quantity); }
+};
+
+// Backtester with the strategy, cost model and fill policy as template
+// parameters. With a final strategy class nothing in the per-bar path is
+// virtual, so on_bar inlines into the loop. BacktesterT<Strategy> is the
+// polymorphic engine behind Backtester::run; any instantiation gives
+// bit-identical results for the same strategy.
+//
+// A fill that differs from the order the strategy booked (price or size)
+// is reconciled against the strategy's own cash/position accounting.
+template <class StrategyT, class CostT = CostModel, class FillT = StrategyPriceFill>
+class BacktesterT {
+public:
+    static BacktestResult run(const BarView& bars, StrategyT& strat, const CostT& costs = {}, FillT fill = {}) {
+        HFT_PROFILE_SCOPE(Run);
+        BacktestResult res{};
+        Engine eng(strat, costs, fill);
+        // Everything the loop appends to is sized up front: the steady state
+        // makes no heap allocations (see test_hot_loop_allocations)
+        res.equity_curve.reserve(bars.size());
+        reserve_trades(res.trades, bars.size());
+
+        for (std::size_t i = 0; i < bars.size(); ++i) {
+            const Bar b = bars[i];
+            // Mark-to-market equity update
+            double equity = eng.step(b, &res.trades);
+            res.equity_curve.push_back(equity);
+            res.metrics.add(equity);
+        }
+
+        trim_trades(res.trades);
+        res.sharpe = res.metrics.sharpe();
+        res.drawdown = res.metrics.max_drawdown();
+        res.final_equity = res.equity_curve.empty() ? eng.cash() : res.equity_curve.back();
+        return res;
+    }
+
+    static StreamResult run_stream(BarSource& src, StrategyT& strat, const CostT& costs = {},
+                                   const StreamOptions& opt = {}, FillT fill = {}) {
+        HFT_PROFILE_SCOPE(Run);
+        StreamResult res;
+        Engine eng(strat, costs, fill);
+        CurveWriter curve(opt.curve_path, opt.curve_every);
+        std::vector<Bar> chunk(std::max<std::size_t>(1, opt.chunk_bars));
+
+        for (std::size_t got; (got = src.next(chunk.data(), chunk.size())) > 0;) {
+            for (std::size_t k = 0; k < got; ++k) {
+                const Bar& b = chunk[k];
+                double equity = eng.step(b, nullptr);
+                res.metrics.add(equity);
+                curve.add(res.bars, b.ts, equity);
+                ++res.bars;
+            }
+        }
+
+        res.sharpe = res.metrics.sharpe();
+        res.max_dd = res.metrics.max_drawdown();
+        res.num_trades = eng.num_trades();
+        res.final_equity = res.bars ? res.metrics.final_equity() : eng.cash();
+        res.curve_points = curve.finish();
+        return res;
+    }
+
+private:
+    // Per-bar step shared by the in-memory and streaming runs
+    class Engine {
+    public:
+        Engine(StrategyT& strat, const CostT& costs, FillT& fill) : strat_(strat), costs_(costs), fill_(fill) {
+            scratch_.reserve(kScratchTrades);
+        }
+
+        // Runs the strategy on one bar and returns the mark-to-market equity.
+        // Trades are appended to keep when given.
+        double step(const Bar& b, std::vector<Trade>* keep) {
+            {
+                HFT_PROFILE_SCOPE(Strategy);
+                scratch_.clear();
+                strat_.on_bar(b, ctx_, scratch_);
+            }
+            for (auto& t : scratch_) {
+                FillResult f;
+                {
+                    HFT_PROFILE_SCOPE(Fill);
+                    f = fill_.fill(b, t);
+                }
+                if (f.filled != t.quantity || f.price != t.entry_price) {
+                    ctx_.cash += t.quantity * t.entry_price - f.filled * f.price;
+                    ctx_.position += f.filled - t.quantity;
+                    t.quantity = f.filled;
+                    t.entry_price = f.price;
+                    if (f.filled == 0) continue;
+                }
+                // apply transaction costs at trade time
+                double c;
+                {
+                    HFT_PROFILE_SCOPE(Cost);
+                    c = costs_.cost(t.entry_price, t.quantity);
+                }
+                ctx_.cash -= c;
+                if (keep) keep->push_back(t);
+                ++num_trades_;
+            }
+            return ctx_.cash + ctx_.position * b.close;
+        }
+
+        double cash() const { return ctx_.cash; }
+        std::size_t num_trades() const { return num_trades_; }
+
+    private:
+        StrategyT& strat_;
+        const CostT& costs_;
+        FillT& fill_;
+        StrategyContext ctx_{};
+        std::vector<Trade> scratch_;
+        std::size_t num_trades_ = 0;
+    };
+};
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "bar_view.hpp"
+#include "data_loader.hpp"
+
+namespace hft {
+
+// Allocator handing out storage aligned to A bytes (a cache line by default)
+template <typename T, std::size_t A = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, A>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, A>&) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(A))); }
+    void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t(A)); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, A>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, A>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Owning structure-of-arrays bar series: one 64-byte aligned array per field,
+// so a loop over closes streams 8 bytes per bar instead of a whole Bar.
+// view() gives the columnar BarView the engines take; its operator[]
+// assembles a Bar on the fly for Strategy::on_bar.
+class BarColumns {
+public:
+    BarColumns() = default;
+    explicit BarColumns(std::size_t n) { resize(n); }
+
+    // Copies any view (row-major vector, mapped BarStore, slice) into columns
+    static BarColumns from(const BarView& v) {
+        BarColumns c(v.size());
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            c.ts_[i] = v.ts(i); c.open_[i] = v.open(i); c.high_[i] = v.high(i);
+            c.low_[i] = v.low(i); c.close_[i] = v.close(i); c.volume_[i] = v.volume(i);
+        }
+        return c;
+    }
+    static BarColumns from(const std::vector<Bar>& bars) { return from(BarView::of(bars)); }
+
+    std::size_t size() const { return ts_.size(); }
+    bool empty() const { return ts_.empty(); }
+
+    void reserve(std::size_t n) {
+        ts_.reserve(n); open_.reserve(n); high_.reserve(n);
+        low_.reserve(n); close_.reserve(n); volume_.reserve(n);
+    }
+    void resize(std::size_t n) {
+        ts_.resize(n); open_.resize(n); high_.resize(n);
+        low_.resize(n); close_.resize(n); volume_.resize(n);
+    }
+    void clear() { resize(0); }
+
+    void push_back(const Bar& b) {
+        ts_.push_back(b.ts); open_.push_back(b.open); high_.push_back(b.high);
+        low_.push_back(b.low); close_.push_back(b.close); volume_.push_back(b.volume);
+    }
+    void set(std::size_t i, const Bar& b) {
+        ts_[i] = b.ts; open_[i] = b.open; high_[i] = b.high;
+        low_[i] = b.low; close_[i] = b.close; volume_[i] = b.volume;
+    }
+    Bar operator[](std::size_t i) const { return {ts_[i], open_[i], high_[i], low_[i], close_[i], volume_[i]}; }
+
+    // Raw column access for batch kernels
+    const std::int64_t* ts() const { return ts_.data(); }
+    const double* open() const { return open_.data(); }
+    const double* high() const { return high_.data(); }
+    const double* low() const { return low_.data(); }
+    const double* close() const { return close_.data(); }
+    const double* volume() const { return volume_.data(); }
+    std::int64_t* ts() { return ts_.data(); }
+    double* open() { return open_.data(); }
+    double* high() { return high_.data(); }
+    double* low() { return low_.data(); }
+    double* close() { return close_.data(); }
+    double* volume() { return volume_.data(); }
+
+    BarView view() const {
+        return BarView(ts_.data(), open_.data(), high_.data(), low_.data(), close_.data(), volume_.data(), size());
+    }
+    std::vector<Bar> to_vector() const { return view().to_vector(); }
+
+private:
+    AlignedVector<std::int64_t> ts_;
+    AlignedVector<double> open_;
+    AlignedVector<double> high_;
+    AlignedVector<double> low_;
+    AlignedVector<double> close_;
+    AlignedVector<double> volume_;
+};
+
+}
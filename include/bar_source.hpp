@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include "data_loader.hpp"
+#include "bar_view.hpp"
+
+namespace hft {
+
+// Pull-based bar stream. Engines request bars in chunks, so only one chunk
+// is ever resident regardless of the length of the history.
+class BarSource {
+public:
+    virtual ~BarSource() = default;
+    // Copy up to max bars into out; returns the count, 0 at end of stream
+    virtual std::size_t next(Bar* out, std::size_t max) = 0;
+};
+
+// Streams an in-memory or mapped series (vector, BarStore view)
+class ViewBarSource : public BarSource {
+public:
+    explicit ViewBarSource(const BarView& v) : view_(v) {}
+    std::size_t next(Bar* out, std::size_t max) override {
+        std::size_t m = 0;
+        for (; m < max && pos_ < view_.size(); ++m, ++pos_) out[m] = view_[pos_];
+        return m;
+    }
+private:
+    BarView view_;
+    std::size_t pos_ = 0;
+};
+
+// Reads a ts,open,high,low,close,volume CSV in fixed-size blocks and parses
+// complete lines as they arrive; memory use is bounded by the block size.
+class CsvBarSource : public BarSource {
+public:
+    explicit CsvBarSource(const std::string& path, std::size_t block_bytes = 1 << 20);
+    ~CsvBarSource() override;
+    CsvBarSource(const CsvBarSource&) = delete;
+    CsvBarSource& operator=(const CsvBarSource&) = delete;
+
+    bool is_open() const { return f_ != nullptr; }
+    std::size_t malformed() const { return malformed_; }
+    std::size_t next(Bar* out, std::size_t max) override;
+
+private:
+    bool refill();
+
+    std::FILE* f_ = nullptr;
+    std::vector<char> buf_;
+    std::size_t begin_ = 0;  // unparsed bytes are buf_[begin_, end_)
+    std::size_t end_ = 0;
+    std::size_t block_;
+    bool eof_ = false;
+    bool first_line_ = true;
+    std::size_t malformed_ = 0;
+};
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include "bar_view.hpp"
+#include "mapped_file.hpp"
+
+namespace hft {
+
+// Native columnar bar file (.hftb)
+//
+//   header | per-symbol blocks: ts[] open[] high[] low[] close[] volume[]
+//          | symbol table | per-symbol/per-day index
+//
+// Columns are 64-byte aligned and stored in native byte order; a reader
+// maps the file and hands out BarViews straight into the mapping.
+namespace barstore {
+
+constexpr char kMagic[8] = {'H', 'F', 'T', 'B', 'A', 'R', 'S', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+constexpr std::int64_t kDayMs = 86400000;
+constexpr std::size_t kNameLen = 32;
+constexpr std::size_t kColumns = 6;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t num_symbols;
+    std::uint64_t num_index;
+    std::uint64_t num_rows;
+    std::uint64_t symbols_offset;
+    std::uint64_t index_offset;
+    std::uint64_t reserved;
+};
+
+struct SymbolEntry {
+    char name[kNameLen];
+    std::uint64_t row_count;
+    std::uint64_t column_offset[kColumns]; // ts, open, high, low, close, volume
+    std::uint64_t index_begin;
+    std::uint64_t index_count;
+};
+
+struct IndexEntry {
+    std::int64_t day;         // floor(ts / kDayMs)
+    std::uint64_t row_begin;  // relative to the symbol's first row
+    std::uint64_t row_count;
+};
+
+static_assert(sizeof(FileHeader) == 64, "bar store header layout");
+static_assert(sizeof(SymbolEntry) == 104, "bar store symbol layout");
+static_assert(sizeof(IndexEntry) == 24, "bar store index layout");
+
+inline std::int64_t day_of(std::int64_t ts) {
+    std::int64_t d = ts / kDayMs;
+    return (ts % kDayMs < 0) ? d - 1 : d;
+}
+
+}
+
+// Streams symbols into a .hftb file one at a time, so converting a large
+// universe only ever holds one symbol in memory.
+class BarStoreWriter {
+public:
+    BarStoreWriter() = default;
+    ~BarStoreWriter();
+    BarStoreWriter(const BarStoreWriter&) = delete;
+    BarStoreWriter& operator=(const BarStoreWriter&) = delete;
+
+    bool open(const std::string& path);
+    // Bars must be sorted by ts. Returns false on I/O error, a duplicate
+    // symbol or a name longer than 31 characters.
+    bool add_symbol(const std::string& symbol, const BarView& bars);
+    bool add_symbol(const std::string& symbol, const std::vector<Bar>& bars) { return add_symbol(symbol, BarView::of(bars)); }
+    bool close();
+
+private:
+    bool write_at(std::uint64_t off, const void* p, std::size_t n);
+    bool pad_to_alignment();
+
+    std::FILE* f_ = nullptr;
+    std::uint64_t pos_ = 0;
+    std::uint64_t rows_ = 0;
+    std::vector<barstore::SymbolEntry> symbols_;
+    std::vector<barstore::IndexEntry> index_;
+};
+
+// Memory-mapped reader. Opening only validates the header and loads the
+// (small) symbol table; bar data is paged in on access.
+class BarStore {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+
+    std::vector<std::string> symbols() const;
+    std::size_t num_rows() const { return rows_; }
+
+    // Whole history of a symbol; empty view if unknown
+    BarView bars(const std::string& symbol) const;
+    // Bars with from_ts <= ts < to_ts, located via the day index and a
+    // binary search inside the boundary days
+    BarView range(const std::string& symbol, std::int64_t from_ts, std::int64_t to_ts) const;
+
+    // Convert CSV files (symbol, path) into a bar store
+    static bool convert_csv(const std::vector<std::pair<std::string, std::string>>& symbol_csvs,
+                            const std::string& out_path);
+
+private:
+    BarView view_of(const barstore::SymbolEntry& s) const;
+    std::size_t lower_bound_row(const barstore::SymbolEntry& s, const BarView& v, std::int64_t ts) const;
+
+    MappedFile file_;
+    const barstore::SymbolEntry* syms_ = nullptr;
+    const barstore::IndexEntry* index_ = nullptr;
+    std::size_t nsyms_ = 0;
+    std::size_t rows_ = 0;
+    std::unordered_map<std::string, std::size_t> by_name_;
+};
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "data_loader.hpp"
+
+namespace hft {
+
+// Non-owning, read-only view of a bar series. Each field is addressed as
+// base + i * stride, so the same view covers columnar storage (stride ==
+// sizeof(double), e.g. a mapped BarStore) and a row-major std::vector<Bar>
+// (stride == sizeof(Bar)) without copying either.
+class BarView {
+public:
+    BarView() = default;
+
+    // Columnar: six contiguous arrays of n elements each
+    BarView(const std::int64_t* ts, const double* open, const double* high,
+            const double* low, const double* close, const double* volume, std::size_t n)
+        : ts_(reinterpret_cast<const char*>(ts)), open_(reinterpret_cast<const char*>(open)),
+          high_(reinterpret_cast<const char*>(high)), low_(reinterpret_cast<const char*>(low)),
+          close_(reinterpret_cast<const char*>(close)), volume_(reinterpret_cast<const char*>(volume)),
+          stride_(sizeof(double)), n_(n) {}
+
+    // Row-major view over an existing vector of bars
+    static BarView of(const std::vector<Bar>& bars) {
+        BarView v;
+        if (bars.empty()) return v;
+        const Bar* b = bars.data();
+        v.ts_ = reinterpret_cast<const char*>(&b->ts);
+        v.open_ = reinterpret_cast<const char*>(&b->open);
+        v.high_ = reinterpret_cast<const char*>(&b->high);
+        v.low_ = reinterpret_cast<const char*>(&b->low);
+        v.close_ = reinterpret_cast<const char*>(&b->close);
+        v.volume_ = reinterpret_cast<const char*>(&b->volume);
+        v.stride_ = sizeof(Bar);
+        v.n_ = bars.size();
+        return v;
+    }
+
+    std::size_t size() const { return n_; }
+    bool empty() const { return n_ == 0; }
+    bool columnar() const { return stride_ == sizeof(double); }
+
+    std::int64_t ts(std::size_t i) const { return *reinterpret_cast<const std::int64_t*>(ts_ + i * stride_); }
+    double open(std::size_t i) const { return at(open_, i); }
+    double high(std::size_t i) const { return at(high_, i); }
+    double low(std::size_t i) const { return at(low_, i); }
+    double close(std::size_t i) const { return at(close_, i); }
+    double volume(std::size_t i) const { return at(volume_, i); }
+
+    // Cache hint for row i; for loops that revisit many series out of order
+    void prefetch(std::size_t i) const {
+#if defined(__GNUC__) || defined(__clang__)
+        std::size_t off = i * stride_;
+        __builtin_prefetch(ts_ + off); __builtin_prefetch(open_ + off); __builtin_prefetch(high_ + off);
+        __builtin_prefetch(low_ + off); __builtin_prefetch(close_ + off); __builtin_prefetch(volume_ + off);
+#else
+        (void)i;
+#endif
+    }
+
+    Bar operator[](std::size_t i) const { return {ts(i), open(i), high(i), low(i), close(i), volume(i)}; }
+
+    BarView slice(std::size_t from, std::size_t count) const {
+        if (from > n_) from = n_;
+        if (count > n_ - from) count = n_ - from;
+        BarView v = *this;
+        std::size_t off = from * stride_;
+        if (n_) { v.ts_ += off; v.open_ += off; v.high_ += off; v.low_ += off; v.close_ += off; v.volume_ += off; }
+        v.n_ = count;
+        return v;
+    }
+
+    std::vector<Bar> to_vector() const {
+        std::vector<Bar> out; out.reserve(n_);
+        for (std::size_t i = 0; i < n_; ++i) out.push_back((*this)[i]);
+        return out;
+    }
+
+private:
+    double at(const char* base, std::size_t i) const { return *reinterpret_cast<const double*>(base + i * stride_); }
+
+    const char* ts_ = nullptr;
+    const char* open_ = nullptr;
+    const char* high_ = nullptr;
+    const char* low_ = nullptr;
+    const char* close_ = nullptr;
+    const char* volume_ = nullptr;
+    std::size_t stride_ = sizeof(double);
+    std::size_t n_ = 0;
+};
+
+}
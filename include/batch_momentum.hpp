@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bar_columns.hpp"
+#include "bar_source.hpp"
+#include "bar_view.hpp"
+#include "costs.hpp"
+#include "streaming.hpp"
+
+namespace hft {
+
+struct MomentumParams {
+    int lookback = 20;
+    int qty = 1;
+};
+
+// Many MomentumStrategy configurations advanced together in one pass over
+// the bars. State is structure-of-arrays (cash, position, return moments,
+// drawdown per configuration) and the closes a lookback needs come from
+// one shared history ring, so each bar is read once for all of them and
+// the per-configuration work is a branch-free loop, 4 wide with AVX2.
+//
+// Each result is bit-identical to Backtester::run_stream with
+// MomentumStrategy(lookback, qty) and the same costs (curve_points is 0).
+class BatchMomentum {
+public:
+    BatchMomentum(const std::vector<MomentumParams>& params, const CostModel& costs = {});
+
+    // Advances every configuration by one bar
+    void add(double close);
+    // Per configuration, in the order given
+    std::vector<StreamResult> results() const;
+    std::size_t size() const { return n_; }
+
+    static std::vector<StreamResult> run(const BarView& bars, const std::vector<MomentumParams>& params,
+                                         const CostModel& costs = {});
+    static std::vector<StreamResult> run_stream(BarSource& src, const std::vector<MomentumParams>& params,
+                                                const CostModel& costs = {}, const StreamOptions& opt = {});
+
+private:
+    std::size_t n_;      // configurations
+    std::size_t lanes_;  // n_ rounded up to the vector width
+    CostModel costs_;
+    std::vector<double> ring_;
+    std::uint64_t mask_ = 0;
+    std::uint64_t bars_ = 0;
+    std::size_t rets_ = 0; // returns added to every configuration's moments
+    bool avx2_ = false;
+
+    AlignedVector<std::int64_t> lm1_; // lookback - 1
+    AlignedVector<double> qty_;
+    AlignedVector<double> cash_;
+    AlignedVector<double> pos_;
+    AlignedVector<double> prev_;
+    AlignedVector<double> mean_;
+    AlignedVector<double> m2_;
+    AlignedVector<double> peak_;
+    AlignedVector<double> max_dd_;
+    AlignedVector<double> trades_;
+};
+
+}
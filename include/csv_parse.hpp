@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "data_loader.hpp"
+
+namespace hft {
+namespace csv {
+
+// Locale-free number parsing over a [p, end) byte range. Each parser
+// advances p past the token and returns false if no number was found.
+
+inline void skip_blanks(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+}
+
+inline bool parse_int64(const char*& p, const char* end, std::int64_t& out) {
+    skip_blanks(p, end);
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+    if (p >= end || (unsigned)(*p - '0') > 9) return false;
+    std::uint64_t v = 0;
+    while (p < end && (unsigned)(*p - '0') <= 9) { v = v * 10 + (unsigned)(*p - '0'); ++p; }
+    out = neg ? -(std::int64_t)v : (std::int64_t)v;
+    return true;
+}
+
+// Exact powers of ten representable as doubles (10^0 .. 10^22).
+inline double pow10_exact(int e) {
+    static const double tbl[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return tbl[e];
+}
+
+// Decimal -> double. Mantissas of up to 15 significant digits with a decimal
+// exponent within +-22 are converted exactly by one multiply/divide (the
+// result is correctly rounded, same as strtod). Anything longer falls back
+// to strtod on a copy of the token.
+inline bool parse_double(const char*& p, const char* end, double& out) {
+    skip_blanks(p, end);
+    const char* start = p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+    std::uint64_t mant = 0;
+    int sig = 0;      // significant digits accumulated into mant
+    int dropped = 0;  // integer digits beyond what mant can hold
+    int exp10 = 0;
+    bool any = false;
+    while (p < end && (unsigned)(*p - '0') <= 9) {
+        any = true;
+        if (sig < 19) { mant = mant * 10 + (unsigned)(*p - '0'); if (mant) ++sig; }
+        else ++dropped;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && (unsigned)(*p - '0') <= 9) {
+            any = true;
+            if (sig < 19) { mant = mant * 10 + (unsigned)(*p - '0'); if (mant) ++sig; --exp10; }
+            ++p;
+        }
+    }
+    if (!any) { p = start; return false; }
+    exp10 += dropped;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool eneg = false;
+        if (q < end && (*q == '-' || *q == '+')) { eneg = (*q == '-'); ++q; }
+        if (q < end && (unsigned)(*q - '0') <= 9) {
+            int e = 0;
+            while (q < end && (unsigned)(*q - '0') <= 9) { if (e < 100000) e = e * 10 + (*q - '0'); ++q; }
+            exp10 += eneg ? -e : e;
+            p = q;
+        }
+    }
+    if (sig <= 15 && dropped == 0 && exp10 >= -22 && exp10 <= 22) {
+        double v = (double)mant;
+        v = exp10 < 0 ? v / pow10_exact(-exp10) : v * pow10_exact(exp10);
+        out = neg ? -v : v;
+        return true;
+    }
+    char buf[128];
+    std::size_t len = (std::size_t)(p - start);
+    if (len >= sizeof(buf)) return false;
+    std::memcpy(buf, start, len);
+    buf[len] = '\0';
+    out = std::strtod(buf, nullptr);
+    return true;
+}
+
+inline bool expect_sep(const char*& p, const char* end) {
+    skip_blanks(p, end);
+    if (p < end && *p == ',') { ++p; return true; }
+    return false;
+}
+
+// Parse one "ts,open,high,low,close,volume" line (without its newline).
+// Trailing fields are ignored, as in DataLoader::load_csv.
+inline bool parse_bar(const char* p, const char* end, Bar& b) {
+    return parse_int64(p, end, b.ts) && expect_sep(p, end) &&
+           parse_double(p, end, b.open) && expect_sep(p, end) &&
+           parse_double(p, end, b.high) && expect_sep(p, end) &&
+           parse_double(p, end, b.low) && expect_sep(p, end) &&
+           parse_double(p, end, b.close) && expect_sep(p, end) &&
+           parse_double(p, end, b.volume);
+}
+
+// True for a header line such as "ts,open,high,low,close,volume"
+// (same rule load_csv applies to the first line).
+inline bool is_header(const char* p, const char* end) {
+    bool has_ts = false, has_comma = false;
+    for (const char* q = p; q < end; ++q) {
+        if (*q == ',') has_comma = true;
+        else if (*q == 't' && q + 1 < end && q[1] == 's') has_ts = true;
+    }
+    return has_ts && has_comma;
+}
+
+inline bool is_blank(const char* p, const char* end) {
+    for (; p < end; ++p) if (*p != ' ' && *p != '\t' && *p != '\r') return false;
+    return true;
+}
+
+}
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <optional>
 #include <cstdint>
+#include <cstddef>
 
 namespace hft {
 
@@ -15,10 +16,25 @@ struct Bar {
     double volume;
 };
 
+// Ingestion statistics reported by the fast loaders
+struct LoadStats {
+    std::size_t rows = 0;        // bars parsed
+    std::size_t malformed = 0;   // non-empty lines that failed to parse
+    double seconds = 0;
+    double rows_per_sec = 0;
+};
+
+class BarColumns; // bar_columns.hpp
+
 // Simple CSV loader: ts,open,high,low,close,volume
 class DataLoader {
 public:
     static std::vector<Bar> load_csv(const std::string& path);
+    // Maps the file and parses straight from the mapped bytes with a
+    // locale-free parser; returns the same bars as load_csv.
+    static std::vector<Bar> load_csv_mmap(const std::string& path, LoadStats* stats = nullptr);
+    // Same parser, writing straight into structure-of-arrays columns
+    static BarColumns load_csv_columns(const std::string& path, LoadStats* stats = nullptr);
 };
 
 }
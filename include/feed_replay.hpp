@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bar_source.hpp"
+#include "itch_feed.hpp"
+#include "limit_order_book.hpp"
+#include "market_events.hpp"
+
+namespace hft {
+
+// Keeps one LimitOrderBook per symbol current from book deltas and passes
+// every event on to a downstream handler. Executions carry no price on the
+// wire; they are priced from the resting order and also forwarded as a
+// TradeEvent, so downstream sees the complete print tape. Events reach
+// downstream after the book has applied them.
+class BookReplay : public MarketEventHandler {
+public:
+    explicit BookReplay(MarketEventHandler* downstream = nullptr, double tick_size = 0.01)
+        : down_(downstream), tick_(tick_size) {}
+
+    void on_quote(const QuoteEvent& q) override { if (down_) down_->on_quote(q); }
+    void on_trade(const TradeEvent& t) override { if (down_) down_->on_trade(t); }
+    void on_book(const BookDelta& d) override;
+
+    // Created empty on first use
+    LimitOrderBook& book(std::uint16_t symbol);
+    const LimitOrderBook* find(std::uint16_t symbol) const {
+        return symbol < books_.size() ? books_[symbol].get() : nullptr;
+    }
+    std::size_t rejected() const { return rejected_; } // deltas for unknown orders
+
+private:
+    MarketEventHandler* down_;
+    double tick_;
+    std::vector<std::unique_ptr<LimitOrderBook>> books_;
+    std::size_t rejected_ = 0;
+};
+
+// Builds OHLCV bars per symbol from trades in fixed wall-clock buckets.
+// A bar is stamped with its bucket start (ms) and emitted once a trade of
+// a later bucket arrives, or on flush(). Buckets without trades produce no
+// bar.
+class BarAggregator : public MarketEventHandler {
+public:
+    using Sink = std::function<void(std::uint16_t symbol, const Bar& bar)>;
+    BarAggregator(std::int64_t interval_ms, Sink sink)
+        : interval_ns_((interval_ms > 0 ? interval_ms : 1) * 1000000), sink_(std::move(sink)) {}
+
+    void on_trade(const TradeEvent& t) override;
+    // Emits every open bar
+    void flush();
+
+private:
+    struct Open {
+        bool active = false;
+        std::int64_t bucket = 0;
+        Bar bar{};
+    };
+    std::int64_t interval_ns_;
+    Sink sink_;
+    std::vector<Open> open_;
+};
+
+// Bars of one symbol of a feed file, aggregated on the fly, so any Strategy
+// runs on tick data through Backtester::run_stream. The symbol's book is
+// kept current as well; to fill against it (BookFillModel on book()) set
+// StreamOptions::chunk_bars = 1 so the book is in step with each bar.
+class FeedBarSource : public BarSource {
+public:
+    // An empty symbol selects the first one in the feed's directory
+    FeedBarSource(const std::string& path, const std::string& symbol, std::int64_t interval_ms);
+
+    bool is_open() const { return reader_.is_open(); }
+    int locate() const { return locate_; }
+    const FeedReader& reader() const { return reader_; }
+    // Null until the symbol has been seen in the directory
+    LimitOrderBook* book() { return locate_ >= 0 ? &replay_.book((std::uint16_t)locate_) : nullptr; }
+    std::size_t next(Bar* out, std::size_t max) override;
+
+private:
+    void resolve();
+
+    FeedReader reader_;
+    std::string symbol_;
+    int locate_ = -1;
+    BarAggregator agg_;
+    BookReplay replay_;
+    std::vector<Bar> ready_;
+    std::size_t ready_pos_ = 0;
+    MarketEvent pending_;
+    bool has_pending_ = false;
+    bool done_ = false;
+};
+
+}
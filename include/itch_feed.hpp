@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "mapped_file.hpp"
+#include "market_events.hpp"
+
+namespace hft {
+
+// Binary market-data feed modeled on NASDAQ ITCH 5.0. Each message is a
+// 2-byte big-endian length followed by the message; all integers are
+// big-endian and prices are u32 with 4 implied decimals. Unlike ITCH the
+// timestamp is a full u64 of nanoseconds since the epoch rather than 6
+// bytes since midnight, so files can span days.
+//
+//   header  type u8, locate u16, tracking u16, ts u64            (13 bytes)
+//   'R'     stock char[8]                                          symbol directory
+//   'A'     ref u64, side 'B'/'S', shares u32, stock[8], price u32 add order
+//   'E'     ref u64, shares u32, match u64                         order executed
+//   'X'     ref u64, shares u32                                    partial cancel
+//   'D'     ref u64                                                order delete
+//   'U'     orig u64, new u64, shares u32, price u32               order replace
+//   'P'     ref u64, side, shares u32, stock[8], price u32, match u64  hidden trade
+//   'Q'     bid u32, bid shares u32, ask u32, ask shares u32       top of book (not in ITCH)
+namespace itch {
+constexpr std::size_t kHeader = 13;
+inline std::size_t message_size(char type) {
+    switch (type) {
+    case 'R': return kHeader + 8;
+    case 'A': return kHeader + 25;
+    case 'E': return kHeader + 20;
+    case 'X': return kHeader + 12;
+    case 'D': return kHeader + 8;
+    case 'U': return kHeader + 24;
+    case 'P': return kHeader + 33;
+    case 'Q': return kHeader + 16;
+    default: return 0;
+    }
+}
+}
+
+// Buffered encoder; messages go out in the order they are written
+class FeedWriter {
+public:
+    explicit FeedWriter(const std::string& path, std::size_t buffer_bytes = 1 << 16);
+    ~FeedWriter() { close(); }
+    FeedWriter(const FeedWriter&) = delete;
+    FeedWriter& operator=(const FeedWriter&) = delete;
+
+    bool is_open() const { return f_ != nullptr; }
+    void symbol(std::int64_t ts_ns, std::uint16_t locate, const std::string& name);
+    void add(std::int64_t ts_ns, std::uint16_t locate, OrderId id, Side side, double price, std::uint32_t qty);
+    void execute(std::int64_t ts_ns, std::uint16_t locate, OrderId id, std::uint32_t qty, std::uint64_t match = 0);
+    void cancel(std::int64_t ts_ns, std::uint16_t locate, OrderId id, std::uint32_t qty);
+    void remove(std::int64_t ts_ns, std::uint16_t locate, OrderId id);
+    void replace(std::int64_t ts_ns, std::uint16_t locate, OrderId id, OrderId new_id, double price, std::uint32_t qty);
+    void trade(std::int64_t ts_ns, std::uint16_t locate, Side aggressor, double price, std::uint32_t qty, std::uint64_t match = 0);
+    void quote(std::int64_t ts_ns, std::uint16_t locate, double bid, std::uint32_t bid_qty, double ask, std::uint32_t ask_qty);
+    std::size_t messages() const { return messages_; }
+    // Flushes and closes; false if any write failed
+    bool close();
+
+private:
+    char* begin(char type, std::int64_t ts_ns, std::uint16_t locate);
+
+    std::FILE* f_ = nullptr;
+    std::vector<char> buf_;
+    std::size_t used_ = 0;
+    std::size_t messages_ = 0;
+    bool failed_ = false;
+};
+
+// Zero-copy decoder over a mapped file (or a caller-owned buffer): next()
+// reads fields straight out of the mapping into a MarketEvent. Directory
+// messages are consumed to build the symbol table; unknown message types
+// are skipped by their length, short ones are counted as malformed.
+class FeedReader {
+public:
+    FeedReader() = default;
+    explicit FeedReader(const std::string& path) { open(path); }
+    FeedReader(const char* data, std::size_t size) { open(data, size); }
+
+    bool open(const std::string& path);
+    void open(const char* data, std::size_t size);
+    bool is_open() const { return data_ != nullptr; }
+    void rewind();
+
+    // Decodes the next event; false at end of data
+    bool next(MarketEvent& ev);
+    // Dispatches every remaining event to h; returns the count
+    std::size_t replay(MarketEventHandler& h);
+
+    // Symbol directory seen so far
+    const std::string& symbol(std::uint16_t locate) const;
+    int locate(const std::string& name) const; // -1 if not (yet) seen
+    const std::vector<std::string>& symbols() const { return symbols_; }
+
+    std::size_t bytes() const { return (std::size_t)(end_ - data_); }
+    std::size_t position() const { return (std::size_t)(p_ - data_); }
+    std::size_t messages() const { return messages_; }
+    std::size_t malformed() const { return malformed_; }
+    bool truncated() const { return truncated_; } // file ends inside a message
+
+private:
+    MappedFile file_;
+    const char* data_ = nullptr;
+    const char* p_ = nullptr;
+    const char* end_ = nullptr;
+    std::vector<std::string> symbols_;
+    std::size_t messages_ = 0;
+    std::size_t malformed_ = 0;
+    bool truncated_ = false;
+};
+
+// Writes a plausible order flow for tests and benchmarks: per symbol a
+// random-walk mid with adds around it, cancels, replaces, executions
+// against resting orders and periodic quotes. Deterministic for a seed.
+bool write_synthetic_feed(const std::string& path, const std::vector<std::string>& symbols,
+                          std::size_t messages, std::int64_t t0_ns = 1731321600000000000LL,
+                          std::int64_t mean_gap_ns = 1000000, std::uint64_t seed = 42);
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "advanced_backtester.hpp"
+#include "parameter_sweep.hpp"
+#include "work_stealing.hpp"
+
+namespace hft {
+
+// One (symbol, strategy, params) cell of a batch
+struct BacktestJob {
+    std::string name;           // asset name of the result
+    std::string symbol;         // jobs on one symbol start on the same worker
+    BarView bars;
+    StrategyFactory factory;    // called once per job, so no state is shared
+    std::vector<double> params;
+    CostModel costs{};
+    RiskControl risk{};
+    OrderBook lob{};
+};
+
+struct SchedulerConfig {
+    std::size_t threads = 0;   // 0 = hardware concurrency
+    bool pin = false;          // pin pool threads to consecutive cores
+};
+
+struct ScheduleResult {
+    std::vector<AssetBacktest> results;   // one per job, in job order
+    std::vector<WorkerStats> workers;
+    double seconds = 0;
+    // Share of threads x wall time spent inside jobs
+    double utilization() const;
+};
+
+// Runs a batch of AdvancedBacktester jobs on a WorkStealingPool. Jobs are
+// placed by symbol (each symbol's bars are first touched, and mostly
+// reused, by one worker, which keeps them in that core's cache and, for
+// mapped stores, on its memory node), symbols are dealt longest first to
+// the least loaded worker, and each worker runs its own largest job first.
+// Idle workers steal, so bar counts differing by 100x still keep every
+// core busy to the end. Results do not depend on the schedule.
+class JobScheduler {
+public:
+    static ScheduleResult run(const std::vector<BacktestJob>& jobs, const SchedulerConfig& cfg = {});
+    // Initial queue per worker, each listed smallest job first
+    static std::vector<std::vector<std::size_t>> place(const std::vector<BacktestJob>& jobs, std::size_t workers);
+};
+
+}
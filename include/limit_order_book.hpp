@@ -0,0 +1,204 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "market_events.hpp"
+#include "orderbook.hpp"
+
+namespace hft {
+
+struct LevelInfo {
+    double price = 0;
+    std::int64_t qty = 0;
+    std::uint32_t orders = 0;
+};
+
+// One execution of a simulated order
+struct BookFill {
+    OrderId id;
+    Side side;
+    double price;
+    std::int64_t qty;
+    std::int64_t remaining;
+};
+
+struct SimOrderState {
+    bool active = false;
+    std::int64_t remaining = 0;
+    std::int64_t filled = 0;
+    std::int64_t queue_ahead = 0; // displayed quantity with priority over it
+};
+
+// Price-time priority L3 book. Levels live in flat arrays indexed by tick
+// offset from a base price (re-centred and grown on demand); orders are
+// nodes of a pooled intrusive FIFO per level, found by id through an
+// open-addressing table. Market-data ids must be non-zero and below 2^63.
+//
+// Simulated orders (place) never change the displayed book. A resting one
+// is filled by the market-data flow: executions at its price against
+// orders queued behind it, executions at a worse price, and incoming
+// orders that cross it. It fills at its own limit price, possibly in parts.
+class LimitOrderBook {
+public:
+    explicit LimitOrderBook(double tick_size = 0.01, std::size_t levels = 4096);
+
+    void clear();
+
+    // Market data
+    bool add(OrderId id, Side side, double price, std::int64_t qty);
+    bool cancel(OrderId id);                          // delete (also cancels a simulated order)
+    bool reduce(OrderId id, std::int64_t qty);        // partial cancel, keeps priority
+    bool modify(OrderId id, std::int64_t new_qty);    // smaller keeps priority, larger goes to the back
+    bool replace(OrderId id, OrderId new_id, double price, std::int64_t qty); // new priority
+    bool execute(OrderId id, std::int64_t qty);       // trade against a resting order
+
+    // Queries
+    double tick_size() const { return tick_; }
+    std::int64_t to_ticks(double price) const { return (std::int64_t)std::llround(price / tick_); }
+    double to_price(std::int64_t ticks) const { return ticks * tick_; }
+    bool has_bid() const { return bid_orders_ > 0; }
+    bool has_ask() const { return ask_orders_ > 0; }
+    double best_bid() const { return to_price(best_bid_); }
+    double best_ask() const { return to_price(best_ask_); }
+    double mid() const { return (best_bid() + best_ask()) / 2; }
+    std::int64_t qty_at(Side side, double price) const;
+    // Up to n levels from the best outward
+    std::size_t depth(Side side, std::size_t n, std::vector<LevelInfo>& out) const;
+    std::size_t order_count() const { return bid_orders_ + ask_orders_; }
+    // A resting market-data order; false if the id is not in the book
+    bool order(OrderId id, Side* side, double* price, std::int64_t* qty) const;
+
+    // Walks displayed depth on the opposite side for a marketable order of
+    // qty (Buy takes asks); returns the fillable quantity and its average
+    // price, up to limit_price when it is positive, after passing over the
+    // first `skip` units (depth already taken). The book is not changed.
+    std::int64_t sweep(Side side, std::int64_t qty, double* avg_price, double limit_price = 0,
+                       std::int64_t skip = 0) const;
+
+    // Simulated orders: a marketable part fills at once against displayed
+    // depth, the rest rests behind everything displayed at its price.
+    // Returns 0 for a bad request.
+    OrderId place(Side side, double price, std::int64_t qty);
+    SimOrderState sim_state(OrderId id) const;
+    // Simulated fills since the last clear_fills
+    const std::vector<BookFill>& fills() const { return fills_; }
+    void clear_fills() { fills_.clear(); }
+
+private:
+    static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+    static constexpr OrderId kSimBit = OrderId(1) << 63;
+    static constexpr std::size_t kMaxLevels = std::size_t(1) << 22; // per side
+
+    struct Node {
+        OrderId id;
+        std::int64_t qty;
+        std::int64_t px;
+        std::uint64_t seq;
+        std::uint32_t prev;
+        std::uint32_t next;
+        Side side;
+    };
+    struct Level {
+        std::uint32_t head = kNil;
+        std::uint32_t tail = kNil;
+        std::int64_t qty = 0;
+        std::uint32_t orders = 0;
+    };
+    struct Sim {
+        OrderId id;
+        Side side;
+        std::int64_t px;
+        std::int64_t remaining;
+        std::int64_t filled;
+        std::uint64_t seq;
+        bool active;
+    };
+
+    // id -> node index, linear probing with backward-shift deletion
+    class IdIndex {
+    public:
+        void reset(std::size_t cap);
+        std::uint32_t find(OrderId id) const;
+        void insert(OrderId id, std::uint32_t node);
+        void erase(OrderId id);
+        std::size_t size() const { return size_; }
+    private:
+        struct Slot { OrderId id; std::uint32_t node; };
+        std::size_t home(OrderId id) const { return (std::size_t)((id * 0x9E3779B97F4A7C15ull) >> shift_); }
+        std::vector<Slot> slots_;
+        std::size_t mask_ = 0;
+        unsigned shift_ = 64;
+        std::size_t size_ = 0;
+    };
+
+    Level& level(Side side, std::int64_t px) { return (side == Side::Buy ? bids_ : asks_)[px - base_]; }
+    const Level* find_level(Side side, std::int64_t px) const;
+    bool ensure_range(std::int64_t px);
+    std::uint32_t alloc_node();
+    void link(std::uint32_t n);
+    void unlink(std::uint32_t n);
+    void remove(std::uint32_t n);
+    void refresh_best(Side side);
+    bool add_ticks(OrderId id, Side side, std::int64_t px, std::int64_t qty);
+    void sim_trade(Side side, std::int64_t px, std::uint64_t seq, std::int64_t qty);
+    void sim_cross(Side incoming, std::int64_t px, std::int64_t qty);
+    void sim_fill(Sim& s, std::int64_t px, std::int64_t qty);
+    std::vector<std::uint32_t>& resting(Side side) { return side == Side::Buy ? resting_bids_ : resting_asks_; }
+    void rest(std::uint32_t slot);
+    Sim* find_sim(OrderId id);
+    const Sim* find_sim(OrderId id) const;
+
+    double tick_;
+    std::int64_t base_ = 0;
+    bool based_ = false;
+    std::vector<Level> bids_;
+    std::vector<Level> asks_;
+    std::int64_t best_bid_ = 0;
+    std::int64_t best_ask_ = 0;
+    std::size_t bid_orders_ = 0;
+    std::size_t ask_orders_ = 0;
+
+    std::vector<Node> nodes_;
+    std::uint32_t free_ = kNil;
+    IdIndex index_;
+    std::uint64_t seq_ = 0;
+
+    // Every simulated order ever placed, slot = id - 1, for sim_state; the
+    // active ones are also listed per side by slot, worst priority first,
+    // so fills walk from the back and pop what they complete
+    std::vector<Sim> sims_;
+    std::size_t active_sims_ = 0;
+    std::vector<std::uint32_t> resting_bids_;
+    std::vector<std::uint32_t> resting_asks_;
+    std::vector<BookFill> fills_;
+};
+
+// Fills an engine's orders by sweeping a LimitOrderBook's displayed depth,
+// so large orders fill partially and pay for the levels they walk. The book
+// is either kept current by the caller (e.g. from a feed) or, with
+// synthesize(), rebuilt around each bar's close before filling. Orders on
+// the same bar share its depth: each walks only what earlier ones left.
+class BookFillModel : public FillModel {
+public:
+    explicit BookFillModel(LimitOrderBook& book) : book_(book) {}
+    // Ladder of `levels` per side, first level half_spread_ticks from the
+    // close, one tick apart, each showing depth_fraction of the bar volume
+    void synthesize(int levels, int half_spread_ticks, double depth_fraction) {
+        levels_ = levels; half_spread_ = half_spread_ticks; depth_fraction_ = depth_fraction;
+    }
+    FillResult fill(const Bar& bar, int qty) override;
+
+private:
+    void rebuild(const Bar& bar);
+
+    LimitOrderBook& book_;
+    int levels_ = 0;
+    int half_spread_ = 1;
+    double depth_fraction_ = 0;
+    std::int64_t bar_ts_ = 0;
+    bool seen_ = false;
+    std::int64_t taken_bought_ = 0;   // depth taken on bar_ts_, per side
+    std::int64_t taken_sold_ = 0;
+};
+
+}
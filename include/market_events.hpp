@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+namespace hft {
+
+enum class Side : std::uint8_t { Buy, Sell };
+
+using OrderId = std::uint64_t;
+
+// Tick-level market data. Timestamps are nanoseconds since the Unix epoch;
+// symbols are the feed's 16-bit locate codes (see FeedReader::symbol).
+
+// Top of book
+struct QuoteEvent {
+    std::int64_t ts_ns;
+    std::uint16_t symbol;
+    double bid;
+    double ask;
+    std::int64_t bid_qty;
+    std::int64_t ask_qty;
+};
+
+struct TradeEvent {
+    std::int64_t ts_ns;
+    std::uint16_t symbol;
+    Side aggressor;
+    double price;
+    std::int64_t qty;
+    OrderId order_id; // resting order hit, 0 if not displayed
+};
+
+enum class BookAction : std::uint8_t { Add, Execute, Cancel, Delete, Replace };
+
+// Order-level change. Add and Replace carry side/price/qty; Execute and
+// Cancel carry the quantity taken off; Replace moves id to new_id.
+struct BookDelta {
+    std::int64_t ts_ns;
+    std::uint16_t symbol;
+    BookAction action;
+    Side side;
+    OrderId id;
+    OrderId new_id;
+    double price;
+    std::int64_t qty;
+};
+
+enum class EventType : std::uint8_t { Quote, Trade, Book };
+
+struct MarketEvent {
+    EventType type;
+    union {
+        QuoteEvent quote;
+        TradeEvent trade;
+        BookDelta book;
+    };
+    MarketEvent() : type(EventType::Quote), quote() {}
+};
+
+class MarketEventHandler {
+public:
+    virtual ~MarketEventHandler() = default;
+    virtual void on_quote(const QuoteEvent&) {}
+    virtual void on_trade(const TradeEvent&) {}
+    virtual void on_book(const BookDelta&) {}
+};
+
+inline void dispatch(const MarketEvent& ev, MarketEventHandler& h) {
+    switch (ev.type) {
+    case EventType::Quote: h.on_quote(ev.quote); break;
+    case EventType::Trade: h.on_trade(ev.trade); break;
+    case EventType::Book: h.on_book(ev.book); break;
+    }
+}
+
+}
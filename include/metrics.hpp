@@ -1,6 +1,12 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "online_stats.hpp"
+#include "simd_kernels.hpp"
 
 namespace hft {
 
@@ -25,4 +31,253 @@ inline double max_drawdown(const std::vector<double>& equity) {
     return mdd;
 }
 
+// One-pass performance statistics of a mark-to-market equity series: the
+// engines add() every bar's equity and the metrics are ready when the loop
+// ends, in O(1) memory. Returns are per bar; pass periods (e.g. 252) to
+// annualize. Win rate and profit factor are over bars with non-zero P&L.
+//
+// merge() pools an independent series (another asset, path or worker)
+// without its curve, so the accessors no longer describe one book:
+// - final_equity(), total_return() and annualized_return() are those of
+//   the combined book (equities add up);
+// - sharpe(), sortino(), win_rate(), profit_factor() and avg_win/loss()
+//   are over the pooled bars of all series, not the combined book's;
+// - max_drawdown() and max_drawdown_bars() are those of the worst single
+//   series, not the combined book's;
+// - calmar() mixes the two and is not meaningful.
+// It is not for two time chunks of one series; those go through after()
+// and append().
+//
+// For a series split in time, the accumulator of a later chunk starts as
+// after(previous chunk), which carries the last equity, the peak and the
+// bars spent under it across the boundary; previous.append(later) then
+// gives what one pass over both chunks gives. Counts, drawdown and its
+// duration, first/last equity and total return are bitwise equal; the
+// return moments and P&L sums are added per chunk, so they agree with one
+// pass to rounding.
+class MetricsAccumulator {
+public:
+    void add(double equity) {
+        if (bars_ == 0) first_ = equity;
+        if (bars_ != 0 || carried_) {
+            double pnl = equity - last_;
+            double r = pnl / last_;
+            rets_.add(r);
+            if (r < 0) { ++down_n_; down_s1_ += r; down_s2_ += r * r; }
+            if (pnl > 0) { ++wins_; gross_win_ += pnl; }
+            else if (pnl < 0) { ++losses_; gross_loss_ -= pnl; }
+            ++span_;
+        }
+        dd_.add(equity);
+        if (equity >= dd_.peak) under_ = 0;
+        else if (++under_ > max_under_) max_under_ = under_;
+        last_ = equity;
+        ++bars_;
+    }
+
+    // Empty accumulator for the chunk that follows prev in time
+    static MetricsAccumulator after(const MetricsAccumulator& prev) {
+        MetricsAccumulator m;
+        if (prev.bars_ == 0 && !prev.carried_) return m;
+        m.carried_ = true;
+        m.last_ = prev.last_;
+        m.dd_ = prev.dd_;
+        m.dd_.max_dd = 0;
+        m.under_ = prev.under_;
+        return m;
+    }
+
+    // Extends this series by o, the chunk right after it, started as
+    // after(*this)
+    void append(const MetricsAccumulator& o) {
+        if (o.bars_ == 0) return;
+        if (bars_ == 0 && !carried_) { *this = o; return; }
+        if (bars_ == 0) first_ = o.first_;
+        rets_.merge(o.rets_);
+        down_n_ += o.down_n_;
+        down_s1_ += o.down_s1_;
+        down_s2_ += o.down_s2_;
+        wins_ += o.wins_;
+        losses_ += o.losses_;
+        gross_win_ += o.gross_win_;
+        gross_loss_ += o.gross_loss_;
+        double max_dd = std::max(dd_.max_dd, o.dd_.max_dd);
+        dd_ = o.dd_;
+        dd_.max_dd = max_dd;
+        under_ = o.under_;
+        if (o.max_under_ > max_under_) max_under_ = o.max_under_;
+        last_ = o.last_;
+        bars_ += o.bars_;
+        span_ += o.span_;
+    }
+
+    void merge(const MetricsAccumulator& o) {
+        if (o.bars_ == 0) return;
+        if (bars_ == 0) { *this = o; return; }
+        rets_.merge(o.rets_);
+        down_n_ += o.down_n_;
+        down_s1_ += o.down_s1_;
+        down_s2_ += o.down_s2_;
+        wins_ += o.wins_;
+        losses_ += o.losses_;
+        gross_win_ += o.gross_win_;
+        gross_loss_ += o.gross_loss_;
+        if (o.dd_.max_dd > dd_.max_dd) dd_.max_dd = o.dd_.max_dd;
+        if (o.max_under_ > max_under_) max_under_ = o.max_under_;
+        first_ += o.first_;
+        last_ += o.last_;
+        bars_ += o.bars_;
+        if (o.span_ > span_) span_ = o.span_;
+    }
+
+    // The accumulator add() builds over eq[0..n), from whole-array passes
+    // (simd::simple_returns, mean_variance, max_drawdown) instead of one
+    // dependent update per bar. Returns go through a cache-sized buffer
+    // block by block, with the moments merged. Their mean and variance,
+    // hence sharpe and sortino, agree with add() to rounding; the rest is
+    // exact.
+    static MetricsAccumulator from_equity(const double* eq, std::size_t n) {
+        MetricsAccumulator m;
+        if (n == 0) return m;
+        const simd::KernelTable& k = simd::kernels();
+        m.bars_ = n;
+        m.span_ = n - 1;
+        m.first_ = eq[0];
+        m.last_ = eq[n - 1];
+        const std::size_t block = 4096;
+        std::vector<double> r(std::min(n - 1, block));
+        for (std::size_t b0 = 0; b0 + 1 < n; b0 += block) {
+            std::size_t nb = std::min(block, n - 1 - b0);
+            k.simple_returns(eq + b0, nb + 1, r.data());
+            double mean, var;
+            k.mean_variance(r.data(), nb, &mean, &var);
+            m.rets_.merge(RunningMoments{nb, mean, var * (double)nb});
+            m.tally(eq + b0, r.data(), nb);
+        }
+        m.dd_.started = true;
+        m.dd_.max_dd = k.max_drawdown(eq, n);
+        double peak = eq[0];
+        std::size_t under = 0, max_under = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (eq[i] >= peak) { peak = eq[i]; under = 0; }
+            else if (++under > max_under) max_under = under;
+        }
+        m.dd_.peak = peak;
+        m.under_ = under;
+        m.max_under_ = max_under;
+        return m;
+    }
+
+    std::size_t bars() const { return bars_; }
+    const RunningMoments& returns() const { return rets_; }
+    double final_equity() const { return last_; }
+    double total_return() const { return bars_ ? (last_ - first_) / first_ : 0.0; }
+    // Compounded over `periods` returns per year, as sharpe() annualizes
+    double annualized_return(double periods = 252.0) const {
+        return span_ ? std::pow(1.0 + total_return(), periods / span_) - 1.0 : 0.0;
+    }
+
+    double sharpe(double periods = 1.0) const {
+        double sd = rets_.stdev();
+        return sd > 0 ? rets_.mean / sd * std::sqrt(periods) : 0.0;
+    }
+    // Downside deviation around the mean over the negative returns, as
+    // simd::downside_deviation; sum (r - m)^2 expands into running sums
+    double downside_deviation() const {
+        if (!down_n_) return 0.0;
+        double m = rets_.mean;
+        double s = down_s2_ - 2.0 * m * down_s1_ + down_n_ * m * m;
+        return std::sqrt(std::max(0.0, s) / down_n_);
+    }
+    double sortino(double periods = 1.0) const {
+        double d = downside_deviation();
+        return d > 0 ? rets_.mean / d * std::sqrt(periods) : 0.0;
+    }
+    double max_drawdown() const { return dd_.max_dd; }
+    // Longest run of bars spent below a previous peak
+    std::size_t max_drawdown_bars() const { return max_under_; }
+    double calmar(double periods = 252.0) const {
+        return dd_.max_dd > 0 ? annualized_return(periods) / dd_.max_dd : 0.0;
+    }
+
+    std::size_t winning_bars() const { return wins_; }
+    std::size_t losing_bars() const { return losses_; }
+    double win_rate() const { return wins_ + losses_ ? (double)wins_ / (double)(wins_ + losses_) : 0.0; }
+    double profit_factor() const { return gross_loss_ > 0 ? gross_win_ / gross_loss_ : 0.0; }
+    double avg_win() const { return wins_ ? gross_win_ / wins_ : 0.0; }
+    double avg_loss() const { return losses_ ? gross_loss_ / losses_ : 0.0; }
+
+    // Accumulated state through a StateWriter/StateReader (checkpoints)
+    template <class W>
+    void save(W& w) const {
+        w.put(rets_); w.put(dd_);
+        w.put((std::uint64_t)bars_); w.put((std::uint64_t)span_); w.put(first_); w.put(last_);
+        w.put((std::uint64_t)down_n_); w.put(down_s1_); w.put(down_s2_);
+        w.put((std::uint64_t)wins_); w.put((std::uint64_t)losses_); w.put(gross_win_); w.put(gross_loss_);
+        w.put((std::uint64_t)under_); w.put((std::uint64_t)max_under_); w.put(carried_);
+    }
+    template <class R>
+    bool load(R& r) {
+        std::uint64_t bars, span, down_n, wins, losses, under, max_under;
+        if (!(r.get(rets_) && r.get(dd_) && r.get(bars) && r.get(span) && r.get(first_) && r.get(last_) &&
+              r.get(down_n) && r.get(down_s1_) && r.get(down_s2_) && r.get(wins) && r.get(losses) &&
+              r.get(gross_win_) && r.get(gross_loss_) && r.get(under) && r.get(max_under) && r.get(carried_)))
+            return false;
+        bars_ = (std::size_t)bars; span_ = (std::size_t)span; down_n_ = (std::size_t)down_n;
+        wins_ = (std::size_t)wins; losses_ = (std::size_t)losses;
+        under_ = (std::size_t)under; max_under_ = (std::size_t)max_under;
+        return true;
+    }
+
+private:
+    // The P&L tallies add() keeps, over returns r[i] = e[i+1] / e[i] - 1.
+    // Masked adds rather than branches on signs that are a coin flip; the
+    // +0 added otherwise leaves every sum exactly as add() has it. Sums
+    // are local so they stay in registers.
+    void tally(const double* e, const double* r, std::size_t n) {
+        std::size_t down_n = down_n_, wins = wins_, losses = losses_;
+        double down_s1 = down_s1_, down_s2 = down_s2_, gross_win = gross_win_, gross_loss = gross_loss_;
+        for (std::size_t i = 0; i < n; ++i) {
+            double ri = r[i], pnl = e[i + 1] - e[i];
+            double neg = keep_if(ri < 0, ri);
+            down_n += ri < 0;
+            down_s1 += neg;
+            down_s2 += neg * neg;
+            wins += pnl > 0;
+            losses += pnl < 0;
+            gross_win += keep_if(pnl > 0, pnl);
+            gross_loss -= keep_if(pnl < 0, pnl);
+        }
+        down_n_ = down_n; wins_ = wins; losses_ = losses;
+        down_s1_ = down_s1; down_s2_ = down_s2; gross_win_ = gross_win; gross_loss_ = gross_loss;
+    }
+
+    // x if keep, else +0, through a bit mask (compilers turn a ternary
+    // into a branch)
+    static double keep_if(bool keep, double x) {
+        std::uint64_t b;
+        std::memcpy(&b, &x, sizeof b);
+        b &= 0 - (std::uint64_t)keep;
+        std::memcpy(&x, &b, sizeof b);
+        return x;
+    }
+
+    RunningMoments rets_;
+    RunningDrawdown dd_;
+    std::size_t bars_ = 0;
+    std::size_t span_ = 0;     // returns in the longest merged series, for annualizing
+    double first_ = 0;
+    double last_ = 0;
+    std::size_t down_n_ = 0;
+    double down_s1_ = 0;
+    double down_s2_ = 0;
+    std::size_t wins_ = 0;
+    std::size_t losses_ = 0;
+    double gross_win_ = 0;
+    double gross_loss_ = 0;
+    std::size_t under_ = 0;
+    std::size_t max_under_ = 0;
+    bool carried_ = false;     // last_ is the equity before the first add()
+};
+
 }
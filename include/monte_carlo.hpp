@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "bar_source.hpp"
+#include "costs.hpp"
+#include "metrics.hpp"
+#include "philox.hpp"
+#include "strategy.hpp"
+
+namespace hft {
+
+enum class PathModel { Gbm, Jump, Garch };
+
+// Synthetic price process. Log returns are drift - var/2 + sqrt(var) z with
+// var = vol^2 (Gbm), plus a N(jump_mean, jump_vol^2) jump with probability
+// jump_prob per bar (Jump), or GARCH(1,1) variance targeting vol^2 in the
+// long run (Garch). OHLCV is built like generate_random_walk.
+struct PathSpec {
+    int bars = 1000;
+    double start = 100.0;
+    double drift = 0.0002;
+    double vol = 0.005;
+    std::int64_t ts0 = 1731321600000;
+    std::int64_t dt_ms = 60000;
+    PathModel model = PathModel::Gbm;
+    double jump_prob = 0.01;
+    double jump_mean = 0.0;
+    double jump_vol = 0.02;
+    double garch_alpha = 0.08;
+    double garch_beta = 0.9;
+};
+
+// Generates one path on demand. Every draw is Philox(seed) at counter
+// (bar, slot, path), so a path is a pure function of (spec, seed, path):
+// the same on any thread, for any chunk size, with nothing precomputed.
+class PathBarSource : public BarSource {
+public:
+    PathBarSource(const PathSpec& spec, std::uint64_t seed, std::uint64_t path);
+    std::size_t next(Bar* out, std::size_t max) override;
+
+private:
+    PathSpec spec_;
+    Philox4x32::Key key_;
+    std::uint64_t path_;
+    std::size_t bar_ = 0;
+    double price_;
+    double var_;
+    double eps2_;     // previous squared shock (Garch)
+    std::vector<Philox4x32::Block> blocks_;
+    std::vector<double> z_, zv_;
+};
+
+// Whole path into a vector or BarColumns, mainly for inspection and tests
+template <class Out>
+inline void monte_carlo_path_into(Out& bars, const PathSpec& spec, std::uint64_t seed, std::uint64_t path) {
+    PathBarSource src(spec, seed, path);
+    Bar buf[256];
+    bars.reserve(bars.size() + (spec.bars > 0 ? spec.bars : 0));
+    for (std::size_t m; (m = src.next(buf, 256)) > 0;)
+        for (std::size_t i = 0; i < m; ++i) bars.push_back(buf[i]);
+}
+
+using PathStrategyFactory = std::function<std::unique_ptr<Strategy>()>;
+
+struct MonteCarloConfig {
+    PathSpec spec{};
+    std::size_t paths = 10000;
+    std::uint64_t seed = 42;
+    std::size_t threads = 0;       // 0 = hardware concurrency
+    std::size_t chunk_bars = 1024; // bars generated per pull
+    CostModel costs{};
+};
+
+// Distribution of one metric across paths
+struct MetricDistribution {
+    double mean = 0;
+    double stdev = 0;
+    double min = 0;
+    double p05 = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double max = 0;
+};
+
+struct MonteCarloResult {
+    std::size_t paths = 0;
+    MetricDistribution sharpe;
+    MetricDistribution final_equity;
+    MetricDistribution max_dd;
+    MetricDistribution num_trades;
+    double prob_loss = 0;          // share of paths ending below initial cash
+    MetricsAccumulator pooled;     // every path's bars merged (path order)
+};
+
+// Backtests a fresh strategy on every simulated path in parallel. Paths are
+// streamed through Backtester::run_stream, so memory is one chunk per
+// worker plus one StreamResult per path; no bars or equity curves are kept.
+// Results are identical for any thread count.
+class MonteCarlo {
+public:
+    static MonteCarloResult run(const PathStrategyFactory& factory, const MonteCarloConfig& cfg = {});
+};
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+namespace hft {
+
+// Welford running mean / variance (population), mergeable across chunks
+struct RunningMoments {
+    std::size_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+
+    void add(double x) {
+        ++n;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    double variance() const { return n ? m2 / n : 0.0; }
+    double stdev() const { return std::sqrt(variance()); }
+
+    // Chan et al. pairwise combination
+    void merge(const RunningMoments& o) {
+        if (o.n == 0) return;
+        if (n == 0) { *this = o; return; }
+        std::size_t tot = n + o.n;
+        double d = o.mean - mean;
+        mean += d * o.n / tot;
+        m2 += o.m2 + d * d * ((double)n * o.n / tot);
+        n = tot;
+    }
+};
+
+// Running peak and maximum relative drawdown of an equity series
+struct RunningDrawdown {
+    bool started = false;
+    double peak = 0;
+    double max_dd = 0;
+
+    void add(double v) {
+        if (!started) { peak = v; started = true; }
+        if (v > peak) peak = v;
+        double dd = (peak - v) / peak;
+        if (dd > max_dd) max_dd = dd;
+    }
+};
+
+}
@@ -2,6 +2,7 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include "data_loader.hpp"
 
 namespace hft {
 
@@ -10,7 +11,7 @@ struct OrderBook {
     double bid_spread; // bps
     double ask_spread; // bps
     double impact_coeff; // impact = coeff * qty / volume
-    
+
     // Estimated fill price with impact
     double get_fill_price(double ref_price, int qty, bool is_buy) const {
         double spread = (is_buy ? ask_spread : bid_spread) / 10000.0;
@@ -20,4 +21,29 @@ struct OrderBook {
     }
 };
 
+// Execution of one order: filled has the sign of the request and may be
+// smaller in size (partial fill) or 0 (no fill); price is the average.
+struct FillResult {
+    int filled = 0;
+    double price = 0;
+};
+
+// How an engine turns a strategy's order on a bar into an execution
+class FillModel {
+public:
+    virtual ~FillModel() = default;
+    virtual FillResult fill(const Bar& bar, int qty) = 0;
+};
+
+// Always fills in full at the OrderBook formula price around the close
+class FormulaFillModel final : public FillModel {
+public:
+    explicit FormulaFillModel(const OrderBook& lob) : lob_(lob) {}
+    FillResult fill(const Bar& bar, int qty) override {
+        return {qty, lob_.get_fill_price(bar.close, qty, qty > 0)};
+    }
+private:
+    const OrderBook& lob_;
+};
+
 }
@@ -0,0 +1,106 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include "bar_view.hpp"
+#include "strategy.hpp"
+#include "costs.hpp"
+
+namespace hft {
+
+// Cartesian grid of named parameter values. Combination i is decoded from
+// its index in mixed radix (the last dimension varies fastest), so the
+// grid itself is never materialized.
+class ParamGrid {
+public:
+    ParamGrid& add(const std::string& name, std::vector<double> values) {
+        names_.push_back(name);
+        values_.push_back(std::move(values));
+        return *this;
+    }
+
+    // Inclusive range from..to in increments of step
+    static std::vector<double> range(double from, double to, double step) {
+        std::vector<double> v;
+        if (step <= 0) return v;
+        for (int i = 0;; ++i) {
+            double x = from + i * step;
+            if (x > to + step * 1e-9) break;
+            v.push_back(x);
+        }
+        return v;
+    }
+
+    std::size_t dims() const { return names_.size(); }
+    const std::string& name(std::size_t d) const { return names_[d]; }
+    std::size_t size() const {
+        if (values_.empty()) return 0;
+        std::size_t n = 1;
+        for (const auto& v : values_) n *= v.size();
+        return n;
+    }
+    void at(std::size_t idx, std::vector<double>& out) const {
+        out.resize(values_.size());
+        for (std::size_t d = values_.size(); d-- > 0;) {
+            out[d] = values_[d][idx % values_[d].size()];
+            idx /= values_[d].size();
+        }
+    }
+    std::vector<double> at(std::size_t idx) const { std::vector<double> p; at(idx, p); return p; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::vector<double>> values_;
+};
+
+enum class SweepMetric { Sharpe, FinalEquity, MaxDrawdown };
+
+// Builds a fresh strategy for one parameter combination
+using StrategyFactory = std::function<std::unique_ptr<Strategy>(const std::vector<double>& params)>;
+
+// Factory ignoring params that returns copies of proto as it was when
+// constructed (state reset), independent of later changes to proto
+inline StrategyFactory clone_factory(const Strategy& proto) {
+    std::unique_ptr<Strategy> fresh = proto.clone();
+    fresh->reset();
+    std::shared_ptr<const Strategy> p(std::move(fresh));
+    return [p](const std::vector<double>&) { return p->clone(); };
+}
+
+struct SweepConfig {
+    SweepMetric metric = SweepMetric::Sharpe;
+    std::size_t top_k = 10;
+    std::size_t threads = 0;  // 0 = hardware concurrency
+    CostModel costs{};
+};
+
+// Summary of one evaluated combination; equity curves are never kept
+struct SweepEntry {
+    std::size_t index = 0;
+    std::vector<double> params;
+    double score = 0;  // higher is better (drawdown is negated)
+    double sharpe = 0;
+    double drawdown = 0;
+    double final_equity = 0;
+    std::size_t num_trades = 0;
+};
+
+class ParameterSweep {
+public:
+    // Evaluates every grid combination with Backtester over the shared,
+    // read-only bars and returns the best top_k entries, best first (ties
+    // resolved by grid index, so results do not depend on thread timing).
+    static std::vector<SweepEntry> run(const BarView& bars, const ParamGrid& grid,
+                                       const StrategyFactory& factory, const SweepConfig& cfg = {});
+    // Momentum grid ("lookback" and optionally "qty", other dimensions are
+    // ignored) evaluated with BatchMomentum: bars are read once per block of
+    // combinations rather than once per combination. Returns the same
+    // entries as run() with a MomentumStrategy factory; empty without a
+    // "lookback" dimension.
+    static std::vector<SweepEntry> run_momentum(const BarView& bars, const ParamGrid& grid,
+                                                const SweepConfig& cfg = {});
+};
+
+}
@@ -2,7 +2,7 @@
 #include <vector>
 #include <string>
 #include <cmath>
-#include <algorithm>
+#include "metrics.hpp"
 
 namespace hft {
 
@@ -21,47 +21,31 @@ struct PerformanceMetrics {
     double avg_loss = 0;
 };
 
-inline PerformanceMetrics compute_metrics(const std::vector<double>& equity_curve, int num_trades) {
+// Daily-bar view of an accumulator (returns annualized over 252 periods).
+// Win/loss figures count bars with non-zero P&L; trades are not tracked as
+// round trips, so winning_trades is left at 0.
+inline PerformanceMetrics performance_metrics(const MetricsAccumulator& acc, int num_trades) {
     PerformanceMetrics m;
-    if (equity_curve.empty()) return m;
-    
-    m.total_return = (equity_curve.back() - equity_curve[0]) / equity_curve[0];
-    double annual_periods = 252.0; // trading days
-    m.annualized_return = std::pow(1.0 + m.total_return, annual_periods / equity_curve.size()) - 1.0;
-    
-    std::vector<double> returns;
-    for (size_t i = 1; i < equity_curve.size(); ++i) {
-        double ret = (equity_curve[i] - equity_curve[i-1]) / equity_curve[i-1];
-        returns.push_back(ret);
-    }
-    
-    if (!returns.empty()) {
-        double mean = 0; for (double r : returns) mean += r; mean /= returns.size();
-        double var = 0; for (double r : returns) { double d = r - mean; var += d*d; } var /= returns.size();
-        double sd = std::sqrt(var);
-        m.sharpe_ratio = (sd > 0) ? (mean / sd * std::sqrt(252.0)) : 0.0;
-        
-        std::vector<double> downside;
-        for (double r : returns) if (r < 0) downside.push_back(r);
-        if (!downside.empty()) {
-            double down_var = 0; for (double r : downside) { double d = r - mean; down_var += d*d; } down_var /= downside.size();
-            double down_sd = std::sqrt(down_var);
-            m.sortino_ratio = (down_sd > 0) ? (mean / down_sd * std::sqrt(252.0)) : 0.0;
-        }
-    }
-    
-    double peak = equity_curve[0];
-    m.max_drawdown = 0;
-    for (double v : equity_curve) {
-        if (v > peak) peak = v;
-        double dd = (peak - v) / peak;
-        if (dd > m.max_drawdown) m.max_drawdown = dd;
-    }
-    
-    m.calmar_ratio = (m.max_drawdown > 0) ? (m.annualized_return / m.max_drawdown) : 0.0;
+    if (acc.bars() == 0) return m;
+    m.total_return = acc.total_return();
+    m.annualized_return = acc.annualized_return(252.0);
+    m.sharpe_ratio = acc.sharpe(252.0);
+    m.sortino_ratio = acc.sortino(252.0);
+    m.max_drawdown = acc.max_drawdown();
+    m.calmar_ratio = acc.calmar(252.0);
+    m.win_rate = acc.win_rate();
+    m.profit_factor = acc.profit_factor();
+    m.avg_win = acc.avg_win();
+    m.avg_loss = acc.avg_loss();
     m.total_trades = num_trades;
-    
     return m;
 }
 
+// For a stored curve; engine results already carry their accumulator
+inline PerformanceMetrics compute_metrics(const std::vector<double>& equity_curve, int num_trades) {
+    MetricsAccumulator acc;
+    for (double v : equity_curve) acc.add(v);
+    return performance_metrics(acc, num_trades);
+}
+
 }
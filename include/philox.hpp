@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace hft {
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Output is a pure function of a 128-bit
+// counter and a 64-bit key, so any stream or position is reachable in O(1)
+// and parallel streams need no shared state: key = seed, counter = (draw
+// index, stream id).
+class Philox4x32 {
+public:
+    using Block = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static Block block(Block ctr, Key key) {
+        for (int r = 0; r < 10; ++r) {
+            if (r) { key[0] += 0x9E3779B9u; key[1] += 0xBB67AE85u; }
+            std::uint64_t p0 = (std::uint64_t)0xD2511F53u * ctr[0];
+            std::uint64_t p1 = (std::uint64_t)0xCD9E8D57u * ctr[2];
+            ctr = {(std::uint32_t)(p1 >> 32) ^ ctr[1] ^ key[0], (std::uint32_t)p1,
+                   (std::uint32_t)(p0 >> 32) ^ ctr[3] ^ key[1], (std::uint32_t)p0};
+        }
+        return ctr;
+    }
+    static Key key_of(std::uint64_t seed) { return {(std::uint32_t)seed, (std::uint32_t)(seed >> 32)}; }
+
+    // Uniform in (0, 1) from 64 bits, 53 of them significant
+    static double to_uniform(std::uint32_t hi, std::uint32_t lo) {
+        std::uint64_t v = ((std::uint64_t)hi << 32 | lo) >> 11;
+        return ((double)v + 0.5) * (1.0 / 9007199254740992.0);
+    }
+    // Two independent standard normals from one block (Box-Muller)
+    static void to_normals(const Block& b, double& z0, double& z1) {
+        double u1 = to_uniform(b[0], b[1]);
+        double u2 = to_uniform(b[2], b[3]);
+        double r = std::sqrt(-2.0 * std::log(u1));
+        double a = 6.283185307179586 * u2;
+        z0 = r * std::cos(a);
+        z1 = r * std::sin(a);
+    }
+
+    // Sequential use: one stream of a seed, blocks drawn in counter order
+    explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0)
+        : key_(key_of(seed)), stream_(stream) {}
+
+    Block next_block() { return block(ctr(pos_++), key_); }
+    std::uint32_t next_u32() {
+        if (used_ == 4) { buf_ = next_block(); used_ = 0; }
+        return buf_[used_++];
+    }
+    std::uint64_t next_u64() { std::uint64_t hi = next_u32(); return hi << 32 | next_u32(); }
+    double uniform() { std::uint32_t hi = next_u32(); return to_uniform(hi, next_u32()); }
+    double normal() {
+        if (has_spare_) { has_spare_ = false; return spare_; }
+        double z0;
+        to_normals(next_block(), z0, spare_);
+        has_spare_ = true;
+        return z0;
+    }
+
+    // Bulk draws start at the next whole block. The counters are generated
+    // in a separate pass from the transform, so the integer rounds
+    // vectorize; n normals consume ceil(n / 2) blocks.
+    void fill_normal(double* out, std::size_t n) {
+        constexpr std::size_t kBatch = 256;
+        Block blocks[kBatch];
+        for (std::size_t done = 0; done < n;) {
+            std::size_t nb = std::min(kBatch, (n - done + 1) / 2);
+            for (std::size_t i = 0; i < nb; ++i) blocks[i] = block(ctr(pos_ + i), key_);
+            pos_ += nb;
+            for (std::size_t i = 0; i < nb; ++i) {
+                double z0, z1;
+                to_normals(blocks[i], z0, z1);
+                out[done++] = z0;
+                if (done < n) out[done++] = z1;
+            }
+        }
+    }
+    void fill_uniform(double* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; i += 2) {
+            Block b = next_block();
+            out[i] = to_uniform(b[0], b[1]);
+            if (i + 1 < n) out[i + 1] = to_uniform(b[2], b[3]);
+        }
+    }
+
+    // Jump to block `pos` of the stream (drops buffered output)
+    void seek(std::uint64_t pos) { pos_ = pos; used_ = 4; has_spare_ = false; }
+    std::uint64_t position() const { return pos_; }
+
+private:
+    Block ctr(std::uint64_t pos) const {
+        return {(std::uint32_t)pos, (std::uint32_t)(pos >> 32), (std::uint32_t)stream_, (std::uint32_t)(stream_ >> 32)};
+    }
+
+    Key key_;
+    std::uint64_t stream_;
+    std::uint64_t pos_ = 0;
+    Block buf_{};
+    int used_ = 4;
+    double spare_ = 0;
+    bool has_spare_ = false;
+};
+
+}
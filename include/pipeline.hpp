@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bar_source.hpp"
+#include "spsc_ring.hpp"
+
+namespace hft {
+
+struct PipelineOptions {
+    std::size_t batch = 256;          // items handed between stages at once
+    std::size_t queue_capacity = 8192; // per ring, rounded to a power of two
+    bool pin = false;                 // pin stage k to core first_core + k
+    int first_core = 0;
+    // AdvancedBacktester::run_pipelined: the sink stage streams the equity
+    // curve (bar_idx,ts,equity, one point every curve_every bars) to this
+    // file while the engine runs, instead of leaving it to a report pass
+    std::string curve_path;
+    std::size_t curve_every = 1;
+};
+
+struct StageStats {
+    const char* name = "";
+    std::size_t items = 0;
+    std::size_t batches = 0;
+    double seconds = 0;        // stage start to finish
+    double wait_seconds = 0;   // blocked on an empty input or full output
+    std::size_t stalls = 0;
+    double queue_avg = 0;      // input queue depth seen at each pop
+    std::size_t queue_max = 0;
+
+    double throughput() const { return seconds > 0 ? (double)items / seconds : 0.0; }
+};
+
+// Best effort; false where affinity is unsupported or refused
+bool pin_current_thread(int core);
+void print_stage_stats(std::ostream& os, const std::vector<StageStats>& stages);
+
+// Three threads joined by SpscRings: decode (src.next into batches) ->
+// step(const Bar&) -> Out -> sink(const Out*, n). Each stage owns its
+// state, so step and sink run single-threaded in bar order and see exactly
+// what a serial loop would. Returns one StageStats per stage.
+template <class Out, class Step, class Sink>
+std::vector<StageStats> run_pipeline(BarSource& src, Step&& step, Sink&& sink, const PipelineOptions& opt = {}) {
+    using clock = std::chrono::steady_clock;
+    const std::size_t batch = opt.batch ? opt.batch : 1;
+    SpscRing<Bar> bars(opt.queue_capacity < batch ? batch : opt.queue_capacity);
+    SpscRing<Out> outs(opt.queue_capacity < batch ? batch : opt.queue_capacity);
+    std::vector<StageStats> stats(3);
+    stats[0].name = "decode";
+    stats[1].name = "engine";
+    stats[2].name = "sink";
+
+    auto seconds = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double>(b - a).count();
+    };
+    // Pushes all n items, waiting while the ring is full
+    auto push_all = [&](auto& ring, const auto* items, std::size_t n, StageStats& st) {
+        Backoff backoff;
+        for (std::size_t done = 0; done < n;) {
+            std::size_t k = ring.push(items + done, n - done);
+            if (k) { done += k; backoff.reset(); continue; }
+            ++st.stalls;
+            auto t0 = clock::now();
+            backoff.wait();
+            st.wait_seconds += seconds(t0, clock::now());
+        }
+    };
+    // Pops up to max items, waiting while empty; 0 once the producer closed
+    auto pop_some = [&](auto& ring, auto* out, std::size_t max, StageStats& st, double& depth_sum) {
+        Backoff backoff;
+        for (;;) {
+            std::size_t depth = ring.size();
+            std::size_t n = ring.pop(out, max);
+            if (!n && ring.closed()) n = ring.pop(out, max);
+            if (n) {
+                depth_sum += (double)depth;
+                if (depth > st.queue_max) st.queue_max = depth;
+                return n;
+            }
+            if (ring.closed()) return std::size_t(0);
+            ++st.stalls;
+            auto t0 = clock::now();
+            backoff.wait();
+            st.wait_seconds += seconds(t0, clock::now());
+        }
+    };
+    auto finish = [&](StageStats& st, clock::time_point t0, double depth_sum) {
+        st.seconds = seconds(t0, clock::now());
+        st.queue_avg = st.batches ? depth_sum / (double)st.batches : 0.0;
+    };
+
+    std::thread decode([&] {
+        if (opt.pin) pin_current_thread(opt.first_core);
+        StageStats& st = stats[0];
+        auto t0 = clock::now();
+        std::vector<Bar> buf(batch);
+        for (std::size_t got; (got = src.next(buf.data(), buf.size())) > 0;) {
+            push_all(bars, buf.data(), got, st);
+            st.items += got;
+            ++st.batches;
+        }
+        bars.close();
+        finish(st, t0, 0.0);
+    });
+    std::thread engine([&] {
+        if (opt.pin) pin_current_thread(opt.first_core + 1);
+        StageStats& st = stats[1];
+        auto t0 = clock::now();
+        double depth_sum = 0;
+        std::vector<Bar> in(batch);
+        std::vector<Out> out(batch);
+        for (std::size_t n; (n = pop_some(bars, in.data(), batch, st, depth_sum)) > 0;) {
+            for (std::size_t k = 0; k < n; ++k) out[k] = step(in[k]);
+            push_all(outs, out.data(), n, st);
+            st.items += n;
+            ++st.batches;
+        }
+        outs.close();
+        finish(st, t0, depth_sum);
+    });
+    std::thread report([&] {
+        if (opt.pin) pin_current_thread(opt.first_core + 2);
+        StageStats& st = stats[2];
+        auto t0 = clock::now();
+        double depth_sum = 0;
+        std::vector<Out> in(batch);
+        for (std::size_t n; (n = pop_some(outs, in.data(), batch, st, depth_sum)) > 0;) {
+            sink(in.data(), n);
+            st.items += n;
+            ++st.batches;
+        }
+        finish(st, t0, depth_sum);
+    });
+    decode.join();
+    engine.join();
+    report.join();
+    return stats;
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bar_view.hpp"
+#include "costs.hpp"
+#include "metrics.hpp"
+#include "orderbook.hpp"
+#include "strategy.hpp"
+
+namespace hft {
+
+struct PortfolioAsset {
+    std::string name;
+    BarView bars; // must be sorted by ts
+};
+
+// Portfolio-level limits; a trade that would break one is rejected
+struct PortfolioRisk {
+    int max_position = 100;            // per symbol, units long/short
+    double max_gross_exposure = 1e12;  // sum over symbols of |position| * close
+    double max_daily_loss = 1e12;      // from the day's opening equity; breach flattens the book
+                                       // and stops trading until the next UTC day
+};
+
+struct PortfolioOptions {
+    double initial_cash = 100000.0;
+    bool keep_curve = true;   // equity per distinct timestamp
+    bool keep_trades = false;
+};
+
+// Shared cash and positions, indexed by symbol. Market value and gross
+// exposure are kept incrementally so equity() is O(1) for any book size.
+class PortfolioBook {
+public:
+    std::size_t num_symbols() const { return pos_.size(); }
+    double cash() const { return cash_; }
+    int position(std::size_t sym) const { return pos_[sym]; }
+    double last_close(std::size_t sym) const { return last_[sym]; }
+    double equity() const { return cash_ + mv_; }
+    double gross_exposure() const { return gross_; }
+
+private:
+    friend class PortfolioEngine;
+    double cash_ = 0;
+    double mv_ = 0;
+    double gross_ = 0;
+    std::vector<int> pos_;
+    std::vector<double> last_;
+};
+
+// An order or fill for one symbol of the book
+struct PortfolioFill {
+    std::uint32_t symbol;
+    Trade trade;
+};
+
+// Sees every bar of every symbol in timestamp order and may trade any
+// symbol. Orders are appended with the symbol they trade (quantity signed);
+// the engine fills each against the order book at that symbol's latest
+// close, so an order for B placed on A's bar uses B's last price. Orders for
+// a symbol with no bar yet, or out of range, are rejected.
+class PortfolioStrategy {
+public:
+    virtual ~PortfolioStrategy() = default;
+    virtual void on_bar(std::size_t sym, const Bar& bar, const PortfolioBook& book, std::vector<PortfolioFill>& orders) = 0;
+};
+
+// Runs an independent single-asset Strategy per symbol. Each gets its own
+// StrategyContext mirroring the shared book (cash, that symbol's position);
+// edits it makes to the context are ignored, only its trades count.
+class PerSymbolStrategy : public PortfolioStrategy {
+public:
+    using Factory = std::function<std::unique_ptr<Strategy>(std::size_t sym)>;
+    PerSymbolStrategy(std::size_t num_symbols, const Factory& make);
+    // One reset clone of prototype per symbol
+    PerSymbolStrategy(std::size_t num_symbols, const Strategy& prototype);
+    void on_bar(std::size_t sym, const Bar& bar, const PortfolioBook& book, std::vector<PortfolioFill>& orders) override;
+
+private:
+    std::vector<std::unique_ptr<Strategy>> strats_;
+    std::vector<Trade> scratch_;
+};
+
+struct PortfolioSymbolResult {
+    std::string name;
+    int position = 0;
+    double last_close = 0;
+    std::size_t num_trades = 0;
+};
+
+struct PortfolioResult {
+    std::vector<std::int64_t> curve_ts;
+    std::vector<double> equity_curve;
+    std::vector<PortfolioFill> trades;
+    std::vector<PortfolioSymbolResult> symbols;
+    std::size_t events = 0;
+    std::size_t num_trades = 0;
+    std::size_t rejected = 0;      // orders refused by PortfolioRisk or for an unpriced symbol
+    std::size_t liquidations = 0;  // daily loss breaches
+    double sharpe = 0;             // over per-timestamp returns, annualized sqrt(252)
+    double max_dd = 0;
+    double final_equity = 0;
+    double seconds = 0;
+    MetricsAccumulator metrics;    // per-timestamp portfolio equity
+};
+
+// One event loop over all symbols: bars are k-way merged by ts (ties by
+// symbol index) through a loser tree, so each bar costs log2(k) compares.
+class PortfolioBacktester {
+public:
+    static PortfolioResult run(const std::vector<PortfolioAsset>& assets,
+                               PortfolioStrategy& strat,
+                               const CostModel& costs,
+                               const PortfolioRisk& risk,
+                               const OrderBook& lob,
+                               const PortfolioOptions& opt = {});
+};
+
+}
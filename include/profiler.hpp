@@ -0,0 +1,202 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HFT_PROF_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// Hot-path profiling. Configure with -DHFT_PROFILE=ON to compile the
+// HFT_PROFILE_SCOPE hooks in; without it they expand to nothing and the
+// engines are unchanged. The recording and export API below is always
+// built, so tools and tests can use ScopedTimer directly.
+//
+// Each thread records into its own ThreadLog (histograms plus a trace
+// ring), so recording takes no locks; summary() and write_chrome_trace()
+// read every log and must run once the instrumented threads are idle.
+
+#ifdef HFT_PROFILE
+#define HFT_PROF_CONCAT2(a, b) a##b
+#define HFT_PROF_CONCAT(a, b) HFT_PROF_CONCAT2(a, b)
+#define HFT_PROFILE_SCOPE(phase) \
+    ::hft::prof::ScopedTimer HFT_PROF_CONCAT(hft_prof_scope_, __LINE__)(::hft::prof::Phase::phase)
+#else
+#define HFT_PROFILE_SCOPE(phase) ((void)0)
+#endif
+
+namespace hft {
+namespace prof {
+
+#ifdef HFT_PROFILE
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+enum class Phase : std::uint8_t { Run, Strategy, Risk, Fill, Cost, MarkToMarket, Count };
+constexpr std::size_t kPhases = (std::size_t)Phase::Count;
+const char* phase_name(Phase p);
+
+// Raw timestamp: the TSC on x86, steady_clock nanoseconds elsewhere
+inline std::uint64_t ticks() {
+#ifdef HFT_PROF_TSC
+    return __rdtsc();
+#else
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+// Calibrated once against steady_clock
+double ns_per_tick();
+
+// Log-linear (HDR-style) histogram: values below 32 are exact, every power
+// of two above is split into 32 buckets, so percentiles are within ~3%.
+// Fixed size, no allocation on record.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr std::size_t kSub = (std::size_t)1 << kSubBits;
+    static constexpr std::size_t kBuckets = (64 - kSubBits + 1) * kSub;
+
+    void record(std::uint64_t v) {
+        ++counts_[index(v)];
+        ++count_;
+        sum_ += v;
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+    }
+    void merge(const LatencyHistogram& o);
+    void reset() { *this = LatencyHistogram(); }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t min() const { return count_ ? min_ : 0; }
+    std::uint64_t max() const { return max_; }
+    double mean() const { return count_ ? (double)sum_ / (double)count_ : 0.0; }
+    // Value at quantile p in [0, 1] (bucket midpoint, clamped to min/max)
+    std::uint64_t percentile(double p) const;
+
+    static std::size_t index(std::uint64_t v) {
+        if (v < kSub) return (std::size_t)v;
+        int k = 63 - clz(v);
+        return (std::size_t)(k - kSubBits + 1) * kSub + (std::size_t)((v >> (k - kSubBits)) & (kSub - 1));
+    }
+    static std::uint64_t lower_bound(std::size_t i) {
+        if (i < kSub) return i;
+        int k = (int)(i / kSub) + kSubBits - 1;
+        return ((std::uint64_t)1 << k) | ((std::uint64_t)(i % kSub) << (k - kSubBits));
+    }
+    static std::uint64_t width(std::size_t i) {
+        return i < 2 * kSub ? 1 : (std::uint64_t)1 << ((int)(i / kSub) - 1);
+    }
+
+private:
+    static int clz(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(v);
+#else
+        int n = 0;
+        for (std::uint64_t bit = (std::uint64_t)1 << 63; !(v & bit); bit >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    std::uint64_t counts_[kBuckets] = {};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t min_ = ~(std::uint64_t)0;
+    std::uint64_t max_ = 0;
+};
+
+struct TraceEvent {
+    std::uint64_t start;   // ticks
+    std::uint64_t dur;     // ticks
+    Phase phase;
+};
+
+// One thread's records. Only the owning thread writes; the trace keeps the
+// most recent `capacity` events.
+class ThreadLog {
+public:
+    ThreadLog(std::size_t id, std::size_t trace_capacity);
+
+    void record(Phase p, std::uint64_t t0, std::uint64_t t1) {
+        std::uint64_t d = t1 - t0;
+        hist_[(std::size_t)p].record(d);
+        if (!trace_.empty()) trace_[next_++ & mask_] = {t0, d, p};
+    }
+
+    std::size_t id() const { return id_; }
+    const LatencyHistogram& histogram(Phase p) const { return hist_[(std::size_t)p]; }
+    // Retained events, oldest first
+    std::vector<TraceEvent> events() const;
+    std::uint64_t dropped() const { return next_ > trace_.size() ? next_ - trace_.size() : 0; }
+    void reset(std::size_t trace_capacity);
+
+private:
+    std::size_t id_;
+    LatencyHistogram hist_[kPhases];
+    std::vector<TraceEvent> trace_;
+    std::uint64_t mask_ = 0;
+    std::uint64_t next_ = 0;
+};
+
+// Registers the calling thread on first use; logs live until process exit,
+// so threads may finish before the results are read
+ThreadLog* register_thread();
+inline ThreadLog& local() {
+    thread_local ThreadLog* log = nullptr;
+    if (!log) log = register_thread();
+    return *log;
+}
+
+class ScopedTimer {
+public:
+    // The log is looked up first so a thread's registration is not timed
+    explicit ScopedTimer(Phase p) : log_(&local()), phase_(p), t0_(ticks()) {}
+    ~ScopedTimer() { log_->record(phase_, t0_, ticks()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ThreadLog* log_;
+    Phase phase_;
+    std::uint64_t t0_;
+};
+
+// Trace ring size per thread in events (rounded up to a power of two, 0
+// disables tracing); applies to threads registered later and on reset()
+void set_trace_capacity(std::size_t events);
+// Clears every thread's records
+void reset();
+
+struct PhaseStats {
+    Phase phase;
+    const char* name;
+    std::uint64_t count;
+    double total_ns;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double max_ns;
+};
+// Phases with at least one record, merged over all threads
+std::vector<PhaseStats> summary();
+LatencyHistogram histogram(Phase p);
+void print_summary(std::FILE* out = stdout);
+
+// Chrome trace-event JSON ("X" events, one track per thread), viewable in
+// chrome://tracing or Perfetto
+bool write_chrome_trace(const std::string& path);
+
+}
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.hpp"
+
+namespace hft {
+
+// Appends doubles in shortest round-trip form (std::to_chars; "%.17g" where
+// the library lacks floating-point to_chars). Returns the end of the text;
+// out needs kMaxNumberChars of room.
+constexpr std::size_t kMaxNumberChars = 32;
+char* format_real(char* out, double v);
+char* format_integer(char* out, std::int64_t v);
+
+// Large-block file writer for report text and binary payloads. Output is
+// collected in one buffer and handed to the OS a block at a time; unlike
+// ofstream nothing is formatted through locales or virtual streambuf calls.
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& path, std::size_t buffer_bytes = 1 << 20);
+    ~BufferedWriter() { close(); }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    bool is_open() const { return f_ != nullptr; }
+    void write(const void* data, std::size_t n);
+    void text(const char* s);
+    void text(const std::string& s) { write(s.data(), s.size()); }
+    void put(char c) {
+        if (pos_ == buf_.size()) flush_buffer();
+        buf_[pos_++] = c;
+    }
+    void real(double v) { pos_ = format_real(room(kMaxNumberChars), v) - buf_.data(); }
+    void integer(std::int64_t v) { pos_ = format_integer(room(kMaxNumberChars), v) - buf_.data(); }
+    // Flushes and closes; false if any write failed
+    bool close();
+
+private:
+    char* room(std::size_t n) {
+        if (buf_.size() - pos_ < n) flush_buffer();
+        return buf_.data() + pos_;
+    }
+    void flush_buffer();
+
+    std::FILE* f_ = nullptr;
+    std::vector<char> buf_;
+    std::size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+// Columnar binary report (.hftc), little-endian:
+//   header   "HFTC", u32 version = 1, u32 column count, u32 0
+//   entries  u32 type, u32 name bytes, u64 count, u64 offset, u64 bytes,
+//            name, zero padding to 8
+//   data     per column at its offset (8-aligned): f64 / i64 arrays, or
+//            strings as u32 length + bytes
+// Columns are independent, so series of different lengths share a file.
+enum class ColumnType : std::uint32_t { F64 = 1, I64 = 2, Str = 3 };
+
+// Collects borrowed columns; the vectors must outlive write()
+class ColumnarWriter {
+public:
+    ColumnarWriter& add(const std::string& name, const std::vector<double>& v);
+    ColumnarWriter& add(const std::string& name, const std::vector<std::int64_t>& v);
+    ColumnarWriter& add(const std::string& name, const std::vector<std::string>& v);
+    bool write(const std::string& path) const;
+
+private:
+    struct Column {
+        std::string name;
+        ColumnType type;
+        const void* data;
+        std::size_t count;
+    };
+    std::vector<Column> cols_;
+};
+
+// Maps a .hftc file; numeric columns are read in place
+class ColumnarReader {
+public:
+    bool open(const std::string& path);
+    std::size_t columns() const { return cols_.size(); }
+    const std::string& name(std::size_t i) const { return cols_[i].name; }
+    ColumnType type(std::size_t i) const { return cols_[i].type; }
+    std::size_t count(std::size_t i) const { return cols_[i].count; }
+    // Index of a column by name, or columns() when absent
+    std::size_t find(const std::string& name) const;
+    const double* f64(std::size_t i) const;
+    const std::int64_t* i64(std::size_t i) const;
+    std::vector<std::string> strings(std::size_t i) const;
+
+private:
+    struct Column {
+        std::string name;
+        ColumnType type;
+        std::size_t count;
+        std::size_t offset;
+        std::size_t bytes;
+    };
+    MappedFile file_;
+    std::vector<Column> cols_;
+};
+
+// Single background thread running report jobs in submission order, so
+// formatting and disk I/O overlap whatever the caller computes next. Data a
+// job reads must stay unchanged until wait() returns.
+class ReportQueue {
+public:
+    ReportQueue() : worker_([this] { loop(); }) {}
+    ~ReportQueue() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+    ReportQueue(const ReportQueue&) = delete;
+    ReportQueue& operator=(const ReportQueue&) = delete;
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            jobs_.push_back(std::move(job));
+        }
+        cv_.notify_all();
+    }
+    // Blocks until every submitted job has finished
+    void wait() {
+        std::unique_lock<std::mutex> lk(m_);
+        idle_cv_.wait(lk, [&] { return jobs_.empty() && !busy_; });
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lk(m_);
+        for (;;) {
+            cv_.wait(lk, [&] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            std::function<void()> job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+            lk.unlock();
+            job();
+            lk.lock();
+            busy_ = false;
+            if (jobs_.empty()) idle_cv_.notify_all();
+        }
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::function<void()>> jobs_;
+    bool busy_ = false;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+}
@@ -1,23 +1,29 @@
 #pragma once
 #include <string>
-#include <fstream>
 #include <vector>
 #include "backtester.hpp"
+#include "report_writer.hpp"
 
 namespace hft {
 
-inline void write_equity_csv(const std::string& path, const std::vector<double>& equity) {
-    std::ofstream f(path);
-    f << "index,equity\n";
+inline bool write_equity_csv(const std::string& path, const std::vector<double>& equity) {
+    BufferedWriter f(path);
+    f.text("index,equity\n");
     for (size_t i = 0; i < equity.size(); ++i) {
-        f << i << "," << equity[i] << "\n";
+        f.integer((std::int64_t)i); f.put(','); f.real(equity[i]); f.put('\n');
     }
+    return f.close();
 }
 
-inline void write_summary_csv(const std::string& path, const std::string& name, const BacktestResult& r) {
-    std::ofstream f(path);
-    f << "strategy,sharpe,max_drawdown,final_equity,trade_count\n";
-    f << name << "," << r.sharpe << "," << r.drawdown << "," << r.final_equity << "," << r.trades.size() << "\n";
+inline bool write_summary_csv(const std::string& path, const std::string& name, const BacktestResult& r) {
+    BufferedWriter f(path);
+    f.text("strategy,sharpe,max_drawdown,final_equity,trade_count\n");
+    f.text(name); f.put(',');
+    f.real(r.sharpe); f.put(',');
+    f.real(r.drawdown); f.put(',');
+    f.real(r.final_equity); f.put(',');
+    f.integer((std::int64_t)r.trades.size()); f.put('\n');
+    return f.close();
 }
 
 }
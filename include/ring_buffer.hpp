@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace hft {
+
+// Fixed-capacity FIFO; storage is allocated once, pushing onto a full
+// buffer overwrites the oldest element. Index 0 is the oldest element.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t capacity = 0) : buf_(capacity) {}
+
+    void reset(std::size_t capacity) { buf_.assign(capacity, T{}); head_ = 0; size_ = 0; }
+    void clear() { head_ = 0; size_ = 0; }
+
+    std::size_t capacity() const { return buf_.size(); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == buf_.size(); }
+
+    // Appends x; returns true if an element was evicted to make room
+    bool push(const T& x) {
+        if (buf_.empty()) return false;
+        std::size_t tail = head_ + size_;
+        if (tail >= buf_.size()) tail -= buf_.size();
+        buf_[tail] = x;
+        if (size_ < buf_.size()) { ++size_; return false; }
+        if (++head_ == buf_.size()) head_ = 0;
+        return true;
+    }
+
+    void pop_front() { if (size_) { if (++head_ == buf_.size()) head_ = 0; --size_; } }
+    void pop_back() { if (size_) --size_; }
+
+    const T& front() const { return buf_[head_]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+    const T& operator[](std::size_t i) const {
+        std::size_t j = head_ + i;
+        return buf_[j >= buf_.size() ? j - buf_.size() : j];
+    }
+
+    // Contents oldest first through a StateWriter/StateReader; load fails
+    // if the saved contents do not fit this capacity
+    template <class W>
+    void save(W& w) const {
+        w.put((std::uint64_t)size_);
+        for (std::size_t i = 0; i < size_; ++i) w.put((*this)[i]);
+    }
+    template <class R>
+    bool load(R& r) {
+        std::uint64_t n;
+        if (!r.get(n) || n > buf_.size()) return false;
+        clear();
+        for (std::uint64_t i = 0; i < n; ++i) {
+            T x;
+            if (!r.get(x)) return false;
+            push(x);
+        }
+        return true;
+    }
+
+private:
+    std::vector<T> buf_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+};
+
+}
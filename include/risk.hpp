@@ -2,6 +2,7 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include "streaming_indicators.hpp"
 
 namespace hft {
 
@@ -15,7 +16,8 @@ struct RiskControl {
 
 // Compute rolling volatility (annualized)
 inline double compute_volatility(const std::vector<double>& prices, int lookback = 20) {
-    if ((int)prices.size() < lookback) return 0.01;
+    if ((int)prices.size() <= lookback) return 0.01; // need lookback returns
+
     std::vector<double> rets;
     for (size_t i = prices.size() - lookback; i < prices.size(); ++i) {
         double ret = (prices[i] - prices[i-1]) / prices[i-1];
@@ -26,6 +28,36 @@ inline double compute_volatility(const std::vector<double>& prices, int lookback
     return std::sqrt(var) * std::sqrt(252.0); // annualized
 }
 
+// Incremental counterpart of compute_volatility for per-bar use: returns
+// feed a RollingStdev (ring buffer + sliding Welford), so an update is O(1)
+// with no allocation. value() matches compute_volatility over the same
+// price history.
+class RollingVolatility {
+public:
+    explicit RollingVolatility(int lookback = 20) : rets_(lookback) {}
+
+    void update(double price) {
+        if (has_prev_) rets_.update((price - prev_) / prev_);
+        prev_ = price;
+        has_prev_ = true;
+    }
+
+    bool ready() const { return rets_.ready(); }
+    double value() const {
+        if (!ready()) return 0.01;
+        return rets_.value() * std::sqrt(252.0); // annualized
+    }
+
+    void reset() { rets_.reset(); has_prev_ = false; }
+    template <class W> void save(W& w) const { rets_.save(w); w.put(prev_); w.put(has_prev_); }
+    template <class R> bool load(R& r) { return rets_.load(r) && r.get(prev_) && r.get(has_prev_); }
+
+private:
+    RollingStdev rets_;
+    double prev_ = 0;
+    bool has_prev_ = false;
+};
+
 // Apply position sizing based on volatility
 inline int scale_position_by_vol(int base_qty, double vol) {
     if (vol < 0.01) vol = 0.01;
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace hft {
+namespace simd {
+
+// Vectorized batch kernels with runtime dispatch. The best instruction set
+// the CPU supports is picked on first use; HFT_SIMD=scalar|avx2|avx512 in
+// the environment (or set_isa) overrides it. Sums are formed in a different
+// order than a scalar loop, so results agree to rounding, except
+// max_drawdown which is exact.
+enum class Isa { Scalar, Avx2, Avx512 };
+
+const char* isa_name(Isa isa);
+bool isa_supported(Isa isa);
+Isa active_isa();
+// Returns false (and keeps the current choice) if isa is not supported
+bool set_isa(Isa isa);
+
+struct KernelTable {
+    // out[i] = (x[i+1] - x[i]) / x[i] for i < n-1
+    void (*simple_returns)(const double* x, std::size_t n, double* out);
+    // Rolling mean over w points (prefix-sum form); NaN for the first w-1
+    void (*sma)(const double* x, std::size_t n, int w, double* out);
+    // Rolling population variance over w points; NaN for the first w-1
+    void (*rolling_variance)(const double* x, std::size_t n, int w, double* out);
+    // Largest (peak - v) / peak over the running peak of eq
+    double (*max_drawdown)(const double* eq, std::size_t n);
+    // Population mean and variance (two-pass)
+    void (*mean_variance)(const double* x, std::size_t n, double* mean, double* var);
+    // sqrt(mean of (r - mean)^2 over r < 0); *count receives the number of r < 0
+    double (*downside_deviation)(const double* r, std::size_t n, double mean, std::size_t* count);
+};
+
+// Kernels of a specific instruction set (for tests and benchmarks)
+const KernelTable& kernels(Isa isa);
+// Kernels of the active instruction set
+const KernelTable& kernels();
+
+inline std::vector<double> simple_returns(const std::vector<double>& x) {
+    std::vector<double> out(x.size() > 1 ? x.size() - 1 : 0);
+    if (!out.empty()) kernels().simple_returns(x.data(), x.size(), out.data());
+    return out;
+}
+
+inline std::vector<double> sma(const std::vector<double>& x, int w) {
+    std::vector<double> out(x.size());
+    kernels().sma(x.data(), x.size(), w, out.data());
+    return out;
+}
+
+inline std::vector<double> rolling_variance(const std::vector<double>& x, int w) {
+    std::vector<double> out(x.size());
+    kernels().rolling_variance(x.data(), x.size(), w, out.data());
+    return out;
+}
+
+inline double max_drawdown(const std::vector<double>& eq) {
+    return kernels().max_drawdown(eq.data(), eq.size());
+}
+
+}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+constexpr std::size_t kCacheLine = 64;
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// The indices live on separate cache lines, each side keeps a cached copy
+// of the other's index and only re-reads it when the cache says full or
+// empty, and push/pop move whole batches with one release store, so a
+// hand-off costs one cache-line transfer per batch rather than per item.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        buf_.resize(cap);
+        mask_ = cap - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return buf_.size(); }
+
+    // Producer: copies up to n items, returns how many fit
+    std::size_t push(const T* items, std::size_t n) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t room = buf_.size() - (tail - head_cache_);
+        if (room < n) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            room = buf_.size() - (tail - head_cache_);
+        }
+        if (n > room) n = room;
+        for (std::size_t i = 0; i < n; ++i) buf_[(tail + i) & mask_] = items[i];
+        if (n) tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer: moves up to max items into out, returns the count
+    std::size_t pop(T* out, std::size_t max) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t avail = tail_cache_ - head;
+        if (avail < max) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            avail = tail_cache_ - head;
+        }
+        if (max > avail) max = avail;
+        for (std::size_t i = 0; i < max; ++i) out[i] = buf_[(head + i) & mask_];
+        if (max) head_.store(head + max, std::memory_order_release);
+        return max;
+    }
+
+    // Items queued; exact from either end's own thread, a snapshot otherwise
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    // Producer: no more pushes. Everything pushed before close() is
+    // visible to a consumer that has seen closed()
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};   // consumer writes
+    std::size_t tail_cache_ = 0;                             // consumer's copy of tail_
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};   // producer writes
+    std::size_t head_cache_ = 0;                             // producer's copy of head_
+    alignas(kCacheLine) std::atomic<bool> closed_{false};
+    std::vector<T> buf_;
+    std::size_t mask_ = 0;
+};
+
+// Wait policy for a stalled stage: a short spin with the CPU pause hint,
+// then yield so an oversubscribed machine still makes progress
+class Backoff {
+public:
+    void wait() {
+        if (spins_ < kSpins) {
+            ++spins_;
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+            _mm_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    void reset() { spins_ = 0; }
+
+private:
+    static constexpr int kSpins = 64;
+    int spins_ = 0;
+};
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace hft {
+
+// Flat byte encoding for strategy and engine state: fields are appended
+// in declaration order with their in-memory representation, so a snapshot
+// is only meant to be read back by the same build on the same platform.
+class StateWriter {
+public:
+    template <class T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() takes plain values");
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        bytes_.insert(bytes_.end(), p, p + sizeof(T));
+    }
+    void put_string(const std::string& s) {
+        put<std::uint64_t>(s.size());
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+    }
+    template <class T>
+    void put_vector(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put_vector() takes plain values");
+        put<std::uint64_t>(v.size());
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(v.data());
+        bytes_.insert(bytes_.end(), p, p + v.size() * sizeof(T));
+    }
+
+    const std::vector<unsigned char>& bytes() const { return bytes_; }
+    std::vector<unsigned char> take() { return std::move(bytes_); }
+
+private:
+    std::vector<unsigned char> bytes_;
+};
+
+// Reads what StateWriter wrote; every get returns false (and the reader
+// stays failed) once the input runs short
+class StateReader {
+public:
+    StateReader(const unsigned char* data, std::size_t n) : p_(data), n_(n) {}
+    explicit StateReader(const std::vector<unsigned char>& bytes) : p_(bytes.data()), n_(bytes.size()) {}
+
+    template <class T>
+    bool get(T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "get() takes plain values");
+        if (!ok_ || n_ - pos_ < sizeof(T)) return ok_ = false;
+        std::memcpy(&v, p_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool get_string(std::string& s) {
+        std::uint64_t n;
+        if (!get(n) || n_ - pos_ < n) return ok_ = false;
+        s.assign(reinterpret_cast<const char*>(p_ + pos_), (std::size_t)n);
+        pos_ += (std::size_t)n;
+        return true;
+    }
+    template <class T>
+    bool get_vector(std::vector<T>& v) {
+        std::uint64_t n;
+        if (!get(n) || (n_ - pos_) / sizeof(T) < n) return ok_ = false;
+        v.resize((std::size_t)n);
+        std::memcpy(v.data(), p_ + pos_, (std::size_t)n * sizeof(T));
+        pos_ += (std::size_t)n * sizeof(T);
+        return true;
+    }
+
+    bool ok() const { return ok_; }
+    // Everything consumed
+    bool done() const { return ok_ && pos_ == n_; }
+
+private:
+    const unsigned char* p_;
+    std::size_t n_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+}
@@ -1,19 +1,18 @@
 #pragma once
 #include "strategy.hpp"
-#include <deque>
+#include "streaming_indicators.hpp"
+#include <algorithm>
 
 namespace hft {
 
-class MeanReversionStrategy : public Strategy {
+class MeanReversionStrategy final : public Strategy {
 public:
     explicit MeanReversionStrategy(int lookback = 20, double threshold = 0.01, int qty = 1)
-        : lookback_(lookback), threshold_(threshold), qty_(qty) {}
+        : lookback_(lookback), threshold_(threshold), qty_(qty), sma_(lookback) {}
     std::string name() const override { return "MeanReversion"; }
     void on_bar(const Bar& bar, StrategyContext& ctx, std::vector<Trade>& trades) override {
-        prices_.push_back(bar.close);
-        if ((int)prices_.size() > lookback_) prices_.pop_front();
-        if ((int)prices_.size() < lookback_) return;
-        double sum = 0.0; for (double p : prices_) sum += p; double avg = sum / prices_.size();
+        double avg = sma_.update(bar.close);
+        if (!sma_.ready()) return;
         double dev = (bar.close - avg) / avg;
         if (dev > threshold_ && ctx.position > -qty_) {
             // overpriced -> short
@@ -33,11 +32,28 @@ public:
             }
         }
     }
+    std::unique_ptr<Strategy> clone() const override { return std::unique_ptr<Strategy>(new MeanReversionStrategy(*this)); }
+    void reset() override { sma_.reset(); }
+
+protected:
+    void save_state(StateWriter& w) const override {
+        w.put(lookback_);
+        w.put(threshold_);
+        w.put(qty_);
+        sma_.save(w);
+    }
+    bool load_state(StateReader& r) override {
+        int lookback, qty;
+        double threshold;
+        return r.get(lookback) && r.get(threshold) && r.get(qty) && lookback == lookback_ &&
+               threshold == threshold_ && qty == qty_ && sma_.load(r);
+    }
+
 private:
     int lookback_;
     double threshold_;
     int qty_;
-    std::deque<double> prices_;
+    Sma sma_;
 };
 
 }
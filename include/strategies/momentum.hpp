@@ -1,18 +1,18 @@
 #pragma once
 #include "strategy.hpp"
-#include <deque>
+#include "ring_buffer.hpp"
+#include <algorithm>
 
 namespace hft {
 
-class MomentumStrategy : public Strategy {
+class MomentumStrategy final : public Strategy {
 public:
     explicit MomentumStrategy(int lookback = 20, int qty = 1)
-        : lookback_(lookback), qty_(qty) {}
+        : lookback_(lookback), qty_(qty), prices_(lookback > 0 ? lookback : 1) {}
     std::string name() const override { return "Momentum"; }
     void on_bar(const Bar& bar, StrategyContext& ctx, std::vector<Trade>& trades) override {
-        prices_.push_back(bar.close);
-        if ((int)prices_.size() > lookback_) prices_.pop_front();
-        if ((int)prices_.size() < lookback_) return;
+        prices_.push(bar.close); // fixed window: the oldest close drops out
+        if (!prices_.full()) return;
         double ret = (prices_.back() - prices_.front()) / prices_.front();
         if (ret > 0.0 && ctx.position <= 0) {
             // go long
@@ -32,10 +32,24 @@ public:
             }
         }
     }
+    std::unique_ptr<Strategy> clone() const override { return std::unique_ptr<Strategy>(new MomentumStrategy(*this)); }
+    void reset() override { prices_.clear(); }
+
+protected:
+    void save_state(StateWriter& w) const override {
+        w.put(lookback_);
+        w.put(qty_);
+        prices_.save(w);
+    }
+    bool load_state(StateReader& r) override {
+        int lookback, qty;
+        return r.get(lookback) && r.get(qty) && lookback == lookback_ && qty == qty_ && prices_.load(r);
+    }
+
 private:
     int lookback_;
     int qty_;
-    std::deque<double> prices_;
+    RingBuffer<double> prices_;
 };
 
 }
@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <cstddef>
+#include <memory>
 #include "data_loader.hpp"
+#include "state_codec.hpp"
 
 namespace hft {
 
@@ -18,11 +21,58 @@ struct StrategyContext {
     int position = 0;
 };
 
+// Engines hand strategies a scratch order buffer with this capacity, so a
+// bar producing up to this many orders never allocates
+constexpr std::size_t kScratchTrades = 16;
+
+// Trade log sized from the bar count: the shipped strategies emit at most
+// one trade per bar, so recording never reallocates inside the bar loop.
+// trim_trades() returns the unused tail once the run is over.
+inline void reserve_trades(std::vector<Trade>& trades, std::size_t bars) {
+    trades.reserve(trades.size() + bars);
+}
+template <class T>
+inline void trim_trades(std::vector<T>& trades) {
+    if (trades.capacity() > 2 * trades.size() + kScratchTrades) trades.shrink_to_fit();
+}
+
+using StrategyState = std::vector<unsigned char>;
+
+// Strategies own their indicator state. clone() copies parameters and
+// state, so each engine or thread can run its own instance; reset()
+// returns to the just-constructed state. snapshot() captures the state as
+// bytes (with the parameters, which restore() checks) so a run can be
+// checkpointed and continued later with identical results.
 class Strategy {
 public:
     virtual ~Strategy() = default;
     virtual std::string name() const = 0;
     virtual void on_bar(const Bar& bar, StrategyContext& ctx, std::vector<Trade>& trades) = 0;
+    virtual std::unique_ptr<Strategy> clone() const = 0;
+    virtual void reset() = 0;
+
+    StrategyState snapshot() const {
+        StateWriter w;
+        w.put_string(name());
+        save_state(w);
+        return w.take();
+    }
+    // False, leaving the strategy unchanged, if the bytes come from another
+    // strategy type or different parameters or are damaged
+    bool restore(const StrategyState& state) {
+        StrategyState before = snapshot();
+        StateReader r(state);
+        std::string n;
+        if (r.get_string(n) && n == name() && load_state(r) && r.done()) return true;
+        StateReader undo(before);
+        undo.get_string(n);
+        load_state(undo);
+        return false;
+    }
+
+protected:
+    virtual void save_state(StateWriter& w) const = 0;
+    virtual bool load_state(StateReader& r) = 0;
 };
 
 }
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+#include "metrics.hpp"
+
+namespace hft {
+
+struct StreamOptions {
+    std::size_t chunk_bars = 4096;   // bars pulled from the source per call
+    std::string curve_path;          // optional downsampled equity curve (CSV)
+    std::size_t curve_every = 1000;  // keep one curve point every N bars
+};
+
+// Online aggregates only: memory use is independent of history length
+struct StreamResult {
+    std::size_t bars = 0;
+    std::size_t num_trades = 0;
+    double sharpe = 0;
+    double max_dd = 0;
+    double final_equity = 0;
+    std::size_t curve_points = 0;
+    MetricsAccumulator metrics;      // Sortino, Calmar, win rate, ...; mergeable
+};
+
+// Writes every N-th equity point (and the last one) as bar_idx,ts,equity
+class CurveWriter {
+public:
+    CurveWriter(const std::string& path, std::size_t every) : every_(every ? every : 1) {
+        if (!path.empty()) {
+            out_.open(path);
+            if (out_) out_ << "bar_idx,ts,equity\n";
+        }
+    }
+    void add(std::size_t idx, std::int64_t ts, double equity) {
+        if (!out_.is_open()) return;
+        if (idx % every_ == 0) { write(idx, ts, equity); pending_ = false; }
+        else { last_idx_ = idx; last_ts_ = ts; last_eq_ = equity; pending_ = true; }
+    }
+    // Flush the final point if it was not on the sampling grid
+    std::size_t finish() {
+        if (out_.is_open() && pending_) write(last_idx_, last_ts_, last_eq_);
+        pending_ = false;
+        return points_;
+    }
+private:
+    void write(std::size_t idx, std::int64_t ts, double equity) {
+        out_ << idx << "," << ts << "," << equity << "\n";
+        ++points_;
+    }
+
+    std::ofstream out_;
+    std::size_t every_;
+    std::size_t points_ = 0;
+    bool pending_ = false;
+    std::size_t last_idx_ = 0;
+    std::int64_t last_ts_ = 0;
+    double last_eq_ = 0;
+};
+
+}
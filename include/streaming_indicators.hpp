@@ -0,0 +1,237 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "data_loader.hpp"
+#include "ring_buffer.hpp"
+
+namespace hft {
+
+// Stateful indicators: update() is O(1), storage is a fixed-capacity ring
+// buffer sized at construction, and value() is NaN until the indicator is
+// warmed up. update(const Bar&) feeds the close (VWAP uses the whole bar).
+// save/load move the running state through a StateWriter/StateReader; the
+// window length is not saved, so load into an indicator built the same way.
+
+class Sma {
+public:
+    explicit Sma(int w) : w_(w), win_(w > 0 ? w : 0) {}
+    double update(double x) {
+        if (w_ <= 0) return value();
+        bool evict = win_.full();
+        double old = evict ? win_.front() : 0.0;
+        win_.push(x);
+        sum_ += x;
+        if (evict) sum_ -= old;
+        return value();
+    }
+    double update(const Bar& b) { return update(b.close); }
+    bool ready() const { return w_ > 0 && win_.full(); }
+    double value() const { return ready() ? sum_ / w_ : std::nan(""); }
+    void reset() { win_.clear(); sum_ = 0; }
+    template <class W> void save(W& w) const { win_.save(w); w.put(sum_); }
+    template <class R> bool load(R& r) { return win_.load(r) && r.get(sum_); }
+private:
+    int w_;
+    RingBuffer<double> win_;
+    double sum_ = 0;
+};
+
+class Ema {
+public:
+    explicit Ema(int w) : w_(w), alpha_(2.0 / (w + 1)) {}
+    double update(double x) {
+        if (w_ <= 0) return value();
+        if (n_ == 0) e_ = x; // seeded with the first observation
+        e_ = alpha_ * x + (1 - alpha_) * e_;
+        ++n_;
+        return value();
+    }
+    double update(const Bar& b) { return update(b.close); }
+    bool ready() const { return w_ > 0 && n_ >= (std::size_t)w_; }
+    double value() const { return ready() ? e_ : std::nan(""); }
+    void reset() { n_ = 0; e_ = 0; }
+    template <class W> void save(W& w) const { w.put(e_); w.put((std::uint64_t)n_); }
+    template <class R> bool load(R& r) {
+        std::uint64_t n;
+        if (!r.get(e_) || !r.get(n)) return false;
+        n_ = (std::size_t)n;
+        return true;
+    }
+private:
+    int w_;
+    double alpha_;
+    double e_ = 0;
+    std::size_t n_ = 0;
+};
+
+// Wilder RSI: averages seeded with the simple mean of the first w changes,
+// first value emitted on the change after that
+class Rsi {
+public:
+    explicit Rsi(int w) : w_(w) {}
+    double update(double x) {
+        if (w_ <= 0) return value();
+        if (n_++ == 0) { prev_ = x; return value(); }
+        double d = x - prev_;
+        prev_ = x;
+        std::size_t k = n_ - 1; // index of this change, 1-based
+        if (k <= (std::size_t)w_) {
+            if (d > 0) gain_ += d; else loss_ -= d;
+            if (k == (std::size_t)w_) { gain_ /= w_; loss_ /= w_; }
+            return value();
+        }
+        double g = d > 0 ? d : 0.0;
+        double l = d < 0 ? -d : 0.0;
+        gain_ = (gain_ * (w_ - 1) + g) / w_;
+        loss_ = (loss_ * (w_ - 1) + l) / w_;
+        double rs = (loss_ == 0.0) ? 100.0 : (gain_ / loss_);
+        value_ = 100.0 - (100.0 / (1.0 + rs));
+        return value_;
+    }
+    double update(const Bar& b) { return update(b.close); }
+    bool ready() const { return w_ > 0 && n_ > (std::size_t)w_ + 1; }
+    double value() const { return ready() ? value_ : std::nan(""); }
+    void reset() { n_ = 0; gain_ = loss_ = 0; value_ = 0; }
+    template <class W> void save(W& w) const {
+        w.put((std::uint64_t)n_); w.put(prev_); w.put(gain_); w.put(loss_); w.put(value_);
+    }
+    template <class R> bool load(R& r) {
+        std::uint64_t n;
+        if (!r.get(n) || !r.get(prev_) || !r.get(gain_) || !r.get(loss_) || !r.get(value_)) return false;
+        n_ = (std::size_t)n;
+        return true;
+    }
+private:
+    int w_;
+    std::size_t n_ = 0;
+    double prev_ = 0;
+    double gain_ = 0;
+    double loss_ = 0;
+    double value_ = 0;
+};
+
+// Rolling mean / population stdev over w observations (sliding Welford)
+class RollingStdev {
+public:
+    explicit RollingStdev(int w) : win_(w > 0 ? w : 1) {}
+    double update(double x) {
+        if (!win_.full()) {
+            win_.push(x);
+            double d = x - mean_;
+            mean_ += d / win_.size();
+            m2_ += d * (x - mean_);
+            return value();
+        }
+        double old = win_.front();
+        win_.push(x);
+        double n = (double)win_.size();
+        double old_mean = mean_;
+        mean_ += (x - old) / n;
+        m2_ = n > 1 ? m2_ + (x - old) * (x - mean_ + old - old_mean) : 0.0;
+        // Refresh from the window now and then so rounding cannot accumulate
+        if (++evictions_ % 4096 == 0) recompute();
+        return value();
+    }
+    double update(const Bar& b) { return update(b.close); }
+    bool ready() const { return win_.full(); }
+    double mean() const { return ready() ? mean_ : std::nan(""); }
+    double variance() const { return ready() ? (m2_ > 0 ? m2_ / win_.size() : 0.0) : std::nan(""); }
+    double value() const { return std::sqrt(variance()); }
+    // Standard score of x against the current window (0 for a flat window)
+    double zscore(double x) const {
+        double sd = value();
+        if (!ready()) return std::nan("");
+        return sd > 0 ? (x - mean_) / sd : 0.0;
+    }
+    void reset() { win_.clear(); mean_ = m2_ = 0; evictions_ = 0; }
+    template <class W> void save(W& w) const { win_.save(w); w.put(mean_); w.put(m2_); w.put((std::uint64_t)evictions_); }
+    template <class R> bool load(R& r) {
+        std::uint64_t e;
+        if (!win_.load(r) || !r.get(mean_) || !r.get(m2_) || !r.get(e)) return false;
+        evictions_ = (std::size_t)e;
+        return true;
+    }
+private:
+    void recompute() {
+        double m = 0;
+        for (std::size_t i = 0; i < win_.size(); ++i) m += win_[i];
+        m /= win_.size();
+        double v = 0;
+        for (std::size_t i = 0; i < win_.size(); ++i) { double d = win_[i] - m; v += d * d; }
+        mean_ = m; m2_ = v;
+    }
+    RingBuffer<double> win_;
+    double mean_ = 0;
+    double m2_ = 0;
+    std::size_t evictions_ = 0;
+};
+
+// Rolling min and max over w observations via monotonic deques (amortized O(1))
+class RollingMinMax {
+public:
+    explicit RollingMinMax(int w) : w_(w > 0 ? w : 1), mins_(w_), maxs_(w_) {}
+    void update(double x) {
+        std::size_t i = n_++;
+        // Expire the element leaving the window first, so at most w-1 remain
+        if (!mins_.empty() && mins_.front().i + w_ <= i) mins_.pop_front();
+        if (!maxs_.empty() && maxs_.front().i + w_ <= i) maxs_.pop_front();
+        while (!mins_.empty() && mins_.back().v >= x) mins_.pop_back();
+        mins_.push({i, x});
+        while (!maxs_.empty() && maxs_.back().v <= x) maxs_.pop_back();
+        maxs_.push({i, x});
+    }
+    void update(const Bar& b) { update(b.close); }
+    bool ready() const { return n_ >= w_; }
+    double min() const { return ready() ? mins_.front().v : std::nan(""); }
+    double max() const { return ready() ? maxs_.front().v : std::nan(""); }
+    void reset() { mins_.clear(); maxs_.clear(); n_ = 0; }
+    template <class W> void save(W& w) const { mins_.save(w); maxs_.save(w); w.put((std::uint64_t)n_); }
+    template <class R> bool load(R& r) {
+        std::uint64_t n;
+        if (!mins_.load(r) || !maxs_.load(r) || !r.get(n)) return false;
+        n_ = (std::size_t)n;
+        return true;
+    }
+private:
+    struct Item { std::size_t i; double v; };
+    std::size_t w_;
+    RingBuffer<Item> mins_;
+    RingBuffer<Item> maxs_;
+    std::size_t n_ = 0;
+};
+
+// Volume-weighted average of the typical price (h+l+c)/3. w = 0 accumulates
+// from the last reset (session VWAP), otherwise over the last w bars.
+class Vwap {
+public:
+    explicit Vwap(int w = 0) : w_(w > 0 ? w : 0), pv_(w_), vol_(w_) {}
+    double update(const Bar& b) {
+        double pv = (b.high + b.low + b.close) / 3.0 * b.volume;
+        if (w_ && pv_.full()) { spv_ -= pv_.front(); svol_ -= vol_.front(); }
+        if (w_) { pv_.push(pv); vol_.push(b.volume); }
+        spv_ += pv;
+        svol_ += b.volume;
+        ++n_;
+        return value();
+    }
+    bool ready() const { return n_ > 0 && (w_ == 0 || pv_.full()) && svol_ > 0; }
+    double value() const { return ready() ? spv_ / svol_ : std::nan(""); }
+    void reset() { pv_.clear(); vol_.clear(); spv_ = svol_ = 0; n_ = 0; }
+    template <class W> void save(W& w) const { pv_.save(w); vol_.save(w); w.put(spv_); w.put(svol_); w.put((std::uint64_t)n_); }
+    template <class R> bool load(R& r) {
+        std::uint64_t n;
+        if (!pv_.load(r) || !vol_.load(r) || !r.get(spv_) || !r.get(svol_) || !r.get(n)) return false;
+        n_ = (std::size_t)n;
+        return true;
+    }
+private:
+    std::size_t w_;
+    RingBuffer<double> pv_;
+    RingBuffer<double> vol_;
+    double spv_ = 0;
+    double svol_ = 0;
+    std::size_t n_ = 0;
+};
+
+}
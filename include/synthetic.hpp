@@ -3,13 +3,19 @@
 #include <random>
 #include <cstdint>
 #include "data_loader.hpp"
+#include "bar_columns.hpp"
 
 namespace hft {
 
-inline std::vector<Bar> generate_random_walk(int n, double start=100.0, double drift=0.0002, double vol=0.005, std::int64_t ts0=1731321600000, std::int64_t dt_ms=60000) {
-    std::mt19937_64 rng(42);
+// Appends n bars of a geometric random walk to out (vector or BarColumns).
+// The default seed reproduces the series every demo and test was built on;
+// many independent paths are better drawn from monte_carlo.hpp.
+template <class Out>
+inline void random_walk_into(Out& bars, int n, double start, double drift, double vol, std::int64_t ts0, std::int64_t dt_ms,
+                             std::uint64_t seed = 42) {
+    std::mt19937_64 rng(seed);
     std::normal_distribution<double> z(0.0, 1.0);
-    std::vector<Bar> bars; bars.reserve(n);
+    bars.reserve(bars.size() + (n > 0 ? n : 0));
     double price = start;
     for (int i=0;i<n;++i) {
         double ret = drift + vol * z(rng);
@@ -21,6 +27,18 @@ inline std::vector<Bar> generate_random_walk(int n, double start=100.0, double d
         bars.push_back({ts0 + (std::int64_t)i*dt_ms, open, high, low, close, volu});
         price = close;
     }
+}
+
+inline std::vector<Bar> generate_random_walk(int n, double start=100.0, double drift=0.0002, double vol=0.005, std::int64_t ts0=1731321600000, std::int64_t dt_ms=60000, std::uint64_t seed=42) {
+    std::vector<Bar> bars;
+    random_walk_into(bars, n, start, drift, vol, ts0, dt_ms, seed);
+    return bars;
+}
+
+// Same series as generate_random_walk, laid out as columns
+inline BarColumns generate_random_walk_columns(int n, double start=100.0, double drift=0.0002, double vol=0.005, std::int64_t ts0=1731321600000, std::int64_t dt_ms=60000, std::uint64_t seed=42) {
+    BarColumns bars;
+    random_walk_into(bars, n, start, drift, vol, ts0, dt_ms, seed);
     return bars;
 }
 
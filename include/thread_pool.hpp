@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hft {
+
+// Fixed-size pool for data-parallel loops. parallel_for hands out indices
+// through a shared atomic counter, so uneven work items balance themselves.
+// The calling thread participates as the last worker; parallel_for must not
+// be called from inside a job.
+class ThreadPool {
+public:
+    // threads = total workers including the caller (0 = hardware concurrency)
+    explicit ThreadPool(std::size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 0; i + 1 < threads; ++i) workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers_.size() + 1; }
+
+    // Calls fn(i, worker) for every i in [0, n); worker is in [0, size())
+    template <class Fn>
+    void parallel_for(std::size_t n, Fn&& fn) {
+        if (n == 0) return;
+        std::function<void(std::size_t, std::size_t)> job(std::forward<Fn>(fn));
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            job_ = &job;
+            n_ = n;
+            next_.store(0);
+            finished_ = 0;
+            ++generation_;
+        }
+        cv_.notify_all();
+        drain(job, n, workers_.size());
+        std::unique_lock<std::mutex> lk(m_);
+        done_cv_.wait(lk, [&] { return finished_ == workers_.size(); });
+        job_ = nullptr;
+    }
+
+private:
+    void drain(const std::function<void(std::size_t, std::size_t)>& job, std::size_t n, std::size_t id) {
+        for (std::size_t i; (i = next_.fetch_add(1)) < n;) job(i, id);
+    }
+
+    void worker_loop(std::size_t id) {
+        std::size_t seen = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            const auto* job = job_;
+            std::size_t n = n_;
+            lk.unlock();
+            drain(*job, n, id);
+            lk.lock();
+            if (++finished_ == workers_.size()) done_cv_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(std::size_t, std::size_t)>* job_ = nullptr;
+    std::size_t n_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t generation_ = 0;
+    std::size_t finished_ = 0;
+    bool stop_ = false;
+};
+
+}
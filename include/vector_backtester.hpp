@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "backtester.hpp"
+
+namespace hft {
+
+// Engine for strategies whose position is a pure function of the price
+// history. Instead of a virtual on_bar per bar, the caller supplies the
+// target position after every bar (built e.g. from sma/ema in
+// indicators.hpp with targets_from_signal) and the run is a handful of
+// whole-array passes: orders are the differences of the targets, costs and
+// notionals are elementwise, cash is a running sum and equity is
+// cash + position * close.
+//
+// Orders fill in full at the bar's close, as the bundled strategies book
+// them. For the positions Backtester::run would hold, trades, the equity
+// curve, drawdown and final equity are bit-identical; sharpe and the
+// return moments agree to rounding (MetricsAccumulator::from_equity).
+class VectorBacktester {
+public:
+    // Runs over the first min(bars.size(), target.size()) bars, flat before
+    // the first one
+    static BacktestResult run(const std::vector<Bar>& bars, const std::vector<int>& target, const CostModel& costs = {});
+    static BacktestResult run(const BarView& bars, const std::vector<int>& target, const CostModel& costs = {});
+};
+
+// Target positions from a signal, traded the way the bundled strategies
+// trade: a positive value steps the position up by qty, a negative one down
+// by qty, within [-qty, qty], so a reversal goes flat first. Zero and NaN
+// (an indicator still warming up) hold. A signal of close[i] -
+// close[i - lookback + 1] reproduces MomentumStrategy(lookback, qty); +1/-1
+// where the close is below/above sma(close, lookback) by more than the
+// threshold reproduces MeanReversionStrategy.
+std::vector<int> targets_from_signal(const std::vector<double>& signal, int qty = 1);
+
+}
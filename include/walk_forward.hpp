@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bar_view.hpp"
+#include "costs.hpp"
+#include "parameter_sweep.hpp"
+
+namespace hft {
+
+struct WalkForwardConfig {
+    std::size_t train_bars = 500;
+    std::size_t test_bars = 100;   // also the step between folds, so test windows tile
+    bool anchored = false;         // train windows all start at bar 0 (expanding)
+    SweepMetric metric = SweepMetric::Sharpe;
+    std::size_t threads = 0;       // 0 = hardware concurrency
+    CostModel costs{};
+};
+
+// Bar ranges are [from, to)
+struct WalkForwardFold {
+    std::size_t train_from = 0, train_to = 0;
+    std::size_t test_from = 0, test_to = 0;
+    std::size_t best_index = 0;    // grid combination chosen in-sample
+    std::vector<double> params;
+    double train_score = 0;
+    double test_return = 0;        // compounded over the test window
+    double test_sharpe = 0;
+    double test_max_dd = 0;
+    std::size_t test_trades = 0;
+};
+
+struct WalkForwardResult {
+    std::vector<WalkForwardFold> folds;
+    // Out-of-sample equity stitched from each fold's winner over its test
+    // window, starting from the strategies' initial cash
+    std::vector<std::int64_t> oos_ts;
+    std::vector<double> oos_equity;
+    double oos_sharpe = 0;          // per-bar, like StreamResult::sharpe
+    double oos_max_dd = 0;
+    double oos_return = 0;
+};
+
+// Rolling (or anchored) walk-forward optimization: each fold picks the
+// best grid combination on its train window and is scored on the test
+// window that follows.
+//
+// Every combination is backtested once over the whole series, not once per
+// fold: a single continuous run keeps the strategy warm at every window
+// start, and its per-bar returns (prefix-summed) give any train window's
+// score in O(1). Overlapping folds thus share both the warm-up and the
+// backtest. Combinations run in parallel; each worker keeps every fold's
+// best so far with its test-window returns, merged by (score, index) so
+// results do not depend on the thread count.
+class WalkForward {
+public:
+    static WalkForwardResult run(const BarView& bars, const ParamGrid& grid,
+                                 const StrategyFactory& factory, const WalkForwardConfig& cfg = {});
+};
+
+}
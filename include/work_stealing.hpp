@@ -0,0 +1,273 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pipeline.hpp"
+#include "spsc_ring.hpp"
+
+namespace hft {
+
+// Chase-Lev work-stealing deque (the C11 formulation of Le et al., 2013).
+// The owner thread pushes and pops at the bottom (LIFO); any thread may
+// steal from the top (FIFO). The array grows on demand; retired arrays are
+// kept until destruction because a thief may still be reading one.
+template <typename T>
+class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(std::size_t capacity = 64) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        arrays_.emplace_back(new Array(cap));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Owner only
+    void push(T x) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > (std::int64_t)a->cap - 1) a = grow(a, t, b);
+        a->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only; false when empty
+    bool pop(T& out) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t == b) {
+            // Last item: race any thief for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread; false when empty or when another thread won the item
+    bool steal(T& out) {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        Array* a = array_.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+        out = x;
+        return true;
+    }
+
+    // Snapshot; exact only when no other thread is active
+    std::size_t size() const {
+        std::int64_t d = bottom_.load(std::memory_order_acquire) - top_.load(std::memory_order_acquire);
+        return d > 0 ? (std::size_t)d : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(std::size_t c) : cap(c), buf(new std::atomic<T>[c]) {}
+        T get(std::int64_t i) const { return buf[(std::size_t)i & (cap - 1)].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T x) { buf[(std::size_t)i & (cap - 1)].store(x, std::memory_order_relaxed); }
+        std::size_t cap;
+        std::unique_ptr<std::atomic<T>[]> buf;
+    };
+
+    Array* grow(Array* a, std::int64_t t, std::int64_t b) {
+        arrays_.emplace_back(new Array(a->cap * 2));
+        Array* bigger = arrays_.back().get();
+        for (std::int64_t i = t; i < b; ++i) bigger->put(i, a->get(i));
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(kCacheLine) std::atomic<std::int64_t> top_{0};
+    alignas(kCacheLine) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays_;   // owner only
+};
+
+struct WorkerStats {
+    std::size_t jobs = 0;
+    std::size_t steals = 0;
+    double busy_seconds = 0;   // inside jobs
+};
+
+// Fixed-size pool that runs batches of jobs from per-worker Chase-Lev
+// deques. Each worker starts on its own queue, popping the last listed job
+// first; once it runs dry it steals the oldest job of a random victim
+// until the batch is done. Jobs only enter the deques when workers seed
+// them, so a worker that keeps finding nothing sleeps until another one
+// seeds its queue or the batch ends, instead of spinning through the
+// remaining long jobs. The calling thread is the last worker, as in
+// ThreadPool; run must not be called from inside a job.
+class WorkStealingPool {
+public:
+    // threads = total workers including the caller (0 = hardware concurrency);
+    // with pin, pool thread w is pinned to core w (the caller is left alone)
+    explicit WorkStealingPool(std::size_t threads = 0, bool pin = false) : pin_(pin) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 0; i < threads; ++i) deques_.emplace_back(new ChaseLevDeque<std::size_t>());
+        stats_.resize(threads);
+        for (std::size_t i = 0; i + 1 < threads; ++i) workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const { return deques_.size(); }
+
+    // Calls fn(job, worker) once for every job index listed in queues, where
+    // queues[w] seeds worker w (queues beyond size() are folded onto the
+    // last worker). Returns once every job has finished.
+    void run(const std::vector<std::vector<std::size_t>>& queues,
+             const std::function<void(std::size_t, std::size_t)>& fn) {
+        std::size_t total = 0;
+        for (const auto& q : queues) total += q.size();
+        if (total == 0) return;
+        for (auto& s : stats_) s = WorkerStats();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            queues_ = &queues;
+            job_ = &fn;
+            remaining_.store(total);
+            finished_ = 0;
+            seeded_ = 0;
+            ++generation_;
+        }
+        cv_.notify_all();
+        work(workers_.size());
+        std::unique_lock<std::mutex> lk(m_);
+        done_cv_.wait(lk, [&] { return finished_ == workers_.size(); });
+        job_ = nullptr;
+        queues_ = nullptr;
+    }
+
+    // Counters from the last run, per worker
+    const std::vector<WorkerStats>& stats() const { return stats_; }
+
+private:
+    void work(std::size_t id) {
+        ChaseLevDeque<std::size_t>& own = *deques_[id];
+        const auto& queues = *queues_;
+        if (id < queues.size())
+            for (std::size_t j : queues[id]) own.push(j);
+        if (id + 1 == size())
+            for (std::size_t q = size(); q < queues.size(); ++q)
+                for (std::size_t j : queues[q]) own.push(j);
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            ++seeded_;
+        }
+        idle_cv_.notify_all();
+
+        WorkerStats& st = stats_[id];
+        std::uint64_t rng = 0x9e3779b97f4a7c15ull * (id + 1);
+        Backoff backoff;
+        std::size_t misses = 0;
+        while (remaining_.load(std::memory_order_acquire) > 0) {
+            std::size_t j;
+            bool got = own.pop(j);
+            if (!got && size() > 1) {
+                // xorshift victim order, skipping ourselves
+                rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                std::size_t start = (std::size_t)(rng % size());
+                for (std::size_t k = 0; k < size() && !got; ++k) {
+                    std::size_t v = (start + k) % size();
+                    if (v != id && deques_[v]->steal(j)) { got = true; ++st.steals; }
+                }
+            }
+            if (!got) {
+                if (++misses < kIdleRounds) backoff.wait();
+                else { park(); misses = 0; backoff.reset(); }
+                continue;
+            }
+            misses = 0;
+            backoff.reset();
+            auto t0 = std::chrono::steady_clock::now();
+            (*job_)(j, id);
+            st.busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            ++st.jobs;
+            if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // Taking the lock orders this with a parking worker's check
+                { std::lock_guard<std::mutex> lk(m_); }
+                idle_cv_.notify_all();
+            }
+        }
+    }
+
+    // Sleeps until the batch ends or another worker seeds its queue. With
+    // every queue seeded and empty no job can appear any more; a queue that
+    // still holds jobs (a steal lost a race) sends the caller back to work.
+    void park() {
+        std::unique_lock<std::mutex> lk(m_);
+        if (seeded_ == size()) {
+            for (const auto& d : deques_)
+                if (d->size()) return;
+        }
+        std::size_t seen = seeded_;
+        idle_cv_.wait(lk, [&] { return remaining_.load(std::memory_order_acquire) == 0 || seeded_ != seen; });
+    }
+
+    void worker_loop(std::size_t id) {
+        if (pin_) pin_current_thread((int)id);
+        std::size_t seen = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            lk.unlock();
+            work(id);
+            lk.lock();
+            if (++finished_ == workers_.size()) done_cv_.notify_all();
+        }
+    }
+
+    static constexpr std::size_t kIdleRounds = 256; // failed steal rounds before parking
+
+    bool pin_;
+    std::vector<std::unique_ptr<ChaseLevDeque<std::size_t>>> deques_;
+    std::vector<WorkerStats> stats_;
+    std::vector<std::thread> workers_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::condition_variable idle_cv_;   // parked workers, under m_
+    const std::vector<std::vector<std::size_t>>* queues_ = nullptr;
+    const std::function<void(std::size_t, std::size_t)>* job_ = nullptr;
+    std::atomic<std::size_t> remaining_{0};
+    std::size_t generation_ = 0;
+    std::size_t finished_ = 0;
+    std::size_t seeded_ = 0;   // workers that have pushed their jobs this run
+    bool stop_ = false;
+};
+
+}
@@ -1,98 +1,381 @@
 #include "advanced_backtester.hpp"
-#include "performance.hpp"
+#include "mapped_file.hpp"
+#include "profiler.hpp"
+#include "report_writer.hpp"
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstdint>
+#include <utility>
 
 namespace hft {
 
+namespace {
+
+constexpr int kVolLookback = 20;
+
+// Per-bar step shared by the in-memory and streaming runs
+class AdvancedEngine {
+public:
+    AdvancedEngine(Strategy& strat, const CostModel& costs, const RiskControl& risk, FillModel& fills)
+        : strat_(strat), costs_(costs), risk_(risk), fills_(fills), vol_(kVolLookback) {
+        ctx_.cash = 100000.0;
+        scratch_.reserve(kScratchTrades);
+    }
+
+    // Processes one bar; accepted trades are appended to keep when given
+    void step(const Bar& b, std::vector<Trade>* keep, double& mtm_equity, double& unrealized_pnl) {
+        // Compute volatility for position scaling (O(1) rolling update)
+        {
+            HFT_PROFILE_SCOPE(Risk);
+            vol_.update(b.close);
+            double vol = vol_.value();
+            (void)vol; // not yet consumed by the sizing logic
+        }
+
+        // Execute strategy
+        {
+            HFT_PROFILE_SCOPE(Strategy);
+            scratch_.clear();
+            strat_.on_bar(b, ctx_, scratch_);
+        }
+
+        // on_bar has booked every order into ctx_ at its own price; each is
+        // reconciled with what the risk check and the fill model let through
+        int pending = 0;
+        for (const auto& t : scratch_) pending += t.quantity;
+        for (auto& t : scratch_) {
+            pending -= t.quantity;
+            FillResult f;
+            // Check risk controls: position limits (ctx_.position - pending
+            // is the position with this order, without the later ones)
+            if (std::abs(ctx_.position - pending) <= risk_.max_position) {
+                // Fill through the fill model (may be partial or nothing)
+                HFT_PROFILE_SCOPE(Fill);
+                f = fills_.fill(b, t.quantity);
+            }
+            ctx_.cash += t.quantity * t.entry_price - f.filled * f.price;
+            ctx_.position += f.filled - t.quantity;
+            t.quantity = f.filled;
+            t.entry_price = f.price; // record actual fill
+            if (f.filled == 0) continue;
+
+            // Apply transaction costs
+            double cost;
+            {
+                HFT_PROFILE_SCOPE(Cost);
+                cost = costs_.cost(t.entry_price, t.quantity);
+            }
+            ctx_.cash -= cost;
+            if (keep) keep->push_back(t);
+            ++num_trades_;
+        }
+
+        // Mark-to-market and apply stop-loss / take-profit
+        HFT_PROFILE_SCOPE(MarkToMarket);
+        mtm_equity = ctx_.cash + ctx_.position * b.close;
+        unrealized_pnl = ctx_.position * (b.close - (has_prev_ ? prev_close_ : b.close));
+        daily_pnl_ += unrealized_pnl;
+        prev_close_ = b.close;
+        has_prev_ = true;
+
+        // Check daily loss limit
+        if (daily_pnl_ < -risk_.max_daily_loss) {
+            ctx_.position = 0; // liquidate on max daily loss
+            ctx_.cash = mtm_equity;
+            daily_pnl_ = 0;
+        }
+    }
+
+    double cash() const { return ctx_.cash; }
+    std::size_t num_trades() const { return num_trades_; }
+
+    // Everything step() carries from bar to bar, strategy included
+    void save(StateWriter& w) const {
+        w.put(ctx_);
+        vol_.save(w);
+        w.put(prev_close_);
+        w.put(has_prev_);
+        w.put(daily_pnl_);
+        w.put((std::uint64_t)num_trades_);
+        w.put_vector(strat_.snapshot());
+    }
+    bool load(StateReader& r) {
+        std::uint64_t trades;
+        StrategyState strat;
+        if (!(r.get(ctx_) && vol_.load(r) && r.get(prev_close_) && r.get(has_prev_) && r.get(daily_pnl_) &&
+              r.get(trades) && r.get_vector(strat)))
+            return false;
+        num_trades_ = (std::size_t)trades;
+        return strat_.restore(strat);
+    }
+
+private:
+    Strategy& strat_;
+    const CostModel& costs_;
+    const RiskControl& risk_;
+    FillModel& fills_;
+    StrategyContext ctx_{};
+    RollingVolatility vol_;
+    double prev_close_ = 0;
+    bool has_prev_ = false;
+    std::vector<Trade> scratch_;
+    double daily_pnl_ = 0;
+    std::size_t num_trades_ = 0;
+};
+
+// Totals shared by run(), run_pipelined() and resume() once every bar is
+// collected; res.metrics and the engine's trade count span the whole history
+void finish_backtest(AssetBacktest& res, const AdvancedEngine& eng) {
+    trim_trades(res.trades);
+    res.num_trades = eng.num_trades();
+    if (!res.equity_curve.empty()) res.final_equity = res.equity_curve.back();
+    else res.final_equity = res.metrics.bars() ? res.metrics.final_equity() : eng.cash();
+    res.sharpe = res.metrics.sharpe(252.0);
+    res.max_dd = res.metrics.max_drawdown();
+}
+
+constexpr std::uint32_t kCheckpointMagic = 0x4b544648;   // "HFTK"
+constexpr std::uint32_t kCheckpointVersion = 2;
+
+void save_checkpoint(AdvancedCheckpoint& cp, const AdvancedEngine& eng, const MetricsAccumulator& metrics,
+                     std::int64_t last_ts) {
+    StateWriter w;
+    w.put(kCheckpointMagic);
+    w.put(kCheckpointVersion);
+    w.put(last_ts);
+    metrics.save(w);
+    eng.save(w);
+    cp.bytes = w.take();
+}
+
+bool load_checkpoint(const AdvancedCheckpoint& cp, AdvancedEngine& eng, MetricsAccumulator& metrics,
+                     std::int64_t& last_ts) {
+    StateReader r(cp.bytes);
+    std::uint32_t magic, version;
+    return r.get(magic) && magic == kCheckpointMagic && r.get(version) && version == kCheckpointVersion &&
+           r.get(last_ts) && metrics.load(r) && eng.load(r) && r.done();
+}
+
+}
+
 AssetBacktest AdvancedBacktester::run(const std::string& asset_name,
                                       const std::vector<Bar>& bars,
                                       Strategy& strat,
                                       const CostModel& costs,
                                       const RiskControl& risk,
-                                      const OrderBook& lob) {
+                                      const OrderBook& lob,
+                                      AdvancedCheckpoint* checkpoint) {
+    return run(asset_name, BarView::of(bars), strat, costs, risk, lob, checkpoint);
+}
+
+AssetBacktest AdvancedBacktester::run(const std::string& asset_name,
+                                      const BarView& bars,
+                                      Strategy& strat,
+                                      const CostModel& costs,
+                                      const RiskControl& risk,
+                                      const OrderBook& lob,
+                                      AdvancedCheckpoint* checkpoint) {
+    FormulaFillModel fills(lob);
+    return run(asset_name, bars, strat, costs, risk, fills, checkpoint);
+}
+
+AssetBacktest AdvancedBacktester::run(const std::string& asset_name,
+                                      const BarView& bars,
+                                      Strategy& strat,
+                                      const CostModel& costs,
+                                      const RiskControl& risk,
+                                      FillModel& fills,
+                                      AdvancedCheckpoint* checkpoint) {
     AssetBacktest res;
     res.asset = asset_name;
     
-    StrategyContext ctx{};
-    ctx.cash = 100000.0;
-    
-    std::vector<double> prices;
+    HFT_PROFILE_SCOPE(Run);
+    AdvancedEngine eng(strat, costs, risk, fills);
+    // No heap allocations inside the loop (see test_hot_loop_allocations)
     res.equity_curve.reserve(bars.size());
     res.pnl_series.reserve(bars.size());
-    
-    double daily_pnl = 0;
-    
+    reserve_trades(res.trades, bars.size());
+
     for (size_t i = 0; i < bars.size(); ++i) {
-        const auto& b = bars[i];
-        prices.push_back(b.close);
-        
-        // Compute volatility for position scaling
-        double vol = compute_volatility(prices, 20);
-        
-        // Execute strategy
-        std::vector<Trade> new_trades;
-        strat.on_bar(b, ctx, new_trades);
-        
-        for (auto& t : new_trades) {
-            // Check risk controls: position limits
-            if (std::abs(ctx.position + t.quantity) > risk.max_position) {
-                continue; // skip trade if violates max position
-            }
-            
-            // Fill at LOB price with impact
-            bool is_buy = t.quantity > 0;
-            double fill_price = lob.get_fill_price(b.close, t.quantity, is_buy);
-            
-            // Apply transaction costs
-            double cost = costs.cost(fill_price, t.quantity);
-            ctx.cash -= t.quantity * fill_price + cost;
-            ctx.position += t.quantity;
-            
-            t.entry_price = fill_price; // record actual fill
-            res.trades.push_back(t);
-        }
-        
-        // Mark-to-market and apply stop-loss / take-profit
-        double mtm_equity = ctx.cash + ctx.position * b.close;
-        double unrealized_pnl = ctx.position * (b.close - (prices.size() > 1 ? prices[prices.size()-2] : b.close));
-        daily_pnl += unrealized_pnl;
-        
-        // Check daily loss limit
-        if (daily_pnl < -risk.max_daily_loss) {
-            ctx.position = 0; // liquidate on max daily loss
-            ctx.cash = mtm_equity;
-            daily_pnl = 0;
-        }
-        
+        const Bar b = bars[i];
+        double mtm_equity, unrealized_pnl;
+        eng.step(b, &res.trades, mtm_equity, unrealized_pnl);
         res.equity_curve.push_back(mtm_equity);
         res.pnl_series.push_back(unrealized_pnl);
+        res.metrics.add(mtm_equity);
     }
     
-    res.num_trades = res.trades.size();
-    res.final_equity = res.equity_curve.empty() ? ctx.cash : res.equity_curve.back();
-    
-    if (!res.equity_curve.empty()) {
-        std::vector<double> returns;
-        for (size_t i = 1; i < res.equity_curve.size(); ++i) {
-            double ret = (res.equity_curve[i] - res.equity_curve[i-1]) / res.equity_curve[i-1];
-            returns.push_back(ret);
-        }
-        if (!returns.empty()) {
-            double mean = 0; for (double r : returns) mean += r; mean /= returns.size();
-            double var = 0; for (double r : returns) { double d = r - mean; var += d*d; } var /= returns.size();
-            double sd = std::sqrt(var);
-            res.sharpe = (sd > 0) ? (mean / sd * std::sqrt(252.0)) : 0.0;
-        }
-        
-        double peak = res.equity_curve[0];
-        for (double v : res.equity_curve) {
-            if (v > peak) peak = v;
-            double dd = (peak - v) / peak;
-            if (dd > res.max_dd) res.max_dd = dd;
+    finish_backtest(res, eng);
+    if (checkpoint) save_checkpoint(*checkpoint, eng, res.metrics, bars.empty() ? INT64_MIN : bars.ts(bars.size() - 1));
+    return res;
+}
+
+bool AdvancedBacktester::resume(const std::string& asset_name,
+                                const BarView& new_bars,
+                                Strategy& strat,
+                                const CostModel& costs,
+                                const RiskControl& risk,
+                                const OrderBook& lob,
+                                AdvancedCheckpoint& checkpoint,
+                                AssetBacktest& out) {
+    FormulaFillModel fills(lob);
+    return resume(asset_name, new_bars, strat, costs, risk, fills, checkpoint, out);
+}
+
+bool AdvancedBacktester::resume(const std::string& asset_name,
+                                const BarView& new_bars,
+                                Strategy& strat,
+                                const CostModel& costs,
+                                const RiskControl& risk,
+                                FillModel& fills,
+                                AdvancedCheckpoint& checkpoint,
+                                AssetBacktest& out) {
+    HFT_PROFILE_SCOPE(Run);
+    AssetBacktest res;
+    res.asset = asset_name;
+    AdvancedEngine eng(strat, costs, risk, fills);
+    StrategyState before = strat.snapshot();
+    std::int64_t last_ts;
+    if (!load_checkpoint(checkpoint, eng, res.metrics, last_ts) ||
+        (!new_bars.empty() && new_bars.ts(0) <= last_ts)) {
+        strat.restore(before);
+        return false;
+    }
+
+    res.equity_curve.reserve(new_bars.size());
+    res.pnl_series.reserve(new_bars.size());
+    reserve_trades(res.trades, new_bars.size());
+    for (std::size_t i = 0; i < new_bars.size(); ++i) {
+        const Bar b = new_bars[i];
+        double mtm_equity, unrealized_pnl;
+        eng.step(b, &res.trades, mtm_equity, unrealized_pnl);
+        res.equity_curve.push_back(mtm_equity);
+        res.pnl_series.push_back(unrealized_pnl);
+        res.metrics.add(mtm_equity);
+    }
+
+    finish_backtest(res, eng);
+    if (!new_bars.empty()) last_ts = new_bars.ts(new_bars.size() - 1);
+    save_checkpoint(checkpoint, eng, res.metrics, last_ts);
+    out = std::move(res);
+    return true;
+}
+
+bool AdvancedCheckpoint::write(const std::string& path) const {
+    BufferedWriter w(path, 64 << 10);
+    if (!w.is_open()) return false;
+    w.write(bytes.data(), bytes.size());
+    return w.close();
+}
+
+bool AdvancedCheckpoint::read(const std::string& path) {
+    MappedFile f;
+    if (!f.open(path)) return false;
+    bytes.assign(f.data(), f.data() + f.size());
+    return true;
+}
+
+AssetBacktest AdvancedBacktester::run_pipelined(const std::string& asset_name,
+                                                BarSource& src,
+                                                Strategy& strat,
+                                                const CostModel& costs,
+                                                const RiskControl& risk,
+                                                const OrderBook& lob,
+                                                const PipelineOptions& opt,
+                                                std::vector<StageStats>* stats) {
+    FormulaFillModel fills(lob);
+    return run_pipelined(asset_name, src, strat, costs, risk, fills, opt, stats);
+}
+
+AssetBacktest AdvancedBacktester::run_pipelined(const std::string& asset_name,
+                                                BarSource& src,
+                                                Strategy& strat,
+                                                const CostModel& costs,
+                                                const RiskControl& risk,
+                                                FillModel& fills,
+                                                const PipelineOptions& opt,
+                                                std::vector<StageStats>* stats) {
+    HFT_PROFILE_SCOPE(Run);
+    AssetBacktest res;
+    res.asset = asset_name;
+    AdvancedEngine eng(strat, costs, risk, fills);
+
+    // Strategy, risk and fills stay one stage: each bar's fills set the
+    // position the next bar's strategy and limit check read. Trades are
+    // owned by the engine thread, the series and curve file by the sink,
+    // until the join.
+    struct Step {
+        std::int64_t ts;
+        double equity;
+        double pnl;
+    };
+    CurveWriter curve(opt.curve_path, opt.curve_every);
+    std::size_t idx = 0;
+    auto st = run_pipeline<Step>(
+        src,
+        [&](const Bar& b) {
+            Step s;
+            s.ts = b.ts;
+            eng.step(b, &res.trades, s.equity, s.pnl);
+            return s;
+        },
+        [&](const Step* s, std::size_t n) {
+            for (std::size_t k = 0; k < n; ++k) {
+                res.equity_curve.push_back(s[k].equity);
+                res.pnl_series.push_back(s[k].pnl);
+                res.metrics.add(s[k].equity);
+                curve.add(idx++, s[k].ts, s[k].equity);
+            }
+        },
+        opt);
+    curve.finish();
+
+    finish_backtest(res, eng);
+    if (stats) *stats = std::move(st);
+    return res;
+}
+
+StreamResult AdvancedBacktester::run_stream(const std::string& asset_name,
+                                            BarSource& src,
+                                            Strategy& strat,
+                                            const CostModel& costs,
+                                            const RiskControl& risk,
+                                            const OrderBook& lob,
+                                            const StreamOptions& opt) {
+    FormulaFillModel fills(lob);
+    return run_stream(asset_name, src, strat, costs, risk, fills, opt);
+}
+
+StreamResult AdvancedBacktester::run_stream(const std::string& /*asset_name*/,
+                                            BarSource& src,
+                                            Strategy& strat,
+                                            const CostModel& costs,
+                                            const RiskControl& risk,
+                                            FillModel& fills,
+                                            const StreamOptions& opt) {
+    HFT_PROFILE_SCOPE(Run);
+    StreamResult res;
+    AdvancedEngine eng(strat, costs, risk, fills);
+    CurveWriter curve(opt.curve_path, opt.curve_every);
+    std::vector<Bar> chunk(std::max<std::size_t>(1, opt.chunk_bars));
+
+    for (std::size_t got; (got = src.next(chunk.data(), chunk.size())) > 0;) {
+        for (std::size_t k = 0; k < got; ++k) {
+            const Bar& b = chunk[k];
+            double equity, pnl;
+            eng.step(b, nullptr, equity, pnl);
+            res.metrics.add(equity);
+            curve.add(res.bars, b.ts, equity);
+            ++res.bars;
         }
     }
-    
+
+    res.sharpe = res.metrics.sharpe(252.0);
+    res.max_dd = res.metrics.max_drawdown();
+    res.num_trades = eng.num_trades();
+    res.final_equity = res.bars ? res.metrics.final_equity() : eng.cash();
+    res.curve_points = curve.finish();
     return res;
 }
 
@@ -1,38 +1,21 @@
 #include "backtester.hpp"
-#include <algorithm>
+#include "backtester_t.hpp"
 
 namespace hft {
 
+// The polymorphic engine is the template over the Strategy interface
+using VirtualBacktester = BacktesterT<Strategy, CostModel, StrategyPriceFill>;
+
 BacktestResult Backtester::run(const std::vector<Bar>& bars, Strategy& strat, const CostModel& costs, int lot) {
-    BacktestResult res{};
-    StrategyContext ctx{};
-    double equity = ctx.cash;
-    std::vector<double> returns;
-    res.equity_curve.reserve(bars.size());
+    return run(BarView::of(bars), strat, costs, lot);
+}
 
-    for (size_t i = 0; i < bars.size(); ++i) {
-        const auto& b = bars[i];
-        std::vector<Trade> new_trades;
-        strat.on_bar(b, ctx, new_trades);
-        for (auto& t : new_trades) {
-            // apply transaction costs at trade time
-            double c = costs.cost(t.entry_price, t.quantity);
-            ctx.cash -= c;
-            res.trades.push_back(t);
-        }
-        // Mark-to-market equity update
-        equity = ctx.cash + ctx.position * b.close;
-        res.equity_curve.push_back(equity);
-        if (i > 0) {
-            double ret = (res.equity_curve[i] - res.equity_curve[i-1]) / res.equity_curve[i-1];
-            returns.push_back(ret);
-        }
-    }
+BacktestResult Backtester::run(const BarView& bars, Strategy& strat, const CostModel& costs, int /*lot*/) {
+    return VirtualBacktester::run(bars, strat, costs);
+}
 
-    res.sharpe = sharpe_ratio(returns);
-    res.drawdown = max_drawdown(res.equity_curve);
-    res.final_equity = res.equity_curve.empty() ? ctx.cash : res.equity_curve.back();
-    return res;
+StreamResult Backtester::run_stream(BarSource& src, Strategy& strat, const CostModel& costs, const StreamOptions& opt) {
+    return VirtualBacktester::run_stream(src, strat, costs, opt);
 }
 
 }
@@ -0,0 +1,53 @@
+#include "bar_source.hpp"
+#include "csv_parse.hpp"
+#include <cstring>
+
+namespace hft {
+
+CsvBarSource::CsvBarSource(const std::string& path, std::size_t block_bytes)
+    : block_(block_bytes ? block_bytes : 1) {
+    f_ = std::fopen(path.c_str(), "rb");
+    if (f_) buf_.resize(block_);
+}
+
+CsvBarSource::~CsvBarSource() {
+    if (f_) std::fclose(f_);
+}
+
+// Move the unparsed tail to the front and read another block behind it.
+// The buffer only grows if a single line is longer than a block.
+bool CsvBarSource::refill() {
+    if (eof_ || !f_) return false;
+    std::size_t tail = end_ - begin_;
+    if (begin_ > 0) std::memmove(buf_.data(), buf_.data() + begin_, tail);
+    begin_ = 0; end_ = tail;
+    if (buf_.size() - end_ < block_ / 2 + 1) buf_.resize(end_ + block_);
+    std::size_t got = std::fread(buf_.data() + end_, 1, buf_.size() - end_, f_);
+    end_ += got;
+    if (got == 0) eof_ = true;
+    return got > 0;
+}
+
+std::size_t CsvBarSource::next(Bar* out, std::size_t max) {
+    std::size_t m = 0;
+    while (m < max) {
+        const char* p = buf_.data() + begin_;
+        const char* e = buf_.data() + end_;
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', e - p));
+        if (!nl) {
+            if (refill()) continue;
+            if (begin_ == end_) break;
+            nl = e; // last line without a trailing newline
+        }
+        if (first_line_) {
+            first_line_ = false;
+            if (csv::is_header(p, nl)) { begin_ = (std::size_t)(nl - buf_.data()) + (nl < e ? 1 : 0); continue; }
+        }
+        if (csv::parse_bar(p, nl, out[m])) ++m;
+        else if (!csv::is_blank(p, nl)) ++malformed_;
+        begin_ = (std::size_t)(nl - buf_.data()) + (nl < e ? 1 : 0);
+    }
+    return m;
+}
+
+}
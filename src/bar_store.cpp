@@ -0,0 +1,199 @@
+#include "bar_store.hpp"
+#include "data_loader.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace hft {
+
+using namespace barstore;
+
+// ---------------------------------------------------------------- writer
+
+BarStoreWriter::~BarStoreWriter() {
+    if (f_) std::fclose(f_);
+}
+
+bool BarStoreWriter::open(const std::string& path) {
+    if (f_) std::fclose(f_);
+    f_ = std::fopen(path.c_str(), "wb");
+    pos_ = 0; rows_ = 0;
+    symbols_.clear(); index_.clear();
+    if (!f_) return false;
+    FileHeader placeholder{};
+    return write_at(0, &placeholder, sizeof(placeholder));
+}
+
+bool BarStoreWriter::write_at(std::uint64_t off, const void* p, std::size_t n) {
+    if (off != pos_) return false; // append-only apart from the final header patch
+    if (n && std::fwrite(p, 1, n, f_) != n) return false;
+    pos_ += n;
+    return true;
+}
+
+bool BarStoreWriter::pad_to_alignment() {
+    static const char zeros[64] = {};
+    std::size_t pad = (std::size_t)((64 - pos_ % 64) % 64);
+    return write_at(pos_, zeros, pad);
+}
+
+bool BarStoreWriter::add_symbol(const std::string& symbol, const BarView& bars) {
+    if (!f_ || symbol.empty() || symbol.size() >= kNameLen) return false;
+    for (const auto& s : symbols_) if (symbol == s.name) return false;
+    for (std::size_t i = 1; i < bars.size(); ++i) if (bars.ts(i) < bars.ts(i - 1)) return false;
+
+    SymbolEntry e{};
+    std::memcpy(e.name, symbol.data(), symbol.size());
+    e.row_count = bars.size();
+    e.index_begin = index_.size();
+
+    // Per-day index
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        std::int64_t d = day_of(bars.ts(i));
+        if (index_.size() == e.index_begin || index_.back().day != d) index_.push_back({d, i, 0});
+        ++index_.back().row_count;
+    }
+    e.index_count = index_.size() - e.index_begin;
+
+    // Columns, buffered so row-major input is transposed in chunks
+    double buf[4096];
+    for (std::size_t c = 0; c < kColumns; ++c) {
+        if (!pad_to_alignment()) return false;
+        e.column_offset[c] = pos_;
+        for (std::size_t i = 0; i < bars.size(); i += 4096) {
+            std::size_t m = std::min<std::size_t>(4096, bars.size() - i);
+            for (std::size_t k = 0; k < m; ++k) {
+                std::size_t r = i + k;
+                switch (c) {
+                    case 0: { std::int64_t t = bars.ts(r); std::memcpy(&buf[k], &t, sizeof(t)); break; }
+                    case 1: buf[k] = bars.open(r); break;
+                    case 2: buf[k] = bars.high(r); break;
+                    case 3: buf[k] = bars.low(r); break;
+                    case 4: buf[k] = bars.close(r); break;
+                    default: buf[k] = bars.volume(r); break;
+                }
+            }
+            if (!write_at(pos_, buf, m * sizeof(double))) return false;
+        }
+    }
+    rows_ += bars.size();
+    symbols_.push_back(e);
+    return true;
+}
+
+bool BarStoreWriter::close() {
+    if (!f_) return false;
+    bool ok = pad_to_alignment();
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.endian_tag = kEndianTag;
+    h.num_symbols = symbols_.size();
+    h.num_index = index_.size();
+    h.num_rows = rows_;
+    h.symbols_offset = pos_;
+    ok = ok && write_at(pos_, symbols_.data(), symbols_.size() * sizeof(SymbolEntry));
+    h.index_offset = pos_;
+    ok = ok && write_at(pos_, index_.data(), index_.size() * sizeof(IndexEntry));
+    ok = ok && std::fseek(f_, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, f_) == 1;
+    ok = (std::fclose(f_) == 0) && ok;
+    f_ = nullptr;
+    return ok;
+}
+
+// ---------------------------------------------------------------- reader
+
+bool BarStore::open(const std::string& path) {
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(FileHeader)) { close(); return false; }
+    FileHeader h;
+    std::memcpy(&h, file_.data(), sizeof(h));
+    std::uint64_t size = file_.size();
+    bool ok = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion &&
+              h.endian_tag == kEndianTag &&
+              h.symbols_offset % 8 == 0 && h.index_offset % 8 == 0 &&
+              h.symbols_offset <= size && h.num_symbols <= (size - h.symbols_offset) / sizeof(SymbolEntry) &&
+              h.index_offset <= size && h.num_index <= (size - h.index_offset) / sizeof(IndexEntry);
+    if (!ok) { close(); return false; }
+
+    syms_ = reinterpret_cast<const SymbolEntry*>(file_.data() + h.symbols_offset);
+    index_ = reinterpret_cast<const IndexEntry*>(file_.data() + h.index_offset);
+    nsyms_ = (std::size_t)h.num_symbols;
+    rows_ = (std::size_t)h.num_rows;
+    for (std::size_t i = 0; i < nsyms_; ++i) {
+        const SymbolEntry& s = syms_[i];
+        if (s.index_begin > h.num_index || s.index_count > h.num_index - s.index_begin) { close(); return false; }
+        for (std::size_t c = 0; c < kColumns; ++c) {
+            std::uint64_t off = s.column_offset[c];
+            if (off % 8 != 0 || off > size || s.row_count > (size - off) / sizeof(double)) { close(); return false; }
+        }
+        by_name_.emplace(std::string(s.name, strnlen(s.name, kNameLen)), i);
+    }
+    return true;
+}
+
+void BarStore::close() {
+    file_.close();
+    syms_ = nullptr; index_ = nullptr;
+    nsyms_ = 0; rows_ = 0;
+    by_name_.clear();
+}
+
+std::vector<std::string> BarStore::symbols() const {
+    std::vector<std::string> out;
+    out.reserve(nsyms_);
+    for (std::size_t i = 0; i < nsyms_; ++i) out.emplace_back(syms_[i].name, strnlen(syms_[i].name, kNameLen));
+    return out;
+}
+
+BarView BarStore::view_of(const SymbolEntry& s) const {
+    const char* d = file_.data();
+    auto col = [&](std::size_t c) { return reinterpret_cast<const double*>(d + s.column_offset[c]); };
+    return BarView(reinterpret_cast<const std::int64_t*>(d + s.column_offset[0]),
+                   col(1), col(2), col(3), col(4), col(5), (std::size_t)s.row_count);
+}
+
+BarView BarStore::bars(const std::string& symbol) const {
+    auto it = by_name_.find(symbol);
+    return it == by_name_.end() ? BarView{} : view_of(syms_[it->second]);
+}
+
+// First row with ts >= t: find the day in the index, then binary search
+// only that day's slice of the ts column.
+std::size_t BarStore::lower_bound_row(const SymbolEntry& s, const BarView& v, std::int64_t t) const {
+    const IndexEntry* b = index_ + s.index_begin;
+    const IndexEntry* e = b + s.index_count;
+    std::int64_t d = day_of(t);
+    const IndexEntry* it = std::lower_bound(b, e, d, [](const IndexEntry& x, std::int64_t day) { return x.day < day; });
+    if (it == e) return (std::size_t)s.row_count;
+    if (it->day != d) return (std::size_t)it->row_begin;
+    std::size_t lo = (std::size_t)it->row_begin, hi = lo + (std::size_t)it->row_count;
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (v.ts(mid) < t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+BarView BarStore::range(const std::string& symbol, std::int64_t from_ts, std::int64_t to_ts) const {
+    auto it = by_name_.find(symbol);
+    if (it == by_name_.end() || to_ts <= from_ts) return BarView{};
+    const SymbolEntry& s = syms_[it->second];
+    BarView v = view_of(s);
+    std::size_t lo = lower_bound_row(s, v, from_ts);
+    std::size_t hi = lower_bound_row(s, v, to_ts);
+    return v.slice(lo, hi - lo);
+}
+
+bool BarStore::convert_csv(const std::vector<std::pair<std::string, std::string>>& symbol_csvs,
+                           const std::string& out_path) {
+    BarStoreWriter w;
+    if (!w.open(out_path)) return false;
+    for (const auto& sc : symbol_csvs) {
+        auto bars = DataLoader::load_csv_mmap(sc.second);
+        std::stable_sort(bars.begin(), bars.end(), [](const Bar& a, const Bar& b) { return a.ts < b.ts; });
+        if (!w.add_symbol(sc.first, bars)) { w.close(); return false; }
+    }
+    return w.close();
+}
+
+}
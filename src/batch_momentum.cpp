@@ -0,0 +1,217 @@
+#include "batch_momentum.hpp"
+#include "simd_kernels.hpp"
+#include "strategy.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HFT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+// No fma: a fused multiply-add would round differently from Backtester
+#define HFT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HFT_TARGET_AVX2
+#endif
+
+namespace hft {
+
+namespace {
+
+constexpr std::size_t kWidth = 4; // doubles per AVX2 vector
+
+// One bar for lanes [0, n): the MomentumStrategy decision (a full window
+// of lookback closes, trade qty toward the sign of the window return),
+// then the engine's cost, mark-to-market and online metrics. Operations
+// and their order match the scalar engine exactly.
+struct Lanes {
+    const double* ring;
+    std::uint64_t mask;
+    const std::int64_t* lm1;
+    const double* qty;
+    double* cash;
+    double* pos;
+    double* prev;
+    double* mean;
+    double* m2;
+    double* peak;
+    double* max_dd;
+    double* trades;
+};
+
+void step_scalar(const Lanes& s, std::size_t from, std::size_t n, double c, std::uint64_t t,
+                 bool first, double rets, const CostModel& costs) {
+    const double slip = costs.slippage_bps / 10000.0;
+    for (std::size_t j = from; j < n; ++j) {
+        double p = s.pos[j], q = s.qty[j];
+        double dq = 0;
+        if ((std::int64_t)t >= s.lm1[j] && q > 0) {
+            double f = s.ring[(t - (std::uint64_t)s.lm1[j]) & s.mask];
+            double ret = (c - f) / f;
+            if (ret > 0.0 && p <= 0) dq = q;
+            else if (ret < 0.0 && p >= 0) dq = -q;
+        }
+        double cash = s.cash[j] - dq * c;
+        double aq = std::abs(dq);
+        cash -= costs.commission_per_share * aq + slip * c * aq;
+        p += dq;
+        s.trades[j] += dq != 0;
+        s.cash[j] = cash;
+        s.pos[j] = p;
+
+        double eq = cash + p * c;
+        if (!first) {
+            double r = (eq - s.prev[j]) / s.prev[j];
+            double d = r - s.mean[j];
+            s.mean[j] += d / rets;
+            s.m2[j] += d * (r - s.mean[j]);
+        }
+        double pk = first ? eq : s.peak[j];
+        if (eq > pk) pk = eq;
+        double dd = (pk - eq) / pk;
+        if (dd > s.max_dd[j]) s.max_dd[j] = dd;
+        s.peak[j] = pk;
+        s.prev[j] = eq;
+    }
+}
+
+#ifdef HFT_SIMD_X86
+HFT_TARGET_AVX2
+std::size_t step_avx2(const Lanes& s, std::size_t n, double c, std::uint64_t t,
+                      bool first, double rets, const CostModel& costs) {
+    const __m256d vc = _mm256_set1_pd(c);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d vcomm = _mm256_set1_pd(costs.commission_per_share);
+    const __m256d vslipc = _mm256_set1_pd(costs.slippage_bps / 10000.0 * c);
+    const __m256d vrets = _mm256_set1_pd(rets);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256i vt = _mm256_set1_epi64x((std::int64_t)t);
+    const __m256i vmask = _mm256_set1_epi64x((std::int64_t)s.mask);
+    std::size_t j = 0;
+    for (; j + kWidth <= n; j += kWidth) {
+        __m256i lm1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.lm1 + j));
+        __m256d q = _mm256_loadu_pd(s.qty + j);
+        __m256d p = _mm256_loadu_pd(s.pos + j);
+        // Window start close; lanes whose window is not full are masked off
+        __m256i idx = _mm256_and_si256(_mm256_sub_epi64(vt, lm1), vmask);
+        __m256d f = _mm256_i64gather_pd(s.ring, idx, 8);
+        __m256d ready = _mm256_castsi256_pd(_mm256_xor_si256(_mm256_cmpgt_epi64(lm1, vt), _mm256_set1_epi64x(-1)));
+        ready = _mm256_and_pd(ready, _mm256_cmp_pd(q, zero, _CMP_GT_OQ));
+        __m256d ret = _mm256_div_pd(_mm256_sub_pd(vc, f), f);
+        __m256d buy = _mm256_and_pd(_mm256_cmp_pd(ret, zero, _CMP_GT_OQ), _mm256_cmp_pd(p, zero, _CMP_LE_OQ));
+        __m256d sell = _mm256_and_pd(_mm256_cmp_pd(ret, zero, _CMP_LT_OQ), _mm256_cmp_pd(p, zero, _CMP_GE_OQ));
+        __m256d dq = _mm256_or_pd(_mm256_and_pd(buy, q), _mm256_and_pd(sell, _mm256_xor_pd(q, sign)));
+        dq = _mm256_and_pd(ready, dq);
+
+        __m256d cash = _mm256_sub_pd(_mm256_loadu_pd(s.cash + j), _mm256_mul_pd(dq, vc));
+        __m256d aq = _mm256_andnot_pd(sign, dq);
+        // slippage_bps / 10000 * price * |qty|, left to right as CostModel::cost
+        __m256d cost = _mm256_add_pd(_mm256_mul_pd(vcomm, aq), _mm256_mul_pd(vslipc, aq));
+        cash = _mm256_sub_pd(cash, cost);
+        p = _mm256_add_pd(p, dq);
+        __m256d traded = _mm256_and_pd(_mm256_cmp_pd(dq, zero, _CMP_NEQ_OQ), _mm256_set1_pd(1.0));
+        _mm256_storeu_pd(s.trades + j, _mm256_add_pd(_mm256_loadu_pd(s.trades + j), traded));
+        _mm256_storeu_pd(s.cash + j, cash);
+        _mm256_storeu_pd(s.pos + j, p);
+
+        __m256d eq = _mm256_add_pd(cash, _mm256_mul_pd(p, vc));
+        if (!first) {
+            __m256d pv = _mm256_loadu_pd(s.prev + j);
+            __m256d r = _mm256_div_pd(_mm256_sub_pd(eq, pv), pv);
+            __m256d mean = _mm256_loadu_pd(s.mean + j);
+            __m256d d = _mm256_sub_pd(r, mean);
+            mean = _mm256_add_pd(mean, _mm256_div_pd(d, vrets));
+            __m256d m2 = _mm256_add_pd(_mm256_loadu_pd(s.m2 + j), _mm256_mul_pd(d, _mm256_sub_pd(r, mean)));
+            _mm256_storeu_pd(s.mean + j, mean);
+            _mm256_storeu_pd(s.m2 + j, m2);
+        }
+        __m256d pk = first ? eq : _mm256_loadu_pd(s.peak + j);
+        pk = _mm256_max_pd(eq, pk); // eq > pk ? eq : pk
+        __m256d dd = _mm256_div_pd(_mm256_sub_pd(pk, eq), pk);
+        _mm256_storeu_pd(s.max_dd + j, _mm256_max_pd(dd, _mm256_loadu_pd(s.max_dd + j)));
+        _mm256_storeu_pd(s.peak + j, pk);
+        _mm256_storeu_pd(s.prev + j, eq);
+    }
+    return j;
+}
+#endif
+
+}
+
+BatchMomentum::BatchMomentum(const std::vector<MomentumParams>& params, const CostModel& costs)
+    : n_(params.size()), lanes_((params.size() + kWidth - 1) / kWidth * kWidth), costs_(costs) {
+    std::int64_t longest = 1;
+    lm1_.assign(lanes_, 0);
+    qty_.assign(lanes_, 0.0);
+    for (std::size_t j = 0; j < n_; ++j) {
+        // A non-positive lookback behaves as a window of one close
+        std::int64_t lb = std::max(params[j].lookback, 1);
+        lm1_[j] = lb - 1;
+        qty_[j] = params[j].qty;
+        longest = std::max(longest, lb);
+    }
+    std::uint64_t cap = 1;
+    while (cap < (std::uint64_t)longest) cap <<= 1;
+    ring_.assign(cap, 0.0);
+    mask_ = cap - 1;
+    cash_.assign(lanes_, StrategyContext{}.cash);
+    pos_.assign(lanes_, 0.0);
+    prev_.assign(lanes_, 0.0);
+    mean_.assign(lanes_, 0.0);
+    m2_.assign(lanes_, 0.0);
+    peak_.assign(lanes_, 0.0);
+    max_dd_.assign(lanes_, 0.0);
+    trades_.assign(lanes_, 0.0);
+#ifdef HFT_SIMD_X86
+    avx2_ = simd::active_isa() != simd::Isa::Scalar;
+#endif
+}
+
+void BatchMomentum::add(double close) {
+    ring_[bars_ & mask_] = close;
+    bool first = bars_ == 0;
+    if (!first) ++rets_;
+    Lanes s{ring_.data(), mask_, lm1_.data(), qty_.data(), cash_.data(), pos_.data(), prev_.data(),
+            mean_.data(), m2_.data(), peak_.data(), max_dd_.data(), trades_.data()};
+    std::size_t j = 0;
+#ifdef HFT_SIMD_X86
+    if (avx2_) j = step_avx2(s, lanes_, close, bars_, first, (double)rets_, costs_);
+#endif
+    step_scalar(s, j, n_, close, bars_, first, (double)rets_, costs_);
+    ++bars_;
+}
+
+std::vector<StreamResult> BatchMomentum::results() const {
+    std::vector<StreamResult> out(n_);
+    for (std::size_t j = 0; j < n_; ++j) {
+        StreamResult& r = out[j];
+        r.bars = (std::size_t)bars_;
+        r.num_trades = (std::size_t)trades_[j];
+        double var = rets_ ? m2_[j] / rets_ : 0.0;
+        double sd = std::sqrt(var);
+        r.sharpe = sd == 0.0 ? 0.0 : mean_[j] / sd;
+        r.max_dd = max_dd_[j];
+        r.final_equity = bars_ ? prev_[j] : cash_[j];
+    }
+    return out;
+}
+
+std::vector<StreamResult> BatchMomentum::run(const BarView& bars, const std::vector<MomentumParams>& params,
+                                             const CostModel& costs) {
+    BatchMomentum b(params, costs);
+    for (std::size_t i = 0; i < bars.size(); ++i) b.add(bars.close(i));
+    return b.results();
+}
+
+std::vector<StreamResult> BatchMomentum::run_stream(BarSource& src, const std::vector<MomentumParams>& params,
+                                                    const CostModel& costs, const StreamOptions& opt) {
+    BatchMomentum b(params, costs);
+    std::vector<Bar> chunk(std::max<std::size_t>(1, opt.chunk_bars));
+    for (std::size_t got; (got = src.next(chunk.data(), chunk.size())) > 0;)
+        for (std::size_t k = 0; k < got; ++k) b.add(chunk[k].close);
+    return b.results();
+}
+
+}
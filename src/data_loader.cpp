@@ -1,4 +1,9 @@
 #include "data_loader.hpp"
+#include "bar_columns.hpp"
+#include "csv_parse.hpp"
+#include "mapped_file.hpp"
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -28,4 +33,55 @@ std::vector<Bar> DataLoader::load_csv(const std::string& path) {
     return out;
 }
 
+namespace {
+
+// Maps the file and feeds every parsed bar to out (a vector or BarColumns)
+template <class Out>
+void parse_mapped(const std::string& path, Out& out, LoadStats* stats) {
+    auto t0 = std::chrono::steady_clock::now();
+    LoadStats st;
+    MappedFile file;
+    if (file.open(path) && file.size() > 0) {
+        const char* p = file.begin();
+        const char* end = file.end();
+
+        // Presize from the newline count (+1 for an unterminated last line)
+        std::size_t lines = 1;
+        for (const char* q = p; (q = static_cast<const char*>(std::memchr(q, '\n', end - q))) != nullptr; ++q) ++lines;
+        out.reserve(lines);
+
+        bool first = true;
+        while (p < end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* eol = nl ? nl : end;
+            if (first) {
+                first = false;
+                if (csv::is_header(p, eol)) { p = eol + 1; continue; }
+            }
+            Bar b{};
+            if (csv::parse_bar(p, eol, b)) out.push_back(b);
+            else if (!csv::is_blank(p, eol)) ++st.malformed;
+            p = eol + 1;
+        }
+    }
+    st.rows = out.size();
+    st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    st.rows_per_sec = st.seconds > 0 ? st.rows / st.seconds : 0.0;
+    if (stats) *stats = st;
+}
+
+}
+
+std::vector<Bar> DataLoader::load_csv_mmap(const std::string& path, LoadStats* stats) {
+    std::vector<Bar> out;
+    parse_mapped(path, out, stats);
+    return out;
+}
+
+BarColumns DataLoader::load_csv_columns(const std::string& path, LoadStats* stats) {
+    BarColumns out;
+    parse_mapped(path, out, stats);
+    return out;
+}
+
 }
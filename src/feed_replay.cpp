@@ -0,0 +1,123 @@
+#include "feed_replay.hpp"
+#include <algorithm>
+
+namespace hft {
+
+// ---------------------------------------------------------------- book replay
+
+LimitOrderBook& BookReplay::book(std::uint16_t symbol) {
+    if (books_.size() <= symbol) books_.resize((std::size_t)symbol + 1);
+    auto& b = books_[symbol];
+    if (!b) b.reset(new LimitOrderBook(tick_));
+    return *b;
+}
+
+void BookReplay::on_book(const BookDelta& d) {
+    LimitOrderBook& lob = book(d.symbol);
+    BookDelta out = d;
+    bool ok = true;
+    switch (d.action) {
+    case BookAction::Add:
+        ok = lob.add(d.id, d.side, d.price, d.qty);
+        break;
+    case BookAction::Execute:
+    case BookAction::Cancel:
+    case BookAction::Delete: {
+        std::int64_t resting = 0;
+        ok = lob.order(d.id, &out.side, &out.price, &resting);
+        if (!ok) break;
+        out.qty = d.action == BookAction::Delete ? resting : std::min(d.qty, resting);
+        if (d.action == BookAction::Delete) lob.cancel(d.id);
+        else if (d.action == BookAction::Cancel) lob.reduce(d.id, out.qty);
+        else lob.execute(d.id, out.qty);
+        break;
+    }
+    case BookAction::Replace:
+        ok = lob.order(d.id, &out.side, nullptr, nullptr) && lob.replace(d.id, d.new_id, d.price, d.qty);
+        break;
+    }
+    if (!ok) { ++rejected_; return; }
+    if (!down_) return;
+    down_->on_book(out);
+    if (d.action == BookAction::Execute) {
+        Side aggressor = out.side == Side::Buy ? Side::Sell : Side::Buy;
+        down_->on_trade(TradeEvent{d.ts_ns, d.symbol, aggressor, out.price, out.qty, d.id});
+    }
+}
+
+// ---------------------------------------------------------------- bars
+
+void BarAggregator::on_trade(const TradeEvent& t) {
+    if (open_.size() <= t.symbol) open_.resize((std::size_t)t.symbol + 1);
+    Open& o = open_[t.symbol];
+    std::int64_t bucket = t.ts_ns / interval_ns_;
+    if (t.ts_ns < 0 && bucket * interval_ns_ != t.ts_ns) --bucket; // floor
+    if (o.active && bucket != o.bucket) {
+        sink_(t.symbol, o.bar);
+        o.active = false;
+    }
+    double qty = (double)t.qty;
+    if (!o.active) {
+        o.active = true;
+        o.bucket = bucket;
+        o.bar = {bucket * (interval_ns_ / 1000000), t.price, t.price, t.price, t.price, qty};
+        return;
+    }
+    o.bar.high = std::max(o.bar.high, t.price);
+    o.bar.low = std::min(o.bar.low, t.price);
+    o.bar.close = t.price;
+    o.bar.volume += qty;
+}
+
+void BarAggregator::flush() {
+    for (std::size_t s = 0; s < open_.size(); ++s) {
+        if (!open_[s].active) continue;
+        open_[s].active = false;
+        sink_((std::uint16_t)s, open_[s].bar);
+    }
+}
+
+// ---------------------------------------------------------------- source
+
+FeedBarSource::FeedBarSource(const std::string& path, const std::string& symbol, std::int64_t interval_ms)
+    : reader_(path),
+      symbol_(symbol),
+      agg_(interval_ms, [this](std::uint16_t s, const Bar& b) {
+          if (locate_ < 0) resolve();
+          if ((int)s == locate_) ready_.push_back(b);
+      }),
+      replay_(&agg_) {
+    // The directory precedes the first event, so one read resolves the symbol
+    has_pending_ = reader_.next(pending_);
+    resolve();
+}
+
+void FeedBarSource::resolve() {
+    if (!symbol_.empty()) { locate_ = reader_.locate(symbol_); return; }
+    const auto& syms = reader_.symbols();
+    for (std::size_t i = 0; i < syms.size(); ++i)
+        if (!syms[i].empty()) { locate_ = (int)i; symbol_ = syms[i]; return; }
+}
+
+std::size_t FeedBarSource::next(Bar* out, std::size_t max) {
+    std::size_t m = 0;
+    while (m < max) {
+        if (ready_pos_ < ready_.size()) {
+            std::size_t n = std::min(max - m, ready_.size() - ready_pos_);
+            std::copy(ready_.begin() + ready_pos_, ready_.begin() + ready_pos_ + n, out + m);
+            ready_pos_ += n;
+            m += n;
+            continue;
+        }
+        ready_.clear();
+        ready_pos_ = 0;
+        if (done_) break;
+        if (has_pending_) { has_pending_ = false; dispatch(pending_, replay_); continue; }
+        MarketEvent ev;
+        if (reader_.next(ev)) dispatch(ev, replay_);
+        else { agg_.flush(); done_ = true; }
+    }
+    return m;
+}
+
+}
@@ -0,0 +1,358 @@
+#include "itch_feed.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace hft {
+
+namespace {
+
+inline void put16(char* p, std::uint16_t v) { p[0] = (char)(v >> 8); p[1] = (char)v; }
+inline void put32(char* p, std::uint32_t v) { for (int i = 3; i >= 0; --i, v >>= 8) p[i] = (char)v; }
+inline void put64(char* p, std::uint64_t v) { for (int i = 7; i >= 0; --i, v >>= 8) p[i] = (char)v; }
+
+inline std::uint16_t get16(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (std::uint16_t)((u[0] << 8) | u[1]);
+}
+inline std::uint32_t get32(const char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(v);
+#else
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return ((std::uint32_t)u[0] << 24) | ((std::uint32_t)u[1] << 16) | ((std::uint32_t)u[2] << 8) | u[3];
+#endif
+}
+inline std::uint64_t get64(const char* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return __builtin_bswap64(v);
+#else
+    return ((std::uint64_t)get32(p) << 32) | get32(p + 4);
+#endif
+}
+
+inline std::uint32_t to_px4(double price) { return (std::uint32_t)std::llround(price * 10000.0); }
+inline double from_px4(std::uint32_t v) { return v / 10000.0; }
+
+// Resting-order indicator of 'P'/'A' messages
+inline char side_char(Side s) { return s == Side::Buy ? 'B' : 'S'; }
+inline Side opposite(Side s) { return s == Side::Buy ? Side::Sell : Side::Buy; }
+
+void put_stock(char* p, const std::string& name) {
+    std::memset(p, ' ', 8);
+    std::memcpy(p, name.data(), std::min<std::size_t>(name.size(), 8));
+}
+
+}
+
+// ---------------------------------------------------------------- writer
+
+FeedWriter::FeedWriter(const std::string& path, std::size_t buffer_bytes) {
+    f_ = std::fopen(path.c_str(), "wb");
+    buf_.resize(std::max<std::size_t>(buffer_bytes, 256));
+}
+
+// Reserves a message of the given type in the buffer and fills the header
+char* FeedWriter::begin(char type, std::int64_t ts_ns, std::uint16_t locate) {
+    std::size_t len = itch::message_size(type);
+    if (used_ + len + 2 > buf_.size()) {
+        if (f_ && used_ && std::fwrite(buf_.data(), 1, used_, f_) != used_) failed_ = true;
+        used_ = 0;
+    }
+    char* p = buf_.data() + used_;
+    used_ += len + 2;
+    ++messages_;
+    put16(p, (std::uint16_t)len);
+    p[2] = type;
+    put16(p + 3, locate);
+    put16(p + 5, 0);
+    put64(p + 7, (std::uint64_t)ts_ns);
+    return p + 2 + itch::kHeader;
+}
+
+void FeedWriter::symbol(std::int64_t ts_ns, std::uint16_t locate, const std::string& name) {
+    put_stock(begin('R', ts_ns, locate), name);
+}
+
+void FeedWriter::add(std::int64_t ts_ns, std::uint16_t locate, OrderId id, Side side, double price, std::uint32_t qty) {
+    char* p = begin('A', ts_ns, locate);
+    put64(p, id);
+    p[8] = side_char(side);
+    put32(p + 9, qty);
+    std::memset(p + 13, ' ', 8);
+    put32(p + 21, to_px4(price));
+}
+
+void FeedWriter::execute(std::int64_t ts_ns, std::uint16_t locate, OrderId id, std::uint32_t qty, std::uint64_t match) {
+    char* p = begin('E', ts_ns, locate);
+    put64(p, id);
+    put32(p + 8, qty);
+    put64(p + 12, match);
+}
+
+void FeedWriter::cancel(std::int64_t ts_ns, std::uint16_t locate, OrderId id, std::uint32_t qty) {
+    char* p = begin('X', ts_ns, locate);
+    put64(p, id);
+    put32(p + 8, qty);
+}
+
+void FeedWriter::remove(std::int64_t ts_ns, std::uint16_t locate, OrderId id) {
+    put64(begin('D', ts_ns, locate), id);
+}
+
+void FeedWriter::replace(std::int64_t ts_ns, std::uint16_t locate, OrderId id, OrderId new_id, double price, std::uint32_t qty) {
+    char* p = begin('U', ts_ns, locate);
+    put64(p, id);
+    put64(p + 8, new_id);
+    put32(p + 16, qty);
+    put32(p + 20, to_px4(price));
+}
+
+void FeedWriter::trade(std::int64_t ts_ns, std::uint16_t locate, Side aggressor, double price, std::uint32_t qty, std::uint64_t match) {
+    char* p = begin('P', ts_ns, locate);
+    put64(p, 0);
+    p[8] = side_char(opposite(aggressor));
+    put32(p + 9, qty);
+    std::memset(p + 13, ' ', 8);
+    put32(p + 21, to_px4(price));
+    put64(p + 25, match);
+}
+
+void FeedWriter::quote(std::int64_t ts_ns, std::uint16_t locate, double bid, std::uint32_t bid_qty, double ask, std::uint32_t ask_qty) {
+    char* p = begin('Q', ts_ns, locate);
+    put32(p, to_px4(bid));
+    put32(p + 4, bid_qty);
+    put32(p + 8, to_px4(ask));
+    put32(p + 12, ask_qty);
+}
+
+bool FeedWriter::close() {
+    if (!f_) return false;
+    if (used_ && std::fwrite(buf_.data(), 1, used_, f_) != used_) failed_ = true;
+    used_ = 0;
+    if (std::fclose(f_) != 0) failed_ = true;
+    f_ = nullptr;
+    return !failed_;
+}
+
+// ---------------------------------------------------------------- reader
+
+bool FeedReader::open(const std::string& path) {
+    if (!file_.open(path)) { data_ = p_ = end_ = nullptr; return false; }
+    // An empty file maps to nothing but is still a valid, empty feed
+    static const char empty = 0;
+    open(file_.size() ? file_.data() : &empty, file_.size());
+    return true;
+}
+
+void FeedReader::open(const char* data, std::size_t size) {
+    data_ = data;
+    end_ = data + size;
+    rewind();
+}
+
+void FeedReader::rewind() {
+    p_ = data_;
+    symbols_.clear();
+    messages_ = 0;
+    malformed_ = 0;
+    truncated_ = false;
+}
+
+bool FeedReader::next(MarketEvent& ev) {
+    while (end_ - p_ >= 2) {
+        std::size_t len = get16(p_);
+        const char* m = p_ + 2;
+        if ((std::size_t)(end_ - m) < len) { truncated_ = true; p_ = end_; return false; }
+        p_ = m + len;
+        ++messages_;
+        if (len == 0) { ++malformed_; continue; }
+        char type = m[0];
+        std::size_t need = itch::message_size(type);
+        if (need == 0) continue; // a type this decoder does not use
+        if (len < need) { ++malformed_; continue; }
+
+        std::uint16_t loc = get16(m + 1);
+        std::int64_t ts = (std::int64_t)get64(m + 5);
+        const char* b = m + itch::kHeader;
+        switch (type) {
+        case 'R': {
+            std::size_t n = 8;
+            while (n > 0 && b[n - 1] == ' ') --n;
+            if (symbols_.size() <= loc) symbols_.resize((std::size_t)loc + 1);
+            symbols_[loc].assign(b, n);
+            continue;
+        }
+        case 'A':
+            ev.type = EventType::Book;
+            ev.book = {ts, loc, BookAction::Add, b[8] == 'S' ? Side::Sell : Side::Buy,
+                       get64(b), 0, from_px4(get32(b + 21)), (std::int64_t)get32(b + 9)};
+            return true;
+        case 'E':
+            // Price and side are those of the resting order; see BookReplay
+            ev.type = EventType::Book;
+            ev.book = {ts, loc, BookAction::Execute, Side::Buy, get64(b), 0, 0.0, (std::int64_t)get32(b + 8)};
+            return true;
+        case 'X':
+            ev.type = EventType::Book;
+            ev.book = {ts, loc, BookAction::Cancel, Side::Buy, get64(b), 0, 0.0, (std::int64_t)get32(b + 8)};
+            return true;
+        case 'D':
+            ev.type = EventType::Book;
+            ev.book = {ts, loc, BookAction::Delete, Side::Buy, get64(b), 0, 0.0, 0};
+            return true;
+        case 'U':
+            ev.type = EventType::Book;
+            ev.book = {ts, loc, BookAction::Replace, Side::Buy, get64(b), get64(b + 8),
+                       from_px4(get32(b + 20)), (std::int64_t)get32(b + 16)};
+            return true;
+        case 'P':
+            ev.type = EventType::Trade;
+            ev.trade = {ts, loc, b[8] == 'S' ? Side::Buy : Side::Sell, from_px4(get32(b + 21)),
+                        (std::int64_t)get32(b + 9), 0};
+            return true;
+        case 'Q':
+            ev.type = EventType::Quote;
+            ev.quote = {ts, loc, from_px4(get32(b)), from_px4(get32(b + 8)),
+                        (std::int64_t)get32(b + 4), (std::int64_t)get32(b + 12)};
+            return true;
+        }
+    }
+    if (p_ != end_) { truncated_ = true; p_ = end_; }
+    return false;
+}
+
+std::size_t FeedReader::replay(MarketEventHandler& h) {
+    MarketEvent ev;
+    std::size_t n = 0;
+    while (next(ev)) { dispatch(ev, h); ++n; }
+    return n;
+}
+
+const std::string& FeedReader::symbol(std::uint16_t locate) const {
+    static const std::string none;
+    return locate < symbols_.size() ? symbols_[locate] : none;
+}
+
+int FeedReader::locate(const std::string& name) const {
+    for (std::size_t i = 0; i < symbols_.size(); ++i)
+        if (symbols_[i] == name) return (int)i;
+    return -1;
+}
+
+// ---------------------------------------------------------------- synthetic
+
+bool write_synthetic_feed(const std::string& path, const std::vector<std::string>& symbols,
+                          std::size_t messages, std::int64_t t0_ns, std::int64_t mean_gap_ns,
+                          std::uint64_t seed) {
+    FeedWriter w(path);
+    if (!w.is_open() || symbols.empty()) return false;
+
+    struct Resting { OrderId id; Side side; std::int64_t px; std::uint32_t qty; };
+    struct Sym {
+        std::int64_t anchor; // cents; new orders are placed around it
+        std::vector<Resting> live;
+    };
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::exponential_distribution<double> gap(1.0 / (double)std::max<std::int64_t>(mean_gap_ns, 1));
+    const std::size_t kMaxLive = 128;
+
+    std::vector<Sym> syms(symbols.size());
+    std::int64_t ts = t0_ns;
+    for (std::size_t s = 0; s < symbols.size(); ++s) {
+        w.symbol(ts, (std::uint16_t)s, symbols[s]);
+        syms[s].anchor = 10000 + 2500 * (std::int64_t)s;
+    }
+
+    OrderId next_id = 1;
+    std::uint64_t match = 1;
+    auto best = [](const Sym& s, Side side, std::size_t* at) {
+        std::int64_t px = side == Side::Buy ? INT64_MIN : INT64_MAX;
+        for (std::size_t i = 0; i < s.live.size(); ++i) {
+            const Resting& r = s.live[i];
+            if (r.side != side) continue;
+            bool better = side == Side::Buy ? r.px > px : r.px < px;
+            if (better) { px = r.px; if (at) *at = i; }
+        }
+        return px;
+    };
+    // Uncrossed price k ticks away from the anchor on one side
+    auto place_px = [&](const Sym& s, Side side, std::int64_t k) {
+        if (side == Side::Buy) {
+            std::int64_t ask = best(s, Side::Sell, nullptr);
+            return std::max<std::int64_t>(1, std::min(s.anchor - k, ask == INT64_MAX ? ask : ask - 1));
+        }
+        std::int64_t bid = best(s, Side::Buy, nullptr);
+        return std::max(s.anchor + k, bid == INT64_MIN ? bid : bid + 1);
+    };
+
+    for (std::size_t m = 0; m < messages; ++m) {
+        ts += 1 + (std::int64_t)gap(rng);
+        std::uint16_t loc = (std::uint16_t)(rng() % symbols.size());
+        Sym& s = syms[loc];
+        double r = u(rng);
+        if (s.live.size() < 16) r = 0;            // keep the book populated
+        else if (s.live.size() >= kMaxLive) r = 0.5; // and bounded
+
+        if (r < 0.40) {
+            Side side = u(rng) < 0.5 ? Side::Buy : Side::Sell;
+            std::int64_t px = place_px(s, side, 1 + (std::int64_t)(rng() % 8));
+            std::uint32_t qty = 100 * (1 + (std::uint32_t)(rng() % 10));
+            OrderId id = next_id++;
+            s.live.push_back({id, side, px, qty});
+            w.add(ts, loc, id, side, px / 100.0, qty);
+        } else if (r < 0.65) {
+            std::size_t i = rng() % s.live.size();
+            Resting& o = s.live[i];
+            if (o.qty > 100 && u(rng) < 0.3) {
+                o.qty -= 100;
+                w.cancel(ts, loc, o.id, 100);
+            } else {
+                w.remove(ts, loc, o.id);
+                s.live[i] = s.live.back();
+                s.live.pop_back();
+            }
+        } else if (r < 0.75) {
+            std::size_t i = rng() % s.live.size();
+            Resting o = s.live[i];
+            s.live[i] = s.live.back();
+            s.live.pop_back();
+            Resting n{next_id++, o.side, place_px(s, o.side, 1 + (std::int64_t)(rng() % 8)), o.qty};
+            s.live.push_back(n);
+            w.replace(ts, loc, o.id, n.id, n.px / 100.0, n.qty);
+        } else if (r < 0.95) {
+            // Marketable flow takes the top of one side; the anchor follows it
+            Side hit = u(rng) < 0.5 ? Side::Buy : Side::Sell;
+            std::size_t i = 0;
+            std::int64_t px = best(s, hit, &i);
+            if (px == INT64_MIN || px == INT64_MAX) { --m; continue; }
+            Resting& o = s.live[i];
+            std::uint32_t q = std::min<std::uint32_t>(o.qty, 100 * (1 + (std::uint32_t)(rng() % 5)));
+            w.execute(ts, loc, o.id, q, match++);
+            o.qty -= q;
+            if (o.qty == 0) { s.live[i] = s.live.back(); s.live.pop_back(); }
+            s.anchor = px;
+        } else if (r < 0.98) {
+            std::int64_t bid = best(s, Side::Buy, nullptr), ask = best(s, Side::Sell, nullptr);
+            if (bid == INT64_MIN || ask == INT64_MAX) { --m; continue; }
+            std::uint32_t bq = 0, aq = 0;
+            for (const Resting& o : s.live) {
+                if (o.side == Side::Buy && o.px == bid) bq += o.qty;
+                if (o.side == Side::Sell && o.px == ask) aq += o.qty;
+            }
+            w.quote(ts, loc, bid / 100.0, bq, ask / 100.0, aq);
+        } else {
+            Side aggressor = u(rng) < 0.5 ? Side::Buy : Side::Sell;
+            w.trade(ts, loc, aggressor, s.anchor / 100.0, 100, match++);
+        }
+    }
+    return w.close();
+}
+
+}
@@ -0,0 +1,75 @@
+#include "job_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace hft {
+
+double ScheduleResult::utilization() const {
+    if (workers.empty() || seconds <= 0) return 0.0;
+    double busy = 0;
+    for (const auto& w : workers) busy += w.busy_seconds;
+    return busy / ((double)workers.size() * seconds);
+}
+
+std::vector<std::vector<std::size_t>> JobScheduler::place(const std::vector<BacktestJob>& jobs, std::size_t workers) {
+    workers = std::max<std::size_t>(1, workers);
+    auto cost = [&](std::size_t j) { return jobs[j].bars.size() + 1; };
+
+    // Symbol groups in first-appearance order; jobs without a symbol stand alone
+    struct Group {
+        std::vector<std::size_t> jobs;
+        std::size_t cost = 0;
+    };
+    std::vector<Group> groups;
+    std::map<std::string, std::size_t> by_symbol;
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        std::size_t g = groups.size();
+        if (!jobs[j].symbol.empty()) {
+            auto it = by_symbol.emplace(jobs[j].symbol, groups.size()).first;
+            g = it->second;
+        }
+        if (g == groups.size()) groups.emplace_back();
+        groups[g].jobs.push_back(j);
+        groups[g].cost += cost(j);
+    }
+
+    // Longest group first onto the least loaded worker
+    std::vector<std::size_t> order(groups.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return groups[a].cost > groups[b].cost; });
+    std::vector<std::vector<std::size_t>> queues(workers);
+    std::vector<std::size_t> load(workers, 0);
+    for (std::size_t g : order) {
+        std::size_t w = std::min_element(load.begin(), load.end()) - load.begin();
+        queues[w].insert(queues[w].end(), groups[g].jobs.begin(), groups[g].jobs.end());
+        load[w] += groups[g].cost;
+    }
+    // The owner pops from the back, so its largest job runs first
+    for (auto& q : queues)
+        std::stable_sort(q.begin(), q.end(), [&](std::size_t a, std::size_t b) { return cost(a) < cost(b); });
+    return queues;
+}
+
+ScheduleResult JobScheduler::run(const std::vector<BacktestJob>& jobs, const SchedulerConfig& cfg) {
+    ScheduleResult res;
+    res.results.resize(jobs.size());
+    WorkStealingPool pool(cfg.threads, cfg.pin);
+    auto queues = place(jobs, pool.size());
+
+    auto t0 = std::chrono::steady_clock::now();
+    pool.run(queues, [&](std::size_t j, std::size_t) {
+        const BacktestJob& job = jobs[j];
+        auto strat = job.factory ? job.factory(job.params) : nullptr;
+        if (!strat) {
+            res.results[j].asset = job.name;
+            return;
+        }
+        res.results[j] = AdvancedBacktester::run(job.name, job.bars, *strat, job.costs, job.risk, job.lob);
+    });
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    res.workers = pool.stats();
+    return res;
+}
+
+}
@@ -0,0 +1,458 @@
+#include "limit_order_book.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace hft {
+
+// ---------------------------------------------------------------- id index
+
+void LimitOrderBook::IdIndex::reset(std::size_t cap) {
+    std::size_t c = 16;
+    unsigned bits = 4;
+    while (c < cap) { c <<= 1; ++bits; }
+    slots_.assign(c, Slot{0, 0});
+    mask_ = c - 1;
+    shift_ = 64 - bits;
+    size_ = 0;
+}
+
+std::uint32_t LimitOrderBook::IdIndex::find(OrderId id) const {
+    for (std::size_t i = home(id);; i = (i + 1) & mask_) {
+        if (slots_[i].id == id) return slots_[i].node;
+        if (slots_[i].id == 0) return kNil;
+    }
+}
+
+void LimitOrderBook::IdIndex::insert(OrderId id, std::uint32_t node) {
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        reset(old.size() * 2);
+        for (const Slot& s : old) if (s.id) insert(s.id, s.node);
+    }
+    std::size_t i = home(id);
+    while (slots_[i].id != 0) i = (i + 1) & mask_;
+    slots_[i] = {id, node};
+    ++size_;
+}
+
+void LimitOrderBook::IdIndex::erase(OrderId id) {
+    std::size_t i = home(id);
+    while (slots_[i].id != id) {
+        if (slots_[i].id == 0) return;
+        i = (i + 1) & mask_;
+    }
+    slots_[i].id = 0;
+    --size_;
+    // Pull later members of the probe run back so lookups never stop early
+    for (std::size_t j = (i + 1) & mask_; slots_[j].id != 0; j = (j + 1) & mask_) {
+        std::size_t k = home(slots_[j].id);
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (stays) continue;
+        slots_[i] = slots_[j];
+        slots_[j].id = 0;
+        i = j;
+    }
+}
+
+// ---------------------------------------------------------------- book
+
+LimitOrderBook::LimitOrderBook(double tick_size, std::size_t levels)
+    : tick_(tick_size > 0 ? tick_size : 0.01), bids_(std::max<std::size_t>(16, levels)),
+      asks_(std::max<std::size_t>(16, levels)) {
+    nodes_.reserve(1024);
+    index_.reset(1024);
+}
+
+void LimitOrderBook::clear() {
+    // Only touched levels are reset, so clearing a small book is cheap
+    for (const Node& n : nodes_) {
+        if (n.qty > 0) level(n.side, n.px) = Level{};
+    }
+    nodes_.clear();
+    free_ = kNil;
+    index_.reset(1024);
+    based_ = false;
+    bid_orders_ = ask_orders_ = 0;
+    seq_ = 0;
+    sims_.clear();
+    active_sims_ = 0;
+    resting_bids_.clear();
+    resting_asks_.clear();
+    fills_.clear();
+}
+
+bool LimitOrderBook::ensure_range(std::int64_t px) {
+    std::int64_t n = (std::int64_t)bids_.size();
+    if (!based_ || order_count() == 0) {
+        // Nothing rests, so the window can simply move
+        if (!based_ || px < base_ || px >= base_ + n) base_ = px - n / 2;
+        based_ = true;
+        return true;
+    }
+    if (px >= base_ && px < base_ + n) return true;
+
+    std::int64_t lo = std::min(base_, px);
+    std::int64_t hi = std::max(base_ + n - 1, px);
+    std::uint64_t need = (std::uint64_t)(hi - lo) + 1;
+    if (need > kMaxLevels) return false;
+    std::size_t m = (std::size_t)n;
+    while (m < need + need / 2) m *= 2;
+    std::int64_t nb = lo - (std::int64_t)(m - need) / 2;
+    std::vector<Level> nbids(m), nasks(m);
+    std::copy(bids_.begin(), bids_.end(), nbids.begin() + (base_ - nb));
+    std::copy(asks_.begin(), asks_.end(), nasks.begin() + (base_ - nb));
+    bids_.swap(nbids);
+    asks_.swap(nasks);
+    base_ = nb;
+    return true;
+}
+
+const LimitOrderBook::Level* LimitOrderBook::find_level(Side side, std::int64_t px) const {
+    if (!based_ || px < base_ || px >= base_ + (std::int64_t)bids_.size()) return nullptr;
+    return &(side == Side::Buy ? bids_ : asks_)[px - base_];
+}
+
+std::uint32_t LimitOrderBook::alloc_node() {
+    if (free_ != kNil) {
+        std::uint32_t n = free_;
+        free_ = nodes_[n].next;
+        return n;
+    }
+    nodes_.push_back(Node{});
+    return (std::uint32_t)(nodes_.size() - 1);
+}
+
+void LimitOrderBook::link(std::uint32_t n) {
+    Node& o = nodes_[n];
+    Level& l = level(o.side, o.px);
+    o.prev = l.tail;
+    o.next = kNil;
+    if (l.tail != kNil) nodes_[l.tail].next = n;
+    else l.head = n;
+    l.tail = n;
+    l.qty += o.qty;
+    ++l.orders;
+}
+
+void LimitOrderBook::unlink(std::uint32_t n) {
+    Node& o = nodes_[n];
+    Level& l = level(o.side, o.px);
+    if (o.prev != kNil) nodes_[o.prev].next = o.next;
+    else l.head = o.next;
+    if (o.next != kNil) nodes_[o.next].prev = o.prev;
+    else l.tail = o.prev;
+    l.qty -= o.qty;
+    --l.orders;
+}
+
+void LimitOrderBook::remove(std::uint32_t n) {
+    Node& o = nodes_[n];
+    unlink(n);
+    bool emptied = level(o.side, o.px).orders == 0;
+    if (o.side == Side::Buy) --bid_orders_;
+    else --ask_orders_;
+    if (emptied && o.px == (o.side == Side::Buy ? best_bid_ : best_ask_)) refresh_best(o.side);
+    index_.erase(o.id);
+    o.qty = 0; // marks the node free for clear()
+    o.next = free_;
+    free_ = n;
+}
+
+void LimitOrderBook::refresh_best(Side side) {
+    if (side == Side::Buy) {
+        if (bid_orders_ == 0) return;
+        while (bids_[best_bid_ - base_].orders == 0) --best_bid_;
+    } else {
+        if (ask_orders_ == 0) return;
+        while (asks_[best_ask_ - base_].orders == 0) ++best_ask_;
+    }
+}
+
+bool LimitOrderBook::add(OrderId id, Side side, double price, std::int64_t qty) {
+    return add_ticks(id, side, to_ticks(price), qty);
+}
+
+bool LimitOrderBook::add_ticks(OrderId id, Side side, std::int64_t px, std::int64_t qty) {
+    if (id == 0 || (id & kSimBit) || qty <= 0) return false;
+    if (index_.find(id) != kNil) return false;
+    if (!ensure_range(px)) return false;
+
+    std::uint32_t n = alloc_node();
+    Node& o = nodes_[n];
+    o.id = id;
+    o.qty = qty;
+    o.px = px;
+    o.seq = ++seq_;
+    o.side = side;
+    link(n);
+    index_.insert(id, n);
+    if (side == Side::Buy) {
+        if (bid_orders_++ == 0 || px > best_bid_) best_bid_ = px;
+    } else {
+        if (ask_orders_++ == 0 || px < best_ask_) best_ask_ = px;
+    }
+    if (active_sims_) sim_cross(side, px, qty);
+    return true;
+}
+
+bool LimitOrderBook::cancel(OrderId id) {
+    if (id & kSimBit) {
+        Sim* s = find_sim(id);
+        if (!s || !s->active) return false;
+        s->active = false;
+        --active_sims_;
+        auto& q = resting(s->side);
+        q.erase(std::find(q.begin(), q.end(), (std::uint32_t)(s - sims_.data())));
+        return true;
+    }
+    std::uint32_t n = index_.find(id);
+    if (n == kNil) return false;
+    remove(n);
+    return true;
+}
+
+bool LimitOrderBook::reduce(OrderId id, std::int64_t qty) {
+    std::uint32_t n = index_.find(id);
+    if (n == kNil || qty <= 0) return false;
+    Node& o = nodes_[n];
+    if (qty >= o.qty) { remove(n); return true; }
+    o.qty -= qty;
+    level(o.side, o.px).qty -= qty;
+    return true;
+}
+
+bool LimitOrderBook::modify(OrderId id, std::int64_t new_qty) {
+    std::uint32_t n = index_.find(id);
+    if (n == kNil) return false;
+    Node& o = nodes_[n];
+    if (new_qty <= 0) { remove(n); return true; }
+    if (new_qty <= o.qty) return new_qty == o.qty || reduce(id, o.qty - new_qty);
+    // A size increase loses time priority
+    unlink(n);
+    o.qty = new_qty;
+    o.seq = ++seq_;
+    link(n);
+    return true;
+}
+
+bool LimitOrderBook::replace(OrderId id, OrderId new_id, double price, std::int64_t qty) {
+    std::uint32_t n = index_.find(id);
+    if (n == kNil || qty <= 0) return false;
+    if (new_id != id && index_.find(new_id) != kNil) return false;
+    Side side = nodes_[n].side;
+    remove(n);
+    return add_ticks(new_id, side, to_ticks(price), qty);
+}
+
+bool LimitOrderBook::execute(OrderId id, std::int64_t qty) {
+    std::uint32_t n = index_.find(id);
+    if (n == kNil || qty <= 0) return false;
+    Node& o = nodes_[n];
+    qty = std::min(qty, o.qty);
+    if (active_sims_) sim_trade(o.side, o.px, o.seq, qty);
+    if (qty == o.qty) { remove(n); return true; }
+    o.qty -= qty;
+    level(o.side, o.px).qty -= qty;
+    return true;
+}
+
+bool LimitOrderBook::order(OrderId id, Side* side, double* price, std::int64_t* qty) const {
+    if (id == 0) return false;
+    std::uint32_t n = index_.find(id);
+    if (n == kNil) return false;
+    const Node& o = nodes_[n];
+    if (side) *side = o.side;
+    if (price) *price = to_price(o.px);
+    if (qty) *qty = o.qty;
+    return true;
+}
+
+std::int64_t LimitOrderBook::qty_at(Side side, double price) const {
+    const Level* l = find_level(side, to_ticks(price));
+    return l ? l->qty : 0;
+}
+
+std::size_t LimitOrderBook::depth(Side side, std::size_t n, std::vector<LevelInfo>& out) const {
+    out.clear();
+    if (side == Side::Buy) {
+        if (!has_bid()) return 0;
+        for (std::int64_t px = best_bid_; px >= base_ && out.size() < n; --px) {
+            const Level& l = bids_[px - base_];
+            if (l.orders) out.push_back({to_price(px), l.qty, l.orders});
+        }
+    } else {
+        if (!has_ask()) return 0;
+        std::int64_t top = base_ + (std::int64_t)asks_.size();
+        for (std::int64_t px = best_ask_; px < top && out.size() < n; ++px) {
+            const Level& l = asks_[px - base_];
+            if (l.orders) out.push_back({to_price(px), l.qty, l.orders});
+        }
+    }
+    return out.size();
+}
+
+std::int64_t LimitOrderBook::sweep(Side side, std::int64_t qty, double* avg_price, double limit_price,
+                                   std::int64_t skip) const {
+    std::int64_t got = 0;
+    double notional = 0;
+    bool limited = limit_price > 0;
+    std::int64_t lim = limited ? to_ticks(limit_price) : 0;
+    if (side == Side::Buy && has_ask()) {
+        std::int64_t top = base_ + (std::int64_t)asks_.size();
+        for (std::int64_t px = best_ask_; px < top && got < qty && (!limited || px <= lim); ++px) {
+            std::int64_t avail = asks_[px - base_].qty, used = std::min(avail, skip);
+            skip -= used;
+            std::int64_t take = std::min(avail - used, qty - got);
+            got += take;
+            notional += take * to_price(px);
+        }
+    } else if (side == Side::Sell && has_bid()) {
+        for (std::int64_t px = best_bid_; px >= base_ && got < qty && (!limited || px >= lim); --px) {
+            std::int64_t avail = bids_[px - base_].qty, used = std::min(avail, skip);
+            skip -= used;
+            std::int64_t take = std::min(avail - used, qty - got);
+            got += take;
+            notional += take * to_price(px);
+        }
+    }
+    if (avg_price) *avg_price = got ? notional / got : 0.0;
+    return got;
+}
+
+// ---------------------------------------------------------------- simulated orders
+
+OrderId LimitOrderBook::place(Side side, double price, std::int64_t qty) {
+    if (qty <= 0 || price <= 0) return 0;
+    Sim s{kSimBit | (OrderId)(sims_.size() + 1), side, to_ticks(price), qty, 0, ++seq_, true};
+    ++active_sims_;
+    // Marketable part: take displayed depth up to the limit, level by level
+    if (side == Side::Buy && has_ask()) {
+        std::int64_t top = base_ + (std::int64_t)asks_.size();
+        for (std::int64_t px = best_ask_; px < top && px <= s.px && s.active; ++px) {
+            std::int64_t q = asks_[px - base_].qty;
+            if (q) sim_fill(s, px, q);
+        }
+    } else if (side == Side::Sell && has_bid()) {
+        for (std::int64_t px = best_bid_; px >= base_ && px >= s.px && s.active; --px) {
+            std::int64_t q = bids_[px - base_].qty;
+            if (q) sim_fill(s, px, q);
+        }
+    }
+    sims_.push_back(s);
+    if (s.active) rest((std::uint32_t)(sims_.size() - 1));
+    return s.id;
+}
+
+void LimitOrderBook::rest(std::uint32_t slot) {
+    // The newest order is behind every other one at its price, so it goes
+    // after those with a worse price and before the rest
+    const Sim& s = sims_[slot];
+    auto& q = resting(s.side);
+    auto at = std::partition_point(q.begin(), q.end(), [&](std::uint32_t k) {
+        return s.side == Side::Buy ? sims_[k].px < s.px : sims_[k].px > s.px;
+    });
+    q.insert(at, slot);
+}
+
+LimitOrderBook::Sim* LimitOrderBook::find_sim(OrderId id) {
+    OrderId i = (id & ~kSimBit) - 1;
+    return (id & kSimBit) && i < sims_.size() ? &sims_[(std::size_t)i] : nullptr;
+}
+
+const LimitOrderBook::Sim* LimitOrderBook::find_sim(OrderId id) const {
+    OrderId i = (id & ~kSimBit) - 1;
+    return (id & kSimBit) && i < sims_.size() ? &sims_[(std::size_t)i] : nullptr;
+}
+
+SimOrderState LimitOrderBook::sim_state(OrderId id) const {
+    SimOrderState st;
+    const Sim* s = find_sim(id);
+    if (!s) return st;
+    st.active = s->active;
+    st.remaining = s->remaining;
+    st.filled = s->filled;
+    if (!s->active) return st;
+    // Displayed orders at the same price that arrived earlier
+    if (const Level* l = find_level(s->side, s->px)) {
+        for (std::uint32_t n = l->head; n != kNil && nodes_[n].seq < s->seq; n = nodes_[n].next) {
+            st.queue_ahead += nodes_[n].qty;
+        }
+    }
+    return st;
+}
+
+void LimitOrderBook::sim_fill(Sim& s, std::int64_t px, std::int64_t qty) {
+    qty = std::min(qty, s.remaining);
+    if (qty <= 0) return;
+    s.remaining -= qty;
+    s.filled += qty;
+    fills_.push_back({s.id, s.side, to_price(px), qty, s.remaining});
+    if (s.remaining == 0) {
+        s.active = false;
+        --active_sims_;
+    }
+}
+
+void LimitOrderBook::sim_trade(Side side, std::int64_t px, std::uint64_t seq, std::int64_t qty) {
+    // Volume traded at px behind (or below) a simulated order would have
+    // reached it first: hand it out in price-time order
+    auto& q = resting(side);
+    while (qty > 0 && !q.empty()) {
+        Sim& s = sims_[q.back()];
+        bool better = side == Side::Buy ? s.px > px : s.px < px;
+        if (!better && !(s.px == px && s.seq < seq)) break;
+        std::int64_t f = std::min(qty, s.remaining);
+        sim_fill(s, s.px, f);
+        qty -= f;
+        if (!s.active) q.pop_back();
+    }
+}
+
+void LimitOrderBook::sim_cross(Side incoming, std::int64_t px, std::int64_t qty) {
+    // A displayed order priced through a resting simulated one would have
+    // traded against it
+    Side resting_side = incoming == Side::Buy ? Side::Sell : Side::Buy;
+    auto& q = resting(resting_side);
+    while (qty > 0 && !q.empty()) {
+        Sim& s = sims_[q.back()];
+        if (resting_side == Side::Buy ? s.px < px : s.px > px) break;
+        std::int64_t f = std::min(qty, s.remaining);
+        sim_fill(s, s.px, f);
+        qty -= f;
+        if (!s.active) q.pop_back();
+    }
+}
+
+// ---------------------------------------------------------------- fill model
+
+void BookFillModel::rebuild(const Bar& bar) {
+    book_.clear();
+    std::int64_t c = book_.to_ticks(bar.close);
+    std::int64_t q = std::max<std::int64_t>(1, (std::int64_t)std::llround(depth_fraction_ * bar.volume));
+    OrderId id = 1;
+    for (int i = 0; i < levels_; ++i) {
+        book_.add(id++, Side::Buy, book_.to_price(c - half_spread_ - i), q);
+        book_.add(id++, Side::Sell, book_.to_price(c + half_spread_ + i), q);
+    }
+}
+
+FillResult BookFillModel::fill(const Bar& bar, int qty) {
+    if (qty == 0) return {};
+    if (!seen_ || bar.ts != bar_ts_) {
+        if (levels_ > 0) rebuild(bar);
+        bar_ts_ = bar.ts;
+        seen_ = true;
+        taken_bought_ = taken_sold_ = 0;
+    }
+    // Earlier orders on this bar already took the front of the depth
+    std::int64_t& taken = qty > 0 ? taken_bought_ : taken_sold_;
+    double avg = 0;
+    std::int64_t got = book_.sweep(qty > 0 ? Side::Buy : Side::Sell, std::abs((std::int64_t)qty), &avg, 0, taken);
+    if (got == 0) return {};
+    taken += got;
+    return {qty > 0 ? (int)got : -(int)got, avg};
+}
+
+}
@@ -1,44 +1,388 @@
 #include <iostream>
 #include <string>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include "data_loader.hpp"
+#include "bar_store.hpp"
+#include "bar_source.hpp"
 #include "backtester.hpp"
 #include "strategies/momentum.hpp"
 #include "strategies/mean_reversion.hpp"
 #include "costs.hpp"
 #include "reports.hpp"
 #include "synthetic.hpp"
+#include "parameter_sweep.hpp"
+#include "walk_forward.hpp"
+#include "monte_carlo.hpp"
+#include "itch_feed.hpp"
+#include "feed_replay.hpp"
 
-int main(int argc, char** argv) {
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// hft_backtester convert <out.hftb> <SYMBOL=path.csv>...
+static int convert(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: hft_backtester convert <out.hftb> <SYMBOL=path.csv>...\n";
+        return 1;
+    }
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (eq == std::string::npos) { std::cerr << "expected SYMBOL=path.csv, got " << arg << "\n"; return 1; }
+        inputs.emplace_back(arg.substr(0, eq), arg.substr(eq + 1));
+    }
+    if (!hft::BarStore::convert_csv(inputs, argv[2])) { std::cerr << "conversion failed\n"; return 1; }
+    std::cout << "Wrote " << inputs.size() << " symbol(s) to " << argv[2] << "\n";
+    return 0;
+}
+
+// hft_backtester stream <file.csv|store.hftb> [curve_every]
+// Constant-memory run: bars are pulled in chunks, only aggregates are kept
+static int stream(int argc, char** argv) {
     using namespace hft;
-    std::vector<Bar> bars;
-    if (argc > 1 && std::string(argv[1]) == std::string("synthetic")) {
-        bars = hft::generate_random_walk(1000);
+    if (argc < 3) {
+        std::cerr << "usage: hft_backtester stream <file.csv|store.hftb> [curve_every]\n";
+        return 1;
+    }
+    std::string path = argv[2];
+    StreamOptions opt;
+    if (argc > 3) opt.curve_every = std::stoul(argv[3]);
+    CostModel costs{0.0, 1.0};
+
+    BarStore store;
+    auto make_source = [&]() -> std::unique_ptr<BarSource> {
+        if (ends_with(path, ".hftb")) {
+            if (!store.is_open() && !store.open(path)) return nullptr;
+            if (store.symbols().empty()) return nullptr;
+            return std::unique_ptr<BarSource>(new ViewBarSource(store.bars(store.symbols().front())));
+        }
+        std::unique_ptr<CsvBarSource> src(new CsvBarSource(path));
+        if (!src->is_open()) return nullptr;
+        return std::unique_ptr<BarSource>(src.release());
+    };
+
+    auto src = make_source();
+    if (!src) { std::cerr << "cannot open " << path << "\n"; return 1; }
+    MomentumStrategy mom(20, 1);
+    opt.curve_path = "results_stream_momentum_equity.csv";
+    auto r = Backtester::run_stream(*src, mom, costs, opt);
+    std::cout << "Momentum bars=" << r.bars << " Sharpe=" << r.sharpe << " FinalEquity=" << r.final_equity
+              << " MaxDD=" << r.max_dd << " Trades=" << r.num_trades << "\n";
+
+    src = make_source();
+    MeanReversionStrategy mr(20, 0.003, 1);
+    opt.curve_path = "results_stream_meanrev_equity.csv";
+    r = Backtester::run_stream(*src, mr, costs, opt);
+    std::cout << "MeanReversion bars=" << r.bars << " Sharpe=" << r.sharpe << " FinalEquity=" << r.final_equity
+              << " MaxDD=" << r.max_dd << " Trades=" << r.num_trades << "\n";
+    return 0;
+}
+
+// hft_backtester makefeed <out.itch> [messages] [SYMBOL...]
+static int makefeed(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: hft_backtester makefeed <out.itch> [messages] [SYMBOL...]\n";
+        return 1;
+    }
+    std::size_t messages = argc > 3 ? std::stoul(argv[3]) : 1000000;
+    std::vector<std::string> symbols;
+    for (int i = 4; i < argc; ++i) symbols.push_back(argv[i]);
+    if (symbols.empty()) symbols = {"AAPL", "MSFT"};
+    if (!hft::write_synthetic_feed(argv[2], symbols, messages)) { std::cerr << "cannot write " << argv[2] << "\n"; return 1; }
+    std::cout << "Wrote " << messages << " messages for " << symbols.size() << " symbol(s) to " << argv[2] << "\n";
+    return 0;
+}
+
+// hft_backtester feed <file.itch> [SYMBOL] [interval_ms]
+// Replays a binary feed through the order books and runs a strategy on bars
+// aggregated from its trades
+static int feed(int argc, char** argv) {
+    using namespace hft;
+    if (argc < 3) {
+        std::cerr << "usage: hft_backtester feed <file.itch> [SYMBOL] [interval_ms]\n";
+        return 1;
+    }
+    std::string path = argv[2];
+    std::string symbol = argc > 3 ? argv[3] : "";
+    std::int64_t interval_ms = argc > 4 ? std::stoll(argv[4]) : 1000;
+
+    // Decode and book-building throughput on their own
+    FeedReader reader(path);
+    if (!reader.is_open()) { std::cerr << "cannot open " << path << "\n"; return 1; }
+    BookReplay books;
+    auto t0 = std::chrono::steady_clock::now();
+    std::size_t events = reader.replay(books);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Replayed " << events << " events (" << reader.messages() << " messages, "
+              << reader.malformed() << " malformed" << (reader.truncated() ? ", truncated" : "") << ") in "
+              << secs << "s (" << (secs > 0 ? events / secs : 0) << " events/s)\n";
+    for (std::size_t s = 0; s < reader.symbols().size(); ++s) {
+        const LimitOrderBook* b = books.find((std::uint16_t)s);
+        if (!b || reader.symbol((std::uint16_t)s).empty()) continue;
+        std::cout << "  " << reader.symbol((std::uint16_t)s) << ": " << b->order_count() << " resting orders";
+        if (b->has_bid() && b->has_ask()) std::cout << ", " << b->best_bid() << " / " << b->best_ask();
+        std::cout << "\n";
+    }
+
+    FeedBarSource src(path, symbol, interval_ms);
+    if (src.locate() < 0) { std::cerr << "symbol " << symbol << " not in " << path << "\n"; return 1; }
+    MomentumStrategy mom(20, 1);
+    auto r = Backtester::run_stream(src, mom, CostModel{0.0, 1.0});
+    std::cout << "Momentum on " << src.reader().symbol((std::uint16_t)src.locate()) << " " << interval_ms
+              << "ms bars=" << r.bars << " Sharpe=" << r.sharpe << " FinalEquity=" << r.final_equity
+              << " MaxDD=" << r.max_dd << " Trades=" << r.num_trades << "\n";
+    return 0;
+}
+
+// Resolves the data argument: "synthetic", a .hftb bar store (mapped in
+// place, first symbol unless one is given) or a CSV file. Falls back to a
+// synthetic random walk when nothing could be loaded.
+static hft::BarView load_bars(const std::string& arg, const std::string& symbol,
+                              std::vector<hft::Bar>& bars, hft::BarStore& store) {
+    using namespace hft;
+    BarView view;
+    if (arg == "synthetic") {
+        bars = generate_random_walk(1000);
         std::cout << "Loaded synthetic dataset (random walk) with " << bars.size() << " bars.\n";
-    } else {
-        std::string csv = argc > 1 ? argv[1] : "data/sample.csv";
-        bars = DataLoader::load_csv(csv);
-        if (bars.empty()) {
-            bars = hft::generate_random_walk(1000);
-            std::cout << "Loaded synthetic dataset (fallback) with " << bars.size() << " bars.\n";
+        return BarView::of(bars);
+    }
+    if (ends_with(arg, ".hftb")) {
+        if (store.open(arg) && !store.symbols().empty()) {
+            std::string sym = symbol.empty() ? store.symbols().front() : symbol;
+            view = store.bars(sym);
+            std::cout << "Mapped " << sym << " from " << arg << " with " << view.size() << " bars.\n";
         }
+    } else {
+        bars = DataLoader::load_csv(arg);
+        view = BarView::of(bars);
     }
+    if (view.empty()) {
+        bars = generate_random_walk(1000);
+        std::cout << "Loaded synthetic dataset (fallback) with " << bars.size() << " bars.\n";
+        view = BarView::of(bars);
+    }
+    return view;
+}
 
-    CostModel costs{0.0, 1.0}; // lower costs for demo visibility
+// "from:to:step" or a single value
+static std::vector<double> parse_range(const std::string& s) {
+    double a = 0, b = 0, st = 1;
+    if (std::sscanf(s.c_str(), "%lf:%lf:%lf", &a, &b, &st) == 3) return hft::ParamGrid::range(a, b, st);
+    return {std::stod(s)};
+}
 
-    // Parameter sweep for momentum lookback
-    double best_sharpe = -1e9; int best_lb = 0; BacktestResult best_res{};
-    for (int lb = 5; lb <= 50; lb += 5) {
-        MomentumStrategy mom(lb, 1);
-        auto r = Backtester::run(bars, mom, costs, 1);
-        if (r.sharpe > best_sharpe) { best_sharpe = r.sharpe; best_lb = lb; best_res = r; }
+// Grid and factory for the --strategy / --lookback / --threshold / --qty options
+static void strategy_grid(const std::string& strategy, const std::string& lookback, const std::string& threshold,
+                          const std::string& qty, hft::ParamGrid& grid, hft::StrategyFactory& factory) {
+    using namespace hft;
+    if (strategy == "meanrev") {
+        grid.add("lookback", parse_range(lookback)).add("threshold", parse_range(threshold)).add("qty", parse_range(qty));
+        factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+            return std::unique_ptr<Strategy>(new MeanReversionStrategy((int)p[0], p[1], (int)p[2]));
+        };
+    } else {
+        grid.add("lookback", parse_range(lookback)).add("qty", parse_range(qty));
+        factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+            return std::unique_ptr<Strategy>(new MomentumStrategy((int)p[0], (int)p[1]));
+        };
     }
+}
+
+static hft::SweepMetric parse_metric(const std::string& v) {
+    using hft::SweepMetric;
+    return v == "equity" ? SweepMetric::FinalEquity : v == "drawdown" ? SweepMetric::MaxDrawdown : SweepMetric::Sharpe;
+}
+
+// hft_backtester sweep <data> [--strategy momentum|meanrev] [--lookback a:b:s]
+//     [--threshold a:b:s] [--qty a:b:s] [--metric sharpe|equity|drawdown]
+//     [--top K] [--threads N]
+static int sweep(int argc, char** argv) {
+    using namespace hft;
+    std::string data = argc > 2 ? argv[2] : "data/sample.csv";
+    std::string strategy = "momentum", lookback = "5:50:5", threshold = "0.001:0.01:0.001", qty = "1";
+    SweepConfig cfg;
+    cfg.costs = CostModel{0.0, 1.0};
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string k = argv[i], v = argv[i + 1];
+        if (k == "--strategy") strategy = v;
+        else if (k == "--lookback") lookback = v;
+        else if (k == "--threshold") threshold = v;
+        else if (k == "--qty") qty = v;
+        else if (k == "--top") cfg.top_k = std::stoul(v);
+        else if (k == "--threads") cfg.threads = std::stoul(v);
+        else if (k == "--metric") cfg.metric = parse_metric(v);
+        else { std::cerr << "unknown option " << k << "\n"; return 1; }
+    }
+
+    std::vector<Bar> bars;
+    BarStore store;
+    BarView view = load_bars(data, "", bars, store);
+
+    ParamGrid grid;
+    StrategyFactory factory;
+    strategy_grid(strategy, lookback, threshold, qty, grid, factory);
+
+    std::size_t threads = cfg.threads ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Sweeping " << grid.size() << " " << strategy << " combinations on " << threads << " threads...\n";
+    auto t0 = std::chrono::steady_clock::now();
+    // Momentum grids run batched: one pass over the bars per block of combinations
+    auto top = strategy == "meanrev" ? ParameterSweep::run(view, grid, factory, cfg)
+                                     : ParameterSweep::run_momentum(view, grid, cfg);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Done in " << secs << "s (" << (secs > 0 ? grid.size() * view.size() / secs : 0) << " bars/s)\n";
+
+    for (std::size_t r = 0; r < top.size(); ++r) {
+        const auto& e = top[r];
+        std::cout << "#" << (r + 1);
+        for (std::size_t d = 0; d < grid.dims(); ++d) std::cout << " " << grid.name(d) << "=" << e.params[d];
+        std::cout << " Sharpe=" << e.sharpe << " FinalEquity=" << e.final_equity
+                  << " MaxDD=" << e.drawdown << " Trades=" << e.num_trades << "\n";
+    }
+    return 0;
+}
+
+// hft_backtester walkforward <data> [--train N] [--test N] [--anchored 0|1]
+//     [--strategy momentum|meanrev] [--lookback a:b:s] [--threshold a:b:s]
+//     [--qty a:b:s] [--metric sharpe|equity|drawdown] [--threads N]
+// Out-of-sample alternative to picking the in-sample best of a sweep
+static int walkforward(int argc, char** argv) {
+    using namespace hft;
+    std::string data = argc > 2 ? argv[2] : "data/sample.csv";
+    std::string strategy = "momentum", lookback = "5:50:5", threshold = "0.001:0.01:0.001", qty = "1";
+    WalkForwardConfig cfg;
+    cfg.costs = CostModel{0.0, 1.0};
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string k = argv[i], v = argv[i + 1];
+        if (k == "--strategy") strategy = v;
+        else if (k == "--lookback") lookback = v;
+        else if (k == "--threshold") threshold = v;
+        else if (k == "--qty") qty = v;
+        else if (k == "--train") cfg.train_bars = std::stoul(v);
+        else if (k == "--test") cfg.test_bars = std::stoul(v);
+        else if (k == "--anchored") cfg.anchored = v != "0";
+        else if (k == "--threads") cfg.threads = std::stoul(v);
+        else if (k == "--metric") cfg.metric = parse_metric(v);
+        else { std::cerr << "unknown option " << k << "\n"; return 1; }
+    }
+
+    std::vector<Bar> bars;
+    BarStore store;
+    BarView view = load_bars(data, "", bars, store);
+    ParamGrid grid;
+    StrategyFactory factory;
+    strategy_grid(strategy, lookback, threshold, qty, grid, factory);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto wf = WalkForward::run(view, grid, factory, cfg);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Walk-forward: " << wf.folds.size() << " folds x " << grid.size() << " " << strategy
+              << " combinations in " << secs << "s\n";
+    for (std::size_t k = 0; k < wf.folds.size(); ++k) {
+        const auto& f = wf.folds[k];
+        std::cout << "fold " << k << " train [" << f.train_from << "," << f.train_to << ") test [" << f.test_from
+                  << "," << f.test_to << ")";
+        for (std::size_t d = 0; d < grid.dims() && d < f.params.size(); ++d) std::cout << " " << grid.name(d) << "=" << f.params[d];
+        std::cout << " in-sample=" << f.train_score << " oos_return=" << f.test_return
+                  << " oos_sharpe=" << f.test_sharpe << " trades=" << f.test_trades << "\n";
+    }
+    std::cout << "Out-of-sample: bars=" << wf.oos_equity.size() << " Sharpe=" << wf.oos_sharpe
+              << " Return=" << wf.oos_return << " MaxDD=" << wf.oos_max_dd << "\n";
+
+    std::ofstream out("results_walkforward_oos_equity.csv");
+    out << "ts,equity\n";
+    for (std::size_t i = 0; i < wf.oos_equity.size(); ++i) out << wf.oos_ts[i] << "," << wf.oos_equity[i] << "\n";
+    return 0;
+}
+
+// hft_backtester montecarlo [--paths N] [--bars N] [--model gbm|jump|garch]
+//     [--vol x] [--drift x] [--seed N] [--threads N]
+//     [--strategy momentum|meanrev] [--lookback N] [--threshold x] [--qty N]
+// Distribution of a strategy's metrics over simulated price paths
+static void print_dist(const char* name, const hft::MetricDistribution& d) {
+    std::cout << name << ": mean=" << d.mean << " sd=" << d.stdev << " min=" << d.min << " p5=" << d.p05
+              << " p50=" << d.p50 << " p95=" << d.p95 << " max=" << d.max << "\n";
+}
+
+static int montecarlo(int argc, char** argv) {
+    using namespace hft;
+    std::string strategy = "momentum", lookback = "20", threshold = "0.002", qty = "1", model = "gbm";
+    MonteCarloConfig cfg;
+    cfg.costs = CostModel{0.0, 1.0};
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string k = argv[i], v = argv[i + 1];
+        if (k == "--strategy") strategy = v;
+        else if (k == "--lookback") lookback = v;
+        else if (k == "--threshold") threshold = v;
+        else if (k == "--qty") qty = v;
+        else if (k == "--model") model = v;
+        else if (k == "--paths") cfg.paths = std::stoul(v);
+        else if (k == "--bars") cfg.spec.bars = std::stoi(v);
+        else if (k == "--vol") cfg.spec.vol = std::stod(v);
+        else if (k == "--drift") cfg.spec.drift = std::stod(v);
+        else if (k == "--seed") cfg.seed = std::stoull(v);
+        else if (k == "--threads") cfg.threads = std::stoul(v);
+        else { std::cerr << "unknown option " << k << "\n"; return 1; }
+    }
+    cfg.spec.model = model == "jump" ? PathModel::Jump : model == "garch" ? PathModel::Garch : PathModel::Gbm;
+
+    ParamGrid grid;
+    StrategyFactory make;
+    strategy_grid(strategy, lookback, threshold, qty, grid, make);
+    std::vector<double> params = grid.at(0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto mc = MonteCarlo::run([&] { return make(params); }, cfg);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Monte Carlo: " << mc.paths << " " << model << " paths x " << cfg.spec.bars << " bars, "
+              << strategy << ", seed " << cfg.seed << " in " << secs << "s\n";
+    print_dist("Sharpe", mc.sharpe);
+    print_dist("FinalEquity", mc.final_equity);
+    print_dist("MaxDD", mc.max_dd);
+    print_dist("Trades", mc.num_trades);
+    std::cout << "P(loss)=" << mc.prob_loss << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    using namespace hft;
+    if (argc > 1 && std::string(argv[1]) == "convert") return convert(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "stream") return stream(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "sweep") return sweep(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "walkforward") return walkforward(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "montecarlo") return montecarlo(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "makefeed") return makefeed(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "feed") return feed(argc, argv);
+
+    std::vector<Bar> bars;
+    BarStore store;
+    BarView view = load_bars(argc > 1 ? argv[1] : "data/sample.csv", argc > 2 ? argv[2] : "", bars, store);
+
+    CostModel costs{0.0, 1.0}; // lower costs for demo visibility
+
+    // Parameter sweep for momentum lookback; only the winner is re-run in full
+    ParamGrid grid;
+    grid.add("lookback", ParamGrid::range(5, 50, 5));
+    SweepConfig cfg;
+    cfg.top_k = 1;
+    cfg.costs = costs;
+    auto top = ParameterSweep::run_momentum(view, grid, cfg);
+    int best_lb = top.empty() ? 5 : (int)top[0].params[0];
+    MomentumStrategy best(best_lb, 1);
+    BacktestResult best_res = Backtester::run(view, best, costs, 1);
+    double best_sharpe = best_res.sharpe;
     std::cout << "Best Momentum LB=" << best_lb << " Sharpe=" << best_sharpe << " FinalEquity=" << best_res.final_equity << "\n";
     write_summary_csv("results_momentum_summary.csv", "Momentum_lb_" + std::to_string(best_lb), best_res);
     write_equity_csv("results_momentum_equity.csv", best_res.equity_curve);
 
     // Mean Reversion fixed params
     MeanReversionStrategy mr(20, 0.003, 1);
-    auto res_mr = Backtester::run(bars, mr, costs, 1);
+    auto res_mr = Backtester::run(view, mr, costs, 1);
     std::cout << "MeanReversion Sharpe=" << res_mr.sharpe << " FinalEquity=" << res_mr.final_equity << " MaxDD=" << res_mr.drawdown << "\n";
     write_summary_csv("results_meanrev_summary.csv", "MeanReversion", res_mr);
     write_equity_csv("results_meanrev_equity.csv", res_mr.equity_curve);
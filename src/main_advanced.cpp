@@ -3,6 +3,11 @@
 #include "data_loader.hpp"
 #include "advanced_backtester.hpp"
 #include "advanced_reports.hpp"
+#include "report_writer.hpp"
+#include "bar_store.hpp"
+#include "job_scheduler.hpp"
+#include "portfolio_backtester.hpp"
+#include "profiler.hpp"
 #include "strategies/momentum.hpp"
 #include "strategies/mean_reversion.hpp"
 #include "synthetic.hpp"
@@ -10,18 +15,53 @@
 int main(int argc, char** argv) {
     using namespace hft;
     
-    // Generate synthetic assets
     std::cout << "=== HFT BACKTESTER: ADVANCED DEMO ===\n\n";
     std::vector<std::string> assets = {"AAPL", "GOOGL", "MSFT"};
-    std::map<std::string, std::vector<Bar>> asset_data;
-    
-    std::cout << "Generating synthetic market data...\n";
-    for (const auto& asset : assets) {
-        // Each asset with different drift and volatility
-        double drift = (asset == "AAPL") ? 0.0005 : (asset == "GOOGL" ? 0.0008 : 0.0003);
-        double vol = (asset == "AAPL") ? 0.008 : (asset == "GOOGL" ? 0.012 : 0.006);
-        asset_data[asset] = generate_random_walk(1000, 100.0, drift, vol);
-        std::cout << "  " << asset << ": drift=" << drift << " vol=" << vol << "\n";
+    std::map<std::string, std::vector<Bar>> synthetic_data;
+    std::map<std::string, BarView> asset_data;
+
+    // hft_advanced [store.hftb] [--report csv|binary|both] [--pipeline]
+    // [--threads N]: run every symbol of a bar store in place; reports as
+    // CSV and/or columnar .hftc. Jobs run on a work-stealing pool (--threads
+    // also prints its utilization); --pipeline instead runs them one by one
+    // with decode, engine and result collection on separate pinned threads,
+    // the last one also streaming <job>_curve.csv, and prints stage
+    // counters. Results are the same either way.
+    std::string store_path;
+    ReportFormat fmt = ReportFormat::Csv;
+    bool pipelined = false;
+    SchedulerConfig sched_cfg;
+    bool show_sched = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--pipeline") {
+            pipelined = true;
+        } else if (a == "--threads" && i + 1 < argc) {
+            sched_cfg.threads = std::stoul(argv[++i]);
+            show_sched = true;
+        } else if (a == "--report" && i + 1 < argc) {
+            std::string v = argv[++i];
+            fmt = v == "binary" ? ReportFormat::Binary : v == "both" ? ReportFormat::Both : ReportFormat::Csv;
+        } else {
+            store_path = a;
+        }
+    }
+    BarStore store;
+    if (!store_path.empty() && store.open(store_path) && !store.symbols().empty()) {
+        assets = store.symbols();
+        std::cout << "Mapped " << assets.size() << " symbols from " << store_path << "\n";
+        for (const auto& asset : assets) asset_data[asset] = store.bars(asset);
+    } else {
+        // Generate synthetic assets
+        std::cout << "Generating synthetic market data...\n";
+        for (const auto& asset : assets) {
+            // Each asset with different drift and volatility
+            double drift = (asset == "AAPL") ? 0.0005 : (asset == "GOOGL" ? 0.0008 : 0.0003);
+            double vol = (asset == "AAPL") ? 0.008 : (asset == "GOOGL" ? 0.012 : 0.006);
+            synthetic_data[asset] = generate_random_walk(1000, 100.0, drift, vol);
+            asset_data[asset] = BarView::of(synthetic_data[asset]);
+            std::cout << "  " << asset << ": drift=" << drift << " vol=" << vol << "\n";
+        }
     }
     
     // Risk controls and order book
@@ -42,23 +82,57 @@ int main(int argc, char** argv) {
     costs.commission_per_share = 0.001;
     costs.slippage_bps = 0.5;
     
-    // Strategies
+    // Strategy prototypes; every job runs its own reset clone, so no state
+    // carries over from one asset to the next
     MomentumStrategy mom(30, 5);
     MeanReversionStrategy mr(20, 0.004, 3);
+    StrategyFactory momentum = clone_factory(mom);
+    StrategyFactory mean_reversion = clone_factory(mr);
+    std::vector<BacktestJob> jobs;
+    for (const auto& asset : assets) {
+        jobs.push_back({asset + "_MOM", asset, asset_data[asset], momentum, {}, costs, risk, lob});
+        jobs.push_back({asset + "_MR", asset, asset_data[asset], mean_reversion, {}, costs, risk, lob});
+    }
     
     // Run backtests
     std::cout << "\nRunning advanced backtests with LOB and risk controls...\n";
+    for (const auto& asset : assets) std::cout << "  Testing " << asset << "...\n";
+    std::vector<AssetBacktest> results;
+    std::vector<std::pair<std::string, std::vector<StageStats>>> stage_stats;
+    if (pipelined) {
+        PipelineOptions popt;
+        popt.pin = true;
+        for (const auto& job : jobs) {
+            auto strat = job.factory(job.params);
+            ViewBarSource src(job.bars);
+            popt.curve_path = job.name + "_curve.csv";
+            stage_stats.emplace_back(job.name, std::vector<StageStats>());
+            results.push_back(AdvancedBacktester::run_pipelined(job.name, src, *strat, job.costs, job.risk, job.lob,
+                                                                popt, &stage_stats.back().second));
+        }
+    } else {
+        // Work-stealing batch; results come back in job order
+        auto sched = JobScheduler::run(jobs, sched_cfg);
+        results = std::move(sched.results);
+        if (show_sched) {
+            std::cout << "  " << jobs.size() << " jobs on " << sched.workers.size() << " threads, "
+                      << std::fixed << std::setprecision(1) << 100.0 * sched.utilization() << "% busy\n";
+        }
+    }
     std::vector<AssetBacktest> results_mom, results_mr;
-    
-    for (const auto& asset : assets) {
-        std::cout << "  Testing " << asset << "...\n";
-        
-        auto res_m = AdvancedBacktester::run(asset + "_MOM", asset_data[asset], mom, costs, risk, lob);
-        results_mom.push_back(res_m);
-        
-        auto res_mr = AdvancedBacktester::run(asset + "_MR", asset_data[asset], mr, costs, risk, lob);
-        results_mr.push_back(res_mr);
+    for (std::size_t i = 0; i + 1 < results.size(); i += 2) {
+        results_mom.push_back(std::move(results[i]));
+        results_mr.push_back(std::move(results[i + 1]));
     }
+
+    // Reports are formatted and written in the background while the
+    // summaries print and the shared-book pass runs; the result vectors are
+    // not touched again until the queue drains, nor are the results flags
+    const char* report_bases[] = {"results_momentum", "results_meanreversion"};
+    bool report_ok[] = {false, false};
+    ReportQueue reports;
+    reports.submit([&] { report_ok[0] = write_advanced_report(report_bases[0], results_mom, fmt); });
+    reports.submit([&] { report_ok[1] = write_advanced_report(report_bases[1], results_mr, fmt); });
     
     // Report results
     std::cout << "\n=== MOMENTUM STRATEGY RESULTS ===\n";
@@ -111,18 +185,55 @@ int main(int argc, char** argv) {
     std::cout << "  Total P&L: $" << std::fixed << std::setprecision(2) << total_mr_return << "\n";
     std::cout << "  Total Trades: " << total_mr_trades << "\n";
     
+    // One pass over all assets with a shared cash book
+    std::vector<PortfolioAsset> universe;
+    for (const auto& asset : assets) universe.push_back({asset, asset_data[asset]});
+    PerSymbolStrategy per_symbol(universe.size(), mom);
+    PortfolioRisk prisk;
+    prisk.max_position = (int)risk.max_position;
+    prisk.max_daily_loss = risk.max_daily_loss;
+    auto port = PortfolioBacktester::run(universe, per_symbol, costs, prisk, lob);
+    std::cout << "Shared-Book Momentum (one merged pass):\n";
+    std::cout << "  Final Equity: $" << std::fixed << std::setprecision(2) << port.final_equity << "\n";
+    std::cout << "  Sharpe: " << std::setprecision(4) << port.sharpe
+              << "  MaxDD: " << std::setprecision(6) << port.max_dd << "\n";
+    std::cout << "  Events: " << port.events << "  Trades: " << port.num_trades
+              << "  Rejected: " << port.rejected << "\n";
+    
     // Write reports
     std::cout << "\nWriting advanced reports...\n";
-    write_advanced_report("results_momentum", results_mom);
-    write_advanced_report("results_meanreversion", results_mr);
+    reports.wait();
+    int status = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (!report_ok[i]) { std::cerr << "cannot write " << report_bases[i] << " reports\n"; status = 1; }
+    }
     
     std::cout << "Done. Reports written:\n";
-    std::cout << "  results_momentum_summary.csv\n";
-    std::cout << "  results_momentum_details.csv\n";
-    std::cout << "  results_momentum_equity.csv\n";
-    std::cout << "  results_meanreversion_summary.csv\n";
-    std::cout << "  results_meanreversion_details.csv\n";
-    std::cout << "  results_meanreversion_equity.csv\n";
+    for (int i = 0; i < 2; ++i) {
+        if (!report_ok[i]) continue;
+        const char* base = report_bases[i];
+        if (fmt != ReportFormat::Binary) {
+            std::cout << "  " << base << "_summary.csv\n";
+            std::cout << "  " << base << "_details.csv\n";
+            std::cout << "  " << base << "_equity.csv\n";
+        }
+        if (fmt != ReportFormat::Csv) std::cout << "  " << base << ".hftc\n";
+    }
+
+    if (pipelined) {
+        std::cout << "\nPipeline stages:\n";
+        for (const auto& s : stage_stats) {
+            std::cout << s.first << "\n";
+            print_stage_stats(std::cout, s.second);
+        }
+    }
+
+    if (prof::kEnabled) {
+        std::cout << "\nProfile (HFT_PROFILE build):\n" << std::flush;
+        prof::print_summary(stdout);
+        if (prof::write_chrome_trace("hft_advanced_trace.json"))
+            std::cout << "  hft_advanced_trace.json\n";
+    }
     
-    return 0;
+    return status;
 }
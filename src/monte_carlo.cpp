@@ -0,0 +1,128 @@
+#include "monte_carlo.hpp"
+#include "backtester.hpp"
+#include "online_stats.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace hft {
+
+namespace {
+
+// Counter words: bar index, draw slot, path index (64-bit)
+enum Slot : std::uint32_t { kShock = 0, kJumpSize = 1, kJumpHit = 2 };
+
+inline Philox4x32::Block draw(const Philox4x32::Key& key, std::size_t bar, Slot slot, std::uint64_t path) {
+    return Philox4x32::block({(std::uint32_t)bar, slot, (std::uint32_t)path, (std::uint32_t)(path >> 32)}, key);
+}
+
+MetricDistribution summarize(std::vector<double>& v) {
+    MetricDistribution d;
+    if (v.empty()) return d;
+    RunningMoments m;
+    for (double x : v) m.add(x);
+    d.mean = m.mean;
+    d.stdev = m.stdev();
+    std::sort(v.begin(), v.end());
+    auto q = [&](double p) { return v[(std::size_t)std::lround(p * (double)(v.size() - 1))]; };
+    d.min = v.front();
+    d.p05 = q(0.05);
+    d.p50 = q(0.50);
+    d.p95 = q(0.95);
+    d.max = v.back();
+    return d;
+}
+
+}
+
+PathBarSource::PathBarSource(const PathSpec& spec, std::uint64_t seed, std::uint64_t path)
+    : spec_(spec), key_(Philox4x32::key_of(seed)), path_(path), price_(spec.start),
+      var_(spec.vol * spec.vol), eps2_(spec.vol * spec.vol) {}
+
+std::size_t PathBarSource::next(Bar* out, std::size_t max) {
+    std::size_t total = spec_.bars > 0 ? (std::size_t)spec_.bars : 0;
+    std::size_t m = std::min(max, total - std::min(total, bar_));
+    if (m == 0) return 0;
+    blocks_.resize(m);
+    z_.resize(m);
+    zv_.resize(m);
+    // Counters first (independent, vectorizable), then the transforms, then
+    // the sequential price recursion
+    for (std::size_t i = 0; i < m; ++i) blocks_[i] = draw(key_, bar_ + i, kShock, path_);
+    for (std::size_t i = 0; i < m; ++i) Philox4x32::to_normals(blocks_[i], z_[i], zv_[i]);
+
+    const double vol2 = spec_.vol * spec_.vol;
+    const double omega = vol2 * std::max(0.0, 1.0 - spec_.garch_alpha - spec_.garch_beta);
+    for (std::size_t i = 0; i < m; ++i) {
+        std::size_t k = bar_ + i;
+        double var = vol2;
+        if (spec_.model == PathModel::Garch) {
+            if (k > 0) var_ = omega + spec_.garch_alpha * eps2_ + spec_.garch_beta * var_;
+            var = var_;
+        }
+        double eps = std::sqrt(var) * z_[i];
+        eps2_ = eps * eps;
+        double lr = spec_.drift - 0.5 * var + eps;
+        if (spec_.model == PathModel::Jump) {
+            Philox4x32::Block hit = draw(key_, k, kJumpHit, path_);
+            if (Philox4x32::to_uniform(hit[0], hit[1]) < spec_.jump_prob) {
+                double zj, unused;
+                Philox4x32::to_normals(draw(key_, k, kJumpSize, path_), zj, unused);
+                lr += spec_.jump_mean + spec_.jump_vol * zj;
+            }
+        }
+        double close = price_ * std::exp(lr);
+        double high = std::max(price_, close) * (1.0 + 0.001);
+        double low = std::min(price_, close) * (1.0 - 0.001);
+        double volu = 10000 + 1000 * std::abs(zv_[i]);
+        out[i] = {spec_.ts0 + (std::int64_t)k * spec_.dt_ms, price_, high, low, close, volu};
+        price_ = close;
+    }
+    bar_ += m;
+    return m;
+}
+
+MonteCarloResult MonteCarlo::run(const PathStrategyFactory& factory, const MonteCarloConfig& cfg) {
+    MonteCarloResult res;
+    std::size_t n = cfg.paths;
+    std::vector<StreamResult> runs(n);
+    std::vector<char> ok(n, 0);
+
+    ThreadPool pool(cfg.threads);
+    StreamOptions opt;
+    opt.chunk_bars = std::max<std::size_t>(1, cfg.chunk_bars);
+    // Per-path results land in their own slots, so aggregation below runs in
+    // path order whatever the schedule was
+    pool.parallel_for(n, [&](std::size_t p, std::size_t) {
+        auto strat = factory();
+        if (!strat) return;
+        PathBarSource src(cfg.spec, cfg.seed, p);
+        runs[p] = Backtester::run_stream(src, *strat, cfg.costs, opt);
+        ok[p] = 1;
+    });
+
+    // Paths whose strategy could not be built are dropped
+    std::vector<double> sharpe, equity, dd, trades;
+    std::size_t losses = 0;
+    double cash = StrategyContext{}.cash;
+    for (std::size_t p = 0; p < n; ++p) {
+        if (!ok[p]) continue;
+        const StreamResult& r = runs[p];
+        sharpe.push_back(r.sharpe);
+        equity.push_back(r.final_equity);
+        dd.push_back(r.max_dd);
+        trades.push_back((double)r.num_trades);
+        if (r.final_equity < cash) ++losses;
+        res.pooled.merge(r.metrics);
+    }
+    std::size_t kept = sharpe.size();
+    res.paths = kept;
+    res.prob_loss = kept ? (double)losses / (double)kept : 0.0;
+    res.sharpe = summarize(sharpe);
+    res.final_equity = summarize(equity);
+    res.max_dd = summarize(dd);
+    res.num_trades = summarize(trades);
+    return res;
+}
+
+}
@@ -0,0 +1,120 @@
+#include "parameter_sweep.hpp"
+#include "backtester.hpp"
+#include "batch_momentum.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace hft {
+
+namespace {
+
+bool better(const SweepEntry& a, const SweepEntry& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.index < b.index;
+}
+
+double score_of(const StreamResult& r, SweepMetric m) {
+    switch (m) {
+        case SweepMetric::FinalEquity: return r.final_equity;
+        case SweepMetric::MaxDrawdown: return -r.max_dd;
+        default: return r.sharpe;
+    }
+}
+
+// Keeps the best k entries in a bounded heap (worst on top)
+void offer(std::vector<SweepEntry>& h, SweepEntry&& e, std::size_t k) {
+    if (h.size() < k) {
+        h.push_back(std::move(e));
+        std::push_heap(h.begin(), h.end(), better);
+    } else if (better(e, h.front())) {
+        std::pop_heap(h.begin(), h.end(), better);
+        h.back() = std::move(e);
+        std::push_heap(h.begin(), h.end(), better);
+    }
+}
+
+std::vector<SweepEntry> merge_top(std::vector<std::vector<SweepEntry>>& heaps, std::size_t k) {
+    std::vector<SweepEntry> out;
+    for (auto& h : heaps) for (auto& e : h) out.push_back(std::move(e));
+    std::sort(out.begin(), out.end(), better);
+    if (out.size() > k) out.resize(k);
+    return out;
+}
+
+void fill_entry(SweepEntry& e, const StreamResult& r, SweepMetric m) {
+    e.score = score_of(r, m);
+    e.sharpe = r.sharpe;
+    e.drawdown = r.max_dd;
+    e.final_equity = r.final_equity;
+    e.num_trades = r.num_trades;
+}
+
+}
+
+std::vector<SweepEntry> ParameterSweep::run(const BarView& bars, const ParamGrid& grid,
+                                            const StrategyFactory& factory, const SweepConfig& cfg) {
+    std::size_t n = grid.size();
+    std::size_t k = std::max<std::size_t>(1, cfg.top_k);
+    ThreadPool pool(cfg.threads);
+
+    // Each worker keeps its own bounded heap (worst entry on top), so a
+    // new best only costs a summary insert, never a copy of a full result.
+    std::vector<std::vector<SweepEntry>> heaps(pool.size());
+    for (auto& h : heaps) h.reserve(k + 1);
+
+    pool.parallel_for(n, [&](std::size_t idx, std::size_t worker) {
+        SweepEntry e;
+        e.index = idx;
+        grid.at(idx, e.params);
+        auto strat = factory(e.params);
+        if (!strat) return;
+        ViewBarSource src(bars);
+        StreamResult r = Backtester::run_stream(src, *strat, cfg.costs);
+        fill_entry(e, r, cfg.metric);
+        offer(heaps[worker], std::move(e), k);
+    });
+    return merge_top(heaps, k);
+}
+
+std::vector<SweepEntry> ParameterSweep::run_momentum(const BarView& bars, const ParamGrid& grid,
+                                                     const SweepConfig& cfg) {
+    std::size_t lb_dim = grid.dims(), qty_dim = grid.dims();
+    for (std::size_t d = 0; d < grid.dims(); ++d) {
+        if (grid.name(d) == "lookback") lb_dim = d;
+        else if (grid.name(d) == "qty") qty_dim = d;
+    }
+    if (lb_dim == grid.dims()) return {};
+
+    std::size_t n = grid.size();
+    std::size_t k = std::max<std::size_t>(1, cfg.top_k);
+    ThreadPool pool(cfg.threads);
+    std::vector<std::vector<SweepEntry>> heaps(pool.size());
+    for (auto& h : heaps) h.reserve(k + 1);
+
+    // Blocks of up to 256 combinations, at least one per worker
+    std::size_t block = std::min<std::size_t>(256, (n + pool.size() - 1) / pool.size());
+    block = std::max<std::size_t>(4, (block + 3) / 4 * 4);
+    std::size_t blocks = (n + block - 1) / block;
+
+    pool.parallel_for(blocks, [&](std::size_t b, std::size_t worker) {
+        std::size_t from = b * block, to = std::min(n, from + block);
+        std::vector<std::vector<double>> params(to - from);
+        std::vector<MomentumParams> mp(to - from);
+        for (std::size_t i = from; i < to; ++i) {
+            grid.at(i, params[i - from]);
+            mp[i - from].lookback = (int)params[i - from][lb_dim];
+            mp[i - from].qty = qty_dim < grid.dims() ? (int)params[i - from][qty_dim] : 1;
+        }
+        auto res = BatchMomentum::run(bars, mp, cfg.costs);
+        for (std::size_t i = from; i < to; ++i) {
+            SweepEntry e;
+            e.index = i;
+            e.params = std::move(params[i - from]);
+            fill_entry(e, res[i - from], cfg.metric);
+            offer(heaps[worker], std::move(e), k);
+        }
+    });
+    return merge_top(heaps, k);
+}
+
+}
@@ -0,0 +1,51 @@
+#include "pipeline.hpp"
+#include <iomanip>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hft {
+
+bool pin_current_thread(int core) {
+    unsigned n = std::thread::hardware_concurrency();
+    if (core < 0 || n == 0) return false;
+    core %= (int)n;
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+void print_stage_stats(std::ostream& os, const std::vector<StageStats>& stages) {
+    auto flags = os.flags();
+    auto prec = os.precision();
+    os << std::left << std::setw(10) << "Stage" << std::right
+       << std::setw(12) << "Items" << std::setw(10) << "Batches"
+       << std::setw(12) << "Mitems/s" << std::setw(10) << "Wait%"
+       << std::setw(10) << "Stalls" << std::setw(12) << "QueueAvg" << std::setw(10) << "QueueMax" << "\n";
+    for (const auto& s : stages) {
+        double wait = s.seconds > 0 ? 100.0 * s.wait_seconds / s.seconds : 0.0;
+        os << std::left << std::setw(10) << s.name << std::right
+           << std::setw(12) << s.items << std::setw(10) << s.batches
+           << std::setw(12) << std::fixed << std::setprecision(2) << s.throughput() / 1e6
+           << std::setw(10) << std::setprecision(1) << wait
+           << std::setw(10) << s.stalls
+           << std::setw(12) << std::setprecision(1) << s.queue_avg << std::setw(10) << s.queue_max << "\n";
+    }
+    os.flags(flags);
+    os.precision(prec);
+}
+
+}
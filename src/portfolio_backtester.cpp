@@ -0,0 +1,262 @@
+#include "portfolio_backtester.hpp"
+#include "bar_store.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace hft {
+
+PerSymbolStrategy::PerSymbolStrategy(std::size_t num_symbols, const Factory& make) {
+    scratch_.reserve(kScratchTrades);
+    strats_.reserve(num_symbols);
+    for (std::size_t i = 0; i < num_symbols; ++i) strats_.push_back(make(i));
+}
+
+PerSymbolStrategy::PerSymbolStrategy(std::size_t num_symbols, const Strategy& prototype) {
+    scratch_.reserve(kScratchTrades);
+    strats_.reserve(num_symbols);
+    for (std::size_t i = 0; i < num_symbols; ++i) {
+        strats_.push_back(prototype.clone());
+        strats_.back()->reset();
+    }
+}
+
+void PerSymbolStrategy::on_bar(std::size_t sym, const Bar& bar, const PortfolioBook& book, std::vector<PortfolioFill>& orders) {
+    Strategy* s = sym < strats_.size() ? strats_[sym].get() : nullptr;
+    if (!s) return;
+    StrategyContext ctx;
+    ctx.cash = book.cash();
+    ctx.position = book.position(sym);
+    scratch_.clear();
+    s->on_bar(bar, ctx, scratch_);
+    for (const Trade& t : scratch_) orders.push_back({(std::uint32_t)sym, t});
+}
+
+// Applies fills and risk to the shared book
+class PortfolioEngine {
+public:
+    PortfolioEngine(PortfolioBook& book, std::size_t n, double cash, const CostModel& costs,
+                    const PortfolioRisk& risk, const OrderBook& lob)
+        : book_(book), costs_(costs), risk_(risk), lob_(lob) {
+        book_.cash_ = cash;
+        book_.pos_.assign(n, 0);
+        book_.last_.assign(n, 0.0);
+        priced_.assign(n, 0);
+    }
+
+    // Rolls the daily loss window and marks sym to its new close
+    void begin(std::size_t sym, std::int64_t ts, double close) {
+        std::int64_t day = barstore::day_of(ts);
+        if (!has_day_ || day != day_) {
+            has_day_ = true;
+            day_ = day;
+            halted_ = false;
+            day_open_ = book_.equity();
+        }
+        int p = book_.pos_[sym];
+        double move = close - book_.last_[sym];
+        if (p) {
+            book_.mv_ += p * move;
+            book_.gross_ += std::abs(p) * move;
+        }
+        book_.last_[sym] = close;
+        priced_[sym] = 1;
+    }
+
+    // Fills t at the book price for sym's latest close; false if risk
+    // refuses it or sym has no price yet
+    bool fill(std::size_t sym, Trade& t) {
+        if (halted_ || t.quantity == 0 || sym >= priced_.size() || !priced_[sym]) return false;
+        double close = book_.last_[sym];
+        int p = book_.pos_[sym];
+        int np = p + t.quantity;
+        if (std::abs(np) > risk_.max_position) return false;
+        double dg = (std::abs(np) - std::abs(p)) * close;
+        if (dg > 0 && book_.gross_ + dg > risk_.max_gross_exposure) return false;
+
+        double px = lob_.get_fill_price(close, t.quantity, t.quantity > 0);
+        book_.cash_ -= t.quantity * px + costs_.cost(px, t.quantity);
+        book_.pos_[sym] = np;
+        book_.mv_ += t.quantity * close;
+        book_.gross_ += dg;
+        t.entry_price = px;
+        return true;
+    }
+
+    // Flattens everything at the last closes once the day's loss limit is hit
+    bool check_daily_loss() {
+        if (halted_ || book_.equity() >= day_open_ - risk_.max_daily_loss) return false;
+        for (std::size_t i = 0; i < book_.pos_.size(); ++i) {
+            book_.cash_ += book_.pos_[i] * book_.last_[i];
+            book_.pos_[i] = 0;
+        }
+        book_.mv_ = 0;
+        book_.gross_ = 0;
+        halted_ = true;
+        return true;
+    }
+
+private:
+    PortfolioBook& book_;
+    const CostModel& costs_;
+    const PortfolioRisk& risk_;
+    const OrderBook& lob_;
+    std::int64_t day_ = 0;
+    bool has_day_ = false;
+    bool halted_ = false;
+    double day_open_ = 0;
+    std::vector<char> priced_; // symbol has had a bar
+};
+
+namespace {
+
+// Tournament (loser) tree over each symbol's next timestamp. Replacing the
+// winner replays a single leaf-to-root path: log2(k) comparisons, against
+// two per level for a binary heap. Nodes carry their key so the replay
+// touches only the path. Ties go to the lower symbol index.
+class LoserTree {
+public:
+    explicit LoserTree(std::size_t k) {
+        while (cap_ < k) cap_ <<= 1;
+        done_.assign(cap_, 1);
+        node_.assign(cap_, Entry{kEnd, 0});
+        leaf_.resize(cap_);
+        for (std::uint32_t l = 0; l < cap_; ++l) leaf_[l] = {kEnd, l};
+    }
+
+    void set(std::uint32_t leaf, std::int64_t ts) { leaf_[leaf].ts = ts; done_[leaf] = 0; }
+    void finish(std::uint32_t leaf) { leaf_[leaf].ts = kEnd; done_[leaf] = 1; }
+
+    void build() {
+        std::vector<Entry> win(2 * cap_);
+        for (std::uint32_t l = 0; l < cap_; ++l) win[cap_ + l] = leaf_[l];
+        for (std::size_t n = cap_ - 1; n >= 1; --n) {
+            const Entry& a = win[2 * n];
+            const Entry& b = win[2 * n + 1];
+            bool aw = beats(a, b);
+            node_[n] = aw ? b : a;
+            win[n] = aw ? a : b;
+        }
+        node_[0] = win[1];
+    }
+
+    bool empty() const { return done_[node_[0].leaf] != 0; }
+    std::uint32_t top() const { return node_[0].leaf; }
+    std::int64_t top_ts() const { return node_[0].ts; }
+
+    // Re-seats leaf (the previous winner) after set() or finish()
+    void replay(std::uint32_t leaf) {
+        Entry cur = leaf_[leaf];
+        for (std::size_t n = (cap_ + leaf) >> 1; n >= 1; n >>= 1) {
+            if (beats(node_[n], cur)) std::swap(node_[n], cur);
+        }
+        node_[0] = cur;
+    }
+
+private:
+    struct Entry {
+        std::int64_t ts;
+        std::uint32_t leaf;
+    };
+    static constexpr std::int64_t kEnd = INT64_MAX; // retired leaves
+
+    bool beats(const Entry& a, const Entry& b) const {
+        if (a.ts != b.ts) return a.ts < b.ts;
+        // Only a bar stamped INT64_MAX can tie with a retired leaf
+        if (done_[a.leaf] != done_[b.leaf]) return !done_[a.leaf];
+        return a.leaf < b.leaf;
+    }
+
+    std::size_t cap_ = 1;
+    std::vector<char> done_;
+    std::vector<Entry> leaf_;
+    std::vector<Entry> node_; // [0] winner, [1, cap) losers
+};
+
+}
+
+PortfolioResult PortfolioBacktester::run(const std::vector<PortfolioAsset>& assets,
+                                         PortfolioStrategy& strat,
+                                         const CostModel& costs,
+                                         const PortfolioRisk& risk,
+                                         const OrderBook& lob,
+                                         const PortfolioOptions& opt) {
+    auto t0 = std::chrono::steady_clock::now();
+    PortfolioResult res;
+    std::size_t k = assets.size();
+    PortfolioBook book;
+    PortfolioEngine eng(book, k, opt.initial_cash, costs, risk, lob);
+
+    std::vector<BarView> views(k);
+    std::vector<std::size_t> cursor(k, 0);
+    std::vector<std::size_t> sym_trades(k, 0);
+    LoserTree tree(k);
+    std::size_t longest = 0, total = 0;
+    for (std::size_t i = 0; i < k; ++i) {
+        views[i] = assets[i].bars;
+        longest = std::max(longest, views[i].size());
+        total += views[i].size();
+        if (!views[i].empty()) tree.set((std::uint32_t)i, views[i].ts(0));
+    }
+    tree.build();
+
+    std::vector<PortfolioFill> orders;
+    orders.reserve(kScratchTrades);
+    if (opt.keep_trades) res.trades.reserve(total);
+
+    while (!tree.empty()) {
+        std::uint32_t s = tree.top();
+        const BarView& v = views[s];
+        std::size_t c = cursor[s]++;
+        const Bar b = v[c];
+
+        eng.begin(s, b.ts, b.close);
+        orders.clear();
+        strat.on_bar(s, b, book, orders);
+        for (auto& o : orders) {
+            if (!eng.fill(o.symbol, o.trade)) { ++res.rejected; continue; }
+            ++sym_trades[o.symbol];
+            if (opt.keep_trades) res.trades.push_back(o);
+        }
+        if (eng.check_daily_loss()) ++res.liquidations;
+        ++res.events;
+
+        // Feed this symbol's next bar (or retire it) back into the tree
+        // Warm the row after next, which will be needed after k-1 other events
+        if (c + 2 < v.size()) v.prefetch(c + 2);
+        if (c + 1 < v.size()) tree.set(s, v.ts(c + 1));
+        else tree.finish(s);
+        tree.replay(s);
+
+        // Portfolio equity is sampled once all bars of a timestamp are in
+        if (tree.empty() || tree.top_ts() != b.ts) {
+            double eq = book.equity();
+            res.metrics.add(eq);
+            if (opt.keep_curve) {
+                // At least one point per bar of the longest series
+                if (res.curve_ts.empty()) { res.curve_ts.reserve(longest); res.equity_curve.reserve(longest); }
+                res.curve_ts.push_back(b.ts);
+                res.equity_curve.push_back(eq);
+            }
+        }
+    }
+
+    trim_trades(res.trades);
+    res.symbols.resize(k);
+    for (std::size_t i = 0; i < k; ++i) {
+        res.symbols[i].name = assets[i].name;
+        res.symbols[i].position = book.position(i);
+        res.symbols[i].last_close = book.last_close(i);
+        res.symbols[i].num_trades = sym_trades[i];
+        res.num_trades += sym_trades[i];
+    }
+    res.sharpe = res.metrics.sharpe(252.0);
+    res.max_dd = res.metrics.max_drawdown();
+    res.final_equity = book.equity();
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return res;
+}
+
+}
@@ -0,0 +1,216 @@
+#include "profiler.hpp"
+#include "report_writer.hpp"
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace hft {
+namespace prof {
+
+namespace {
+
+struct Registry {
+    std::mutex mu;
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+    std::size_t trace_capacity = 1 << 16;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+std::size_t round_pow2(std::size_t n) {
+    if (n == 0) return 0;
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+}
+
+const char* phase_name(Phase p) {
+    switch (p) {
+    case Phase::Run: return "run";
+    case Phase::Strategy: return "strategy";
+    case Phase::Risk: return "risk";
+    case Phase::Fill: return "fill";
+    case Phase::Cost: return "cost";
+    case Phase::MarkToMarket: return "mark_to_market";
+    default: return "unknown";
+    }
+}
+
+double ns_per_tick() {
+#ifdef HFT_PROF_TSC
+    // ~10ms against steady_clock; the invariant TSC runs at a fixed rate
+    static const double ratio = [] {
+        using clk = std::chrono::steady_clock;
+        auto c0 = clk::now();
+        std::uint64_t t0 = ticks();
+        clk::time_point c1;
+        do { c1 = clk::now(); } while (c1 - c0 < std::chrono::milliseconds(10));
+        std::uint64_t t1 = ticks();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(c1 - c0).count();
+        return t1 > t0 ? ns / (double)(t1 - t0) : 1.0;
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& o) {
+    if (o.count_ == 0) return;
+    for (std::size_t i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+    count_ += o.count_;
+    sum_ += o.sum_;
+    if (o.min_ < min_) min_ = o.min_;
+    if (o.max_ > max_) max_ = o.max_;
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) return 0;
+    if (p <= 0) return min();
+    if (p >= 1) return max_;
+    std::uint64_t rank = (std::uint64_t)(p * (double)count_);
+    if (rank >= count_) rank = count_ - 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += counts_[i];
+        if (seen > rank) {
+            std::uint64_t v = lower_bound(i) + width(i) / 2;
+            if (v < min_) v = min_;
+            if (v > max_) v = max_;
+            return v;
+        }
+    }
+    return max_;
+}
+
+ThreadLog::ThreadLog(std::size_t id, std::size_t trace_capacity) : id_(id) {
+    reset(trace_capacity);
+}
+
+void ThreadLog::reset(std::size_t trace_capacity) {
+    for (auto& h : hist_) h.reset();
+    std::size_t cap = round_pow2(trace_capacity);
+    trace_.assign(cap, TraceEvent{0, 0, Phase::Run});
+    mask_ = cap ? cap - 1 : 0;
+    next_ = 0;
+}
+
+std::vector<TraceEvent> ThreadLog::events() const {
+    std::vector<TraceEvent> out;
+    std::uint64_t n = next_ < trace_.size() ? next_ : trace_.size();
+    out.reserve((std::size_t)n);
+    for (std::uint64_t i = next_ - n; i < next_; ++i) out.push_back(trace_[i & mask_]);
+    return out;
+}
+
+ThreadLog* register_thread() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    r.logs.emplace_back(new ThreadLog(r.logs.size(), r.trace_capacity));
+    return r.logs.back().get();
+}
+
+void set_trace_capacity(std::size_t events) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    r.trace_capacity = events;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    for (auto& log : r.logs) log->reset(r.trace_capacity);
+}
+
+LatencyHistogram histogram(Phase p) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    LatencyHistogram h;
+    for (auto& log : r.logs) h.merge(log->histogram(p));
+    return h;
+}
+
+std::vector<PhaseStats> summary() {
+    double scale = ns_per_tick();
+    std::vector<PhaseStats> out;
+    for (std::size_t i = 0; i < kPhases; ++i) {
+        Phase p = (Phase)i;
+        LatencyHistogram h = histogram(p);
+        if (h.count() == 0) continue;
+        PhaseStats s;
+        s.phase = p;
+        s.name = phase_name(p);
+        s.count = h.count();
+        s.mean_ns = h.mean() * scale;
+        s.total_ns = s.mean_ns * (double)h.count();
+        s.p50_ns = (double)h.percentile(0.50) * scale;
+        s.p90_ns = (double)h.percentile(0.90) * scale;
+        s.p99_ns = (double)h.percentile(0.99) * scale;
+        s.max_ns = (double)h.max() * scale;
+        out.push_back(s);
+    }
+    return out;
+}
+
+void print_summary(std::FILE* out) {
+    auto stats = summary();
+    if (stats.empty()) return;
+    std::fprintf(out, "%-16s %12s %12s %10s %10s %10s %10s %12s\n",
+                 "phase", "count", "total_ms", "mean_ns", "p50_ns", "p90_ns", "p99_ns", "max_ns");
+    for (const auto& s : stats) {
+        std::fprintf(out, "%-16s %12llu %12.3f %10.1f %10.1f %10.1f %10.1f %12.1f\n",
+                     s.name, (unsigned long long)s.count, s.total_ns / 1e6, s.mean_ns,
+                     s.p50_ns, s.p90_ns, s.p99_ns, s.max_ns);
+    }
+}
+
+bool write_chrome_trace(const std::string& path) {
+    BufferedWriter w(path);
+    if (!w.is_open()) return false;
+    double us = ns_per_tick() / 1000.0;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    // Timestamps relative to the earliest retained event
+    std::vector<std::vector<TraceEvent>> per_thread;
+    std::uint64_t origin = ~(std::uint64_t)0;
+    for (auto& log : r.logs) {
+        per_thread.push_back(log->events());
+        // Recorded in end order, so an enclosing scope comes after its children
+        for (const auto& e : per_thread.back())
+            if (e.start < origin) origin = e.start;
+    }
+
+    w.text("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    for (std::size_t t = 0; t < per_thread.size(); ++t) {
+        if (!first) w.put(',');
+        first = false;
+        w.text("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        w.integer((std::int64_t)t);
+        w.text(",\"args\":{\"name\":\"thread ");
+        w.integer((std::int64_t)t);
+        w.text("\"}}");
+        for (const auto& e : per_thread[t]) {
+            w.text(",\n{\"name\":\"");
+            w.text(phase_name(e.phase));
+            w.text("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            w.integer((std::int64_t)t);
+            w.text(",\"ts\":");
+            w.real((double)(e.start - origin) * us);
+            w.text(",\"dur\":");
+            w.real((double)e.dur * us);
+            w.put('}');
+        }
+    }
+    w.text("\n]}\n");
+    return w.close();
+}
+
+}
+}
@@ -0,0 +1,231 @@
+#include "report_writer.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace hft {
+
+char* format_real(char* out, double v) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // Plain notation over the range reports live in (100000 rather than
+    // 1e+05), still shortest round-trip; at most 25 chars there
+    double a = v < 0 ? -v : v;
+    if (a == 0 || (a >= 1e-5 && a < 1e16)) {
+        auto r = std::to_chars(out, out + kMaxNumberChars, v, std::chars_format::fixed);
+        if (r.ec == std::errc()) return r.ptr;
+    }
+    return std::to_chars(out, out + kMaxNumberChars, v).ptr;
+#else
+    int n = std::snprintf(out, kMaxNumberChars, "%.17g", v);
+    return out + (n > 0 ? n : 0);
+#endif
+}
+
+char* format_integer(char* out, std::int64_t v) {
+    // Digits backwards into a scratch area, then copied into place
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    std::uint64_t u = v < 0 ? 0 - (std::uint64_t)v : (std::uint64_t)v;
+    do { *--p = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) *--p = '-';
+    std::size_t n = (std::size_t)(tmp + sizeof(tmp) - p);
+    std::memcpy(out, p, n);
+    return out + n;
+}
+
+BufferedWriter::BufferedWriter(const std::string& path, std::size_t buffer_bytes)
+    : buf_(buffer_bytes < 4 * kMaxNumberChars ? 4 * kMaxNumberChars : buffer_bytes) {
+    f_ = std::fopen(path.c_str(), "wb");
+    // We do our own buffering
+    if (f_) std::setvbuf(f_, nullptr, _IONBF, 0);
+}
+
+void BufferedWriter::flush_buffer() {
+    if (pos_ && f_ && std::fwrite(buf_.data(), 1, pos_, f_) != pos_) failed_ = true;
+    pos_ = 0;
+}
+
+void BufferedWriter::write(const void* data, std::size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n) {
+        if (pos_ == buf_.size()) flush_buffer();
+        std::size_t k = std::min(n, buf_.size() - pos_);
+        std::memcpy(buf_.data() + pos_, p, k);
+        pos_ += k;
+        p += k;
+        n -= k;
+    }
+}
+
+void BufferedWriter::text(const char* s) { write(s, std::strlen(s)); }
+
+bool BufferedWriter::close() {
+    if (!f_) return false;
+    flush_buffer();
+    if (std::fclose(f_) != 0) failed_ = true;
+    f_ = nullptr;
+    return !failed_;
+}
+
+namespace {
+
+constexpr char kMagic[4] = {'H', 'F', 'T', 'C'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderBytes = 16;
+constexpr std::size_t kEntryBytes = 32;
+
+std::size_t pad8(std::size_t n) { return (n + 7) & ~(std::size_t)7; }
+
+template <class T>
+void put_le(BufferedWriter& w, T v) {
+    unsigned char b[sizeof(T)];
+    for (std::size_t i = 0; i < sizeof(T); ++i) b[i] = (unsigned char)((std::uint64_t)v >> (8 * i));
+    w.write(b, sizeof(T));
+}
+
+template <class T>
+T get_le(const char* p) {
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) v |= (std::uint64_t)(unsigned char)p[i] << (8 * i);
+    return (T)v;
+}
+
+void zeros(BufferedWriter& w, std::size_t n) {
+    static const char z[8] = {};
+    w.write(z, n);
+}
+
+bool little_endian() {
+    std::uint16_t one = 1;
+    unsigned char b;
+    std::memcpy(&b, &one, 1);
+    return b == 1;
+}
+
+}
+
+ColumnarWriter& ColumnarWriter::add(const std::string& name, const std::vector<double>& v) {
+    cols_.push_back({name, ColumnType::F64, v.data(), v.size()});
+    return *this;
+}
+
+ColumnarWriter& ColumnarWriter::add(const std::string& name, const std::vector<std::int64_t>& v) {
+    cols_.push_back({name, ColumnType::I64, v.data(), v.size()});
+    return *this;
+}
+
+ColumnarWriter& ColumnarWriter::add(const std::string& name, const std::vector<std::string>& v) {
+    cols_.push_back({name, ColumnType::Str, &v, v.size()});
+    return *this;
+}
+
+bool ColumnarWriter::write(const std::string& path) const {
+    // Numeric columns are copied as raw arrays
+    if (!little_endian()) return false;
+    BufferedWriter w(path);
+    if (!w.is_open()) return false;
+
+    std::vector<std::size_t> bytes(cols_.size());
+    std::size_t offset = kHeaderBytes;
+    for (const auto& c : cols_) offset += kEntryBytes + pad8(c.name.size());
+    w.write(kMagic, 4);
+    put_le<std::uint32_t>(w, kVersion);
+    put_le<std::uint32_t>(w, (std::uint32_t)cols_.size());
+    put_le<std::uint32_t>(w, 0);
+    for (std::size_t i = 0; i < cols_.size(); ++i) {
+        const Column& c = cols_[i];
+        if (c.type == ColumnType::Str) {
+            bytes[i] = 0;
+            for (const auto& s : *static_cast<const std::vector<std::string>*>(c.data)) bytes[i] += 4 + s.size();
+        } else {
+            bytes[i] = c.count * 8;
+        }
+        put_le<std::uint32_t>(w, (std::uint32_t)c.type);
+        put_le<std::uint32_t>(w, (std::uint32_t)c.name.size());
+        put_le<std::uint64_t>(w, c.count);
+        put_le<std::uint64_t>(w, offset);
+        put_le<std::uint64_t>(w, bytes[i]);
+        w.text(c.name);
+        zeros(w, pad8(c.name.size()) - c.name.size());
+        offset += pad8(bytes[i]);
+    }
+    for (std::size_t i = 0; i < cols_.size(); ++i) {
+        const Column& c = cols_[i];
+        if (c.type == ColumnType::Str) {
+            for (const auto& s : *static_cast<const std::vector<std::string>*>(c.data)) {
+                put_le<std::uint32_t>(w, (std::uint32_t)s.size());
+                w.text(s);
+            }
+        } else {
+            w.write(c.data, bytes[i]);
+        }
+        zeros(w, pad8(bytes[i]) - bytes[i]);
+    }
+    return w.close();
+}
+
+bool ColumnarReader::open(const std::string& path) {
+    cols_.clear();
+    if (!little_endian() || !file_.open(path)) return false;
+    const char* p = file_.data();
+    std::size_t size = file_.size();
+    if (size < kHeaderBytes || std::memcmp(p, kMagic, 4) != 0 || get_le<std::uint32_t>(p + 4) != kVersion) return false;
+    std::size_t n = get_le<std::uint32_t>(p + 8);
+    std::size_t at = kHeaderBytes;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (size - at < kEntryBytes) { cols_.clear(); return false; }
+        Column c;
+        c.type = (ColumnType)get_le<std::uint32_t>(p + at);
+        std::size_t name_len = get_le<std::uint32_t>(p + at + 4);
+        c.count = get_le<std::uint64_t>(p + at + 8);
+        c.offset = get_le<std::uint64_t>(p + at + 16);
+        c.bytes = get_le<std::uint64_t>(p + at + 24);
+        at += kEntryBytes;
+        bool numeric = c.type == ColumnType::F64 || c.type == ColumnType::I64;
+        if (size - at < name_len || c.offset > size || size - c.offset < c.bytes || (c.offset & 7) ||
+            (numeric && (c.bytes % 8 || c.bytes / 8 != c.count)) || (!numeric && c.type != ColumnType::Str)) {
+            cols_.clear();
+            return false;
+        }
+        c.name.assign(p + at, name_len);
+        at += pad8(name_len);
+        cols_.push_back(std::move(c));
+    }
+    return true;
+}
+
+std::size_t ColumnarReader::find(const std::string& name) const {
+    for (std::size_t i = 0; i < cols_.size(); ++i) if (cols_[i].name == name) return i;
+    return cols_.size();
+}
+
+const double* ColumnarReader::f64(std::size_t i) const {
+    if (i >= cols_.size() || cols_[i].type != ColumnType::F64) return nullptr;
+    return reinterpret_cast<const double*>(file_.data() + cols_[i].offset);
+}
+
+const std::int64_t* ColumnarReader::i64(std::size_t i) const {
+    if (i >= cols_.size() || cols_[i].type != ColumnType::I64) return nullptr;
+    return reinterpret_cast<const std::int64_t*>(file_.data() + cols_[i].offset);
+}
+
+std::vector<std::string> ColumnarReader::strings(std::size_t i) const {
+    std::vector<std::string> out;
+    if (i >= cols_.size() || cols_[i].type != ColumnType::Str) return out;
+    const char* p = file_.data() + cols_[i].offset;
+    const char* end = p + cols_[i].bytes;
+    for (std::size_t k = 0; k < cols_[i].count && end - p >= 4; ++k) {
+        std::size_t len = get_le<std::uint32_t>(p);
+        p += 4;
+        if ((std::size_t)(end - p) < len) break;
+        out.emplace_back(p, len);
+        p += len;
+    }
+    return out;
+}
+
+}
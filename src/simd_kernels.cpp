@@ -0,0 +1,544 @@
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HFT_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HFT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define HFT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define HFT_TARGET_AVX2
+#define HFT_TARGET_AVX512
+#endif
+
+namespace hft {
+namespace simd {
+
+namespace {
+
+// Rolling kernels restart their running sums from an exact window sum every
+// block so rounding error cannot build up over long series.
+std::size_t block_len(int w) { return std::max<std::size_t>(4096, 8 * (std::size_t)w); }
+
+void fill_nan(double* out, std::size_t n) {
+    double q = std::nan("");
+    for (std::size_t i = 0; i < n; ++i) out[i] = q;
+}
+
+// Variance from shifted window sums, clamped against rounding below zero
+inline double var_from_sums(double s1, double s2, double w) {
+    double m = s1 / w;
+    double v = s2 / w - m * m;
+    return v > 0 ? v : 0.0;
+}
+
+// ---------------------------------------------------------------- scalar
+
+namespace scalar {
+
+void simple_returns(const double* x, std::size_t n, double* out) {
+    for (std::size_t i = 0; i + 1 < n; ++i) out[i] = (x[i + 1] - x[i]) / x[i];
+}
+
+void sma(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        double s = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) s += x[k];
+        out[b0] = s / w;
+        for (std::size_t i = b0 + 1; i < b1; ++i) { s += x[i] - x[i - uw]; out[i] = s / w; }
+    }
+}
+
+void rolling_variance(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    if (n < uw) return;
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        // Shift by a value of the block's first window, which keeps the
+        // sums small relative to the variance however far the series drifts
+        double c = x[b0 + 1 - uw];
+        double s1 = 0, s2 = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) { double y = x[k] - c; s1 += y; s2 += y * y; }
+        out[b0] = var_from_sums(s1, s2, w);
+        for (std::size_t i = b0 + 1; i < b1; ++i) {
+            double y = x[i] - c, yo = x[i - uw] - c;
+            s1 += y - yo;
+            s2 += y * y - yo * yo;
+            out[i] = var_from_sums(s1, s2, w);
+        }
+    }
+}
+
+double max_drawdown(const double* eq, std::size_t n) {
+    if (n == 0) return 0.0;
+    double peak = eq[0], mdd = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (eq[i] > peak) peak = eq[i];
+        double dd = (peak - eq[i]) / peak;
+        if (dd > mdd) mdd = dd;
+    }
+    return mdd;
+}
+
+void mean_variance(const double* x, std::size_t n, double* mean, double* var) {
+    if (n == 0) { *mean = 0; *var = 0; return; }
+    double s = 0;
+    for (std::size_t i = 0; i < n; ++i) s += x[i];
+    double m = s / n;
+    double v = 0;
+    for (std::size_t i = 0; i < n; ++i) { double d = x[i] - m; v += d * d; }
+    *mean = m;
+    *var = v / n;
+}
+
+double downside_deviation(const double* r, std::size_t n, double mean, std::size_t* count) {
+    double s = 0;
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (r[i] < 0) { double d = r[i] - mean; s += d * d; ++k; }
+    }
+    if (count) *count = k;
+    return k ? std::sqrt(s / k) : 0.0;
+}
+
+}
+
+const KernelTable kScalar = {scalar::simple_returns, scalar::sma, scalar::rolling_variance,
+                             scalar::max_drawdown, scalar::mean_variance, scalar::downside_deviation};
+
+#ifdef HFT_SIMD_X86
+
+// ---------------------------------------------------------------- AVX2
+
+namespace avx2 {
+
+// Inclusive prefix sum of the four lanes, plus carry
+HFT_TARGET_AVX2 inline __m256d prefix_sum(__m256d v, __m256d carry) {
+    const __m256d z = _mm256_setzero_pd();
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, 0x90), z, 0x1));
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, 0x40), z, 0x3));
+    return _mm256_add_pd(v, carry);
+}
+
+HFT_TARGET_AVX2 inline __m256d last_lane(__m256d v) { return _mm256_permute4x64_pd(v, 0xFF); }
+
+HFT_TARGET_AVX2 inline double hsum(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v), hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+HFT_TARGET_AVX2 inline double hmax(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v), hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_max_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+HFT_TARGET_AVX2 void simple_returns(const double* x, std::size_t n, double* out) {
+    std::size_t m = n ? n - 1 : 0, i = 0;
+    for (; i + 4 <= m; i += 4) {
+        __m256d a = _mm256_loadu_pd(x + i), b = _mm256_loadu_pd(x + i + 1);
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_sub_pd(b, a), a));
+    }
+    for (; i < m; ++i) out[i] = (x[i + 1] - x[i]) / x[i];
+}
+
+HFT_TARGET_AVX2 void sma(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    const __m256d wv = _mm256_set1_pd(w);
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        double s = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) s += x[k];
+        out[b0] = s / w;
+        std::size_t i = b0 + 1;
+        __m256d carry = _mm256_set1_pd(s);
+        for (; i + 4 <= b1; i += 4) {
+            __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(x + i - uw));
+            __m256d sv = prefix_sum(d, carry);
+            _mm256_storeu_pd(out + i, _mm256_div_pd(sv, wv));
+            carry = last_lane(sv);
+        }
+        s = _mm256_cvtsd_f64(carry);
+        for (; i < b1; ++i) { s += x[i] - x[i - uw]; out[i] = s / w; }
+    }
+}
+
+HFT_TARGET_AVX2 void rolling_variance(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    if (n < uw) return;
+    const __m256d wv = _mm256_set1_pd(w), z = _mm256_setzero_pd();
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        double c = x[b0 + 1 - uw]; // per-block shift, as scalar
+        const __m256d cv = _mm256_set1_pd(c);
+        double s1 = 0, s2 = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) { double y = x[k] - c; s1 += y; s2 += y * y; }
+        out[b0] = var_from_sums(s1, s2, w);
+        std::size_t i = b0 + 1;
+        __m256d c1 = _mm256_set1_pd(s1), c2 = _mm256_set1_pd(s2);
+        for (; i + 4 <= b1; i += 4) {
+            __m256d y = _mm256_sub_pd(_mm256_loadu_pd(x + i), cv);
+            __m256d yo = _mm256_sub_pd(_mm256_loadu_pd(x + i - uw), cv);
+            __m256d p1 = prefix_sum(_mm256_sub_pd(y, yo), c1);
+            __m256d p2 = prefix_sum(_mm256_sub_pd(_mm256_mul_pd(y, y), _mm256_mul_pd(yo, yo)), c2);
+            __m256d m = _mm256_div_pd(p1, wv);
+            __m256d v = _mm256_sub_pd(_mm256_div_pd(p2, wv), _mm256_mul_pd(m, m));
+            _mm256_storeu_pd(out + i, _mm256_max_pd(v, z));
+            c1 = last_lane(p1);
+            c2 = last_lane(p2);
+        }
+        s1 = _mm256_cvtsd_f64(c1);
+        s2 = _mm256_cvtsd_f64(c2);
+        for (; i < b1; ++i) {
+            double y = x[i] - c, yo = x[i - uw] - c;
+            s1 += y - yo;
+            s2 += y * y - yo * yo;
+            out[i] = var_from_sums(s1, s2, w);
+        }
+    }
+}
+
+HFT_TARGET_AVX2 double max_drawdown(const double* eq, std::size_t n) {
+    if (n == 0) return 0.0;
+    __m256d peak = _mm256_set1_pd(eq[0]), mdd = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(eq + i);
+        // In-register running max (max is idempotent, so no masking needed)
+        __m256d p = _mm256_max_pd(v, _mm256_permute4x64_pd(v, 0x90));
+        p = _mm256_max_pd(p, _mm256_permute4x64_pd(p, 0x40));
+        p = _mm256_max_pd(p, peak);
+        mdd = _mm256_max_pd(mdd, _mm256_div_pd(_mm256_sub_pd(p, v), p));
+        peak = last_lane(p);
+    }
+    double pk = _mm256_cvtsd_f64(peak), m = hmax(mdd);
+    for (; i < n; ++i) {
+        if (eq[i] > pk) pk = eq[i];
+        double dd = (pk - eq[i]) / pk;
+        if (dd > m) m = dd;
+    }
+    return m;
+}
+
+HFT_TARGET_AVX2 void mean_variance(const double* x, std::size_t n, double* mean, double* var) {
+    if (n == 0) { *mean = 0; *var = 0; return; }
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+    }
+    double s = hsum(_mm256_add_pd(a0, a1));
+    for (; i < n; ++i) s += x[i];
+    double m = s / n;
+    __m256d mv = _mm256_set1_pd(m);
+    a0 = _mm256_setzero_pd(); a1 = _mm256_setzero_pd();
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), mv);
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), mv);
+        a0 = _mm256_fmadd_pd(d0, d0, a0);
+        a1 = _mm256_fmadd_pd(d1, d1, a1);
+    }
+    double v = hsum(_mm256_add_pd(a0, a1));
+    for (; i < n; ++i) { double d = x[i] - m; v += d * d; }
+    *mean = m;
+    *var = v / n;
+}
+
+HFT_TARGET_AVX2 double downside_deviation(const double* r, std::size_t n, double mean, std::size_t* count) {
+    const __m256d mv = _mm256_set1_pd(mean), z = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+    __m256d acc = _mm256_setzero_pd(), cnt = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(r + i);
+        __m256d neg = _mm256_cmp_pd(v, z, _CMP_LT_OQ);
+        __m256d d = _mm256_sub_pd(v, mv);
+        acc = _mm256_add_pd(acc, _mm256_and_pd(neg, _mm256_mul_pd(d, d)));
+        cnt = _mm256_add_pd(cnt, _mm256_and_pd(neg, one));
+    }
+    double s = hsum(acc);
+    std::size_t k = (std::size_t)hsum(cnt);
+    for (; i < n; ++i) {
+        if (r[i] < 0) { double d = r[i] - mean; s += d * d; ++k; }
+    }
+    if (count) *count = k;
+    return k ? std::sqrt(s / k) : 0.0;
+}
+
+}
+
+const KernelTable kAvx2 = {avx2::simple_returns, avx2::sma, avx2::rolling_variance,
+                           avx2::max_drawdown, avx2::mean_variance, avx2::downside_deviation};
+
+// ---------------------------------------------------------------- AVX-512
+
+// GCC 12's AVX-512 headers trip -Wuninitialized on their own
+// _mm512_undefined_pd() placeholders (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace avx512 {
+
+// Inclusive prefix sum of the eight lanes, plus carry
+HFT_TARGET_AVX512 inline __m512d prefix_sum(__m512d v, __m512d carry) {
+    v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFE, _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0), v));
+    v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFC, _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0), v));
+    v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xF0, _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0), v));
+    return _mm512_add_pd(v, carry);
+}
+
+HFT_TARGET_AVX512 inline __m512d last_lane(__m512d v) {
+    return _mm512_permutexvar_pd(_mm512_set1_epi64(7), v);
+}
+
+HFT_TARGET_AVX512 void simple_returns(const double* x, std::size_t n, double* out) {
+    std::size_t m = n ? n - 1 : 0, i = 0;
+    for (; i + 8 <= m; i += 8) {
+        __m512d a = _mm512_loadu_pd(x + i), b = _mm512_loadu_pd(x + i + 1);
+        _mm512_storeu_pd(out + i, _mm512_div_pd(_mm512_sub_pd(b, a), a));
+    }
+    for (; i < m; ++i) out[i] = (x[i + 1] - x[i]) / x[i];
+}
+
+HFT_TARGET_AVX512 void sma(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    const __m512d wv = _mm512_set1_pd(w);
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        double s = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) s += x[k];
+        out[b0] = s / w;
+        std::size_t i = b0 + 1;
+        __m512d carry = _mm512_set1_pd(s);
+        for (; i + 8 <= b1; i += 8) {
+            __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(x + i - uw));
+            __m512d sv = prefix_sum(d, carry);
+            _mm512_storeu_pd(out + i, _mm512_div_pd(sv, wv));
+            carry = last_lane(sv);
+        }
+        s = _mm512_cvtsd_f64(carry);
+        for (; i < b1; ++i) { s += x[i] - x[i - uw]; out[i] = s / w; }
+    }
+}
+
+HFT_TARGET_AVX512 void rolling_variance(const double* x, std::size_t n, int w, double* out) {
+    if (w <= 0) { fill_nan(out, n); return; }
+    std::size_t uw = (std::size_t)w;
+    fill_nan(out, std::min(n, uw - 1));
+    if (n < uw) return;
+    const __m512d wv = _mm512_set1_pd(w), z = _mm512_setzero_pd();
+    for (std::size_t b0 = uw - 1; b0 < n; b0 += block_len(w)) {
+        std::size_t b1 = std::min(n, b0 + block_len(w));
+        double c = x[b0 + 1 - uw]; // per-block shift, as scalar
+        const __m512d cv = _mm512_set1_pd(c);
+        double s1 = 0, s2 = 0;
+        for (std::size_t k = b0 + 1 - uw; k <= b0; ++k) { double y = x[k] - c; s1 += y; s2 += y * y; }
+        out[b0] = var_from_sums(s1, s2, w);
+        std::size_t i = b0 + 1;
+        __m512d c1 = _mm512_set1_pd(s1), c2 = _mm512_set1_pd(s2);
+        for (; i + 8 <= b1; i += 8) {
+            __m512d y = _mm512_sub_pd(_mm512_loadu_pd(x + i), cv);
+            __m512d yo = _mm512_sub_pd(_mm512_loadu_pd(x + i - uw), cv);
+            __m512d p1 = prefix_sum(_mm512_sub_pd(y, yo), c1);
+            __m512d p2 = prefix_sum(_mm512_sub_pd(_mm512_mul_pd(y, y), _mm512_mul_pd(yo, yo)), c2);
+            __m512d m = _mm512_div_pd(p1, wv);
+            __m512d v = _mm512_sub_pd(_mm512_div_pd(p2, wv), _mm512_mul_pd(m, m));
+            _mm512_storeu_pd(out + i, _mm512_max_pd(v, z));
+            c1 = last_lane(p1);
+            c2 = last_lane(p2);
+        }
+        s1 = _mm512_cvtsd_f64(c1);
+        s2 = _mm512_cvtsd_f64(c2);
+        for (; i < b1; ++i) {
+            double y = x[i] - c, yo = x[i - uw] - c;
+            s1 += y - yo;
+            s2 += y * y - yo * yo;
+            out[i] = var_from_sums(s1, s2, w);
+        }
+    }
+}
+
+HFT_TARGET_AVX512 double max_drawdown(const double* eq, std::size_t n) {
+    if (n == 0) return 0.0;
+    __m512d peak = _mm512_set1_pd(eq[0]), mdd = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(eq + i);
+        __m512d p = _mm512_max_pd(v, _mm512_permutexvar_pd(_mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0), v));
+        p = _mm512_max_pd(p, _mm512_permutexvar_pd(_mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0), p));
+        p = _mm512_max_pd(p, _mm512_permutexvar_pd(_mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0), p));
+        p = _mm512_max_pd(p, peak);
+        mdd = _mm512_max_pd(mdd, _mm512_div_pd(_mm512_sub_pd(p, v), p));
+        peak = last_lane(p);
+    }
+    double pk = _mm512_cvtsd_f64(peak), m = _mm512_reduce_max_pd(mdd);
+    for (; i < n; ++i) {
+        if (eq[i] > pk) pk = eq[i];
+        double dd = (pk - eq[i]) / pk;
+        if (dd > m) m = dd;
+    }
+    return m;
+}
+
+HFT_TARGET_AVX512 void mean_variance(const double* x, std::size_t n, double* mean, double* var) {
+    if (n == 0) { *mean = 0; *var = 0; return; }
+    __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm512_add_pd(a0, _mm512_loadu_pd(x + i));
+        a1 = _mm512_add_pd(a1, _mm512_loadu_pd(x + i + 8));
+    }
+    double s = _mm512_reduce_add_pd(_mm512_add_pd(a0, a1));
+    for (; i < n; ++i) s += x[i];
+    double m = s / n;
+    __m512d mv = _mm512_set1_pd(m);
+    a0 = _mm512_setzero_pd(); a1 = _mm512_setzero_pd();
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), mv);
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), mv);
+        a0 = _mm512_fmadd_pd(d0, d0, a0);
+        a1 = _mm512_fmadd_pd(d1, d1, a1);
+    }
+    double v = _mm512_reduce_add_pd(_mm512_add_pd(a0, a1));
+    for (; i < n; ++i) { double d = x[i] - m; v += d * d; }
+    *mean = m;
+    *var = v / n;
+}
+
+HFT_TARGET_AVX512 double downside_deviation(const double* r, std::size_t n, double mean, std::size_t* count) {
+    const __m512d mv = _mm512_set1_pd(mean), z = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0);
+    __m512d acc = _mm512_setzero_pd(), cnt = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(r + i);
+        __mmask8 neg = _mm512_cmp_pd_mask(v, z, _CMP_LT_OQ);
+        __m512d d = _mm512_sub_pd(v, mv);
+        acc = _mm512_mask3_fmadd_pd(d, d, acc, neg);
+        cnt = _mm512_mask_add_pd(cnt, neg, cnt, one);
+    }
+    double s = _mm512_reduce_add_pd(acc);
+    std::size_t k = (std::size_t)_mm512_reduce_add_pd(cnt);
+    for (; i < n; ++i) {
+        if (r[i] < 0) { double d = r[i] - mean; s += d * d; ++k; }
+    }
+    if (count) *count = k;
+    return k ? std::sqrt(s / k) : 0.0;
+}
+
+}
+
+const KernelTable kAvx512 = {avx512::simple_returns, avx512::sma, avx512::rolling_variance,
+                             avx512::max_drawdown, avx512::mean_variance, avx512::downside_deviation};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+bool cpu_has(Isa isa) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (isa == Isa::Avx2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (isa == Isa::Avx512) return __builtin_cpu_supports("avx512f");
+    return true;
+#elif defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0, fma = (r[2] & (1 << 12)) != 0;
+    if (isa == Isa::Scalar) return true;
+    if (!osxsave) return false;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(r, 7, 0);
+    if (isa == Isa::Avx2) return fma && (xcr0 & 0x6) == 0x6 && (r[1] & (1 << 5));
+    return (xcr0 & 0xE6) == 0xE6 && (r[1] & (1 << 16));
+#else
+    return isa == Isa::Scalar;
+#endif
+}
+
+#else
+
+bool cpu_has(Isa isa) { return isa == Isa::Scalar; }
+
+#endif
+
+const KernelTable* table_for(Isa isa) {
+#ifdef HFT_SIMD_X86
+    if (isa == Isa::Avx512) return &kAvx512;
+    if (isa == Isa::Avx2) return &kAvx2;
+#endif
+    (void)isa;
+    return &kScalar;
+}
+
+Isa default_isa() {
+    if (const char* env = std::getenv("HFT_SIMD")) {
+        if (std::strcmp(env, "scalar") == 0) return Isa::Scalar;
+        if (std::strcmp(env, "avx2") == 0 && cpu_has(Isa::Avx2)) return Isa::Avx2;
+        if (std::strcmp(env, "avx512") == 0 && cpu_has(Isa::Avx512)) return Isa::Avx512;
+    }
+    if (cpu_has(Isa::Avx512)) return Isa::Avx512;
+    if (cpu_has(Isa::Avx2)) return Isa::Avx2;
+    return Isa::Scalar;
+}
+
+std::atomic<int> g_isa{-1};
+
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Avx2: return "avx2";
+        case Isa::Avx512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+bool isa_supported(Isa isa) { return cpu_has(isa); }
+
+Isa active_isa() {
+    int v = g_isa.load(std::memory_order_relaxed);
+    if (v < 0) {
+        v = (int)default_isa();
+        g_isa.store(v, std::memory_order_relaxed);
+    }
+    return (Isa)v;
+}
+
+bool set_isa(Isa isa) {
+    if (!cpu_has(isa)) return false;
+    g_isa.store((int)isa, std::memory_order_relaxed);
+    return true;
+}
+
+const KernelTable& kernels(Isa isa) { return *table_for(cpu_has(isa) ? isa : Isa::Scalar); }
+
+const KernelTable& kernels() { return *table_for(active_isa()); }
+
+}
+}
@@ -0,0 +1,97 @@
+#include "vector_backtester.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace hft {
+
+namespace {
+
+// Bars per pass: the scratch columns stay in L1/L2 between kernels, so the
+// only large memory touched is the equity curve and the trade list
+constexpr std::size_t kBlock = 2048;
+
+} // namespace
+
+BacktestResult VectorBacktester::run(const std::vector<Bar>& bars, const std::vector<int>& target, const CostModel& costs) {
+    return run(BarView::of(bars), target, costs);
+}
+
+BacktestResult VectorBacktester::run(const BarView& bars, const std::vector<int>& target, const CostModel& costs) {
+    HFT_PROFILE_SCOPE(Run);
+    BacktestResult res{};
+    const std::size_t n = std::min(bars.size(), target.size());
+    const double start_cash = StrategyContext{}.cash;
+    res.sharpe = res.drawdown = 0.0;
+    res.final_equity = start_cash;
+    if (n == 0) return res;
+
+    const int* pos = target.data();
+    std::size_t trades = pos[0] != 0;
+    for (std::size_t i = 1; i < n; ++i) trades += pos[i] != pos[i - 1];
+    res.trades.reserve(trades);
+    res.equity_curve.resize(n);
+
+    std::vector<double> close(kBlock), notional(kBlock), cost(kBlock);
+    std::vector<int> qty(kBlock);
+    std::vector<std::uint32_t> at(kBlock);
+    double cash = start_cash;
+    int prev = 0;
+    for (std::size_t b0 = 0; b0 < n; b0 += kBlock) {
+        const std::size_t nb = std::min(kBlock, n - b0);
+        const int* p = pos + b0;
+        double* eq = res.equity_curve.data() + b0;
+
+        // Orders are the target differences; notional and costs elementwise
+        for (std::size_t i = 0; i < nb; ++i) close[i] = bars.close(b0 + i);
+        qty[0] = p[0] - prev;
+        for (std::size_t i = 1; i < nb; ++i) qty[i] = p[i] - p[i - 1];
+        prev = p[nb - 1];
+        for (std::size_t i = 0; i < nb; ++i) {
+            notional[i] = qty[i] * close[i];
+            cost[i] = costs.cost(close[i], qty[i]);
+        }
+
+        // Cash is the one sequential pass: notional first, then costs, in
+        // the order the event loop applies them so every bit matches
+        for (std::size_t i = 0; i < nb; ++i) {
+            cash -= notional[i];
+            cash -= cost[i];
+            eq[i] = cash;
+        }
+        for (std::size_t i = 0; i < nb; ++i) eq[i] += p[i] * close[i];
+
+        // Trade bars are compacted without a branch (whether a bar trades
+        // is as unpredictable as the signal), then copied out
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < nb; ++i) {
+            at[k] = (std::uint32_t)i;
+            k += qty[i] != 0;
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            std::size_t i = at[j];
+            std::int64_t ts = bars.ts(b0 + i);
+            res.trades.push_back({ts, close[i], ts, close[i], qty[i]});
+        }
+    }
+
+    res.metrics = MetricsAccumulator::from_equity(res.equity_curve.data(), n);
+    res.sharpe = res.metrics.sharpe();
+    res.drawdown = res.metrics.max_drawdown();
+    res.final_equity = res.equity_curve.back();
+    return res;
+}
+
+std::vector<int> targets_from_signal(const std::vector<double>& signal, int qty) {
+    std::vector<int> out(signal.size());
+    int cur = 0;
+    for (std::size_t i = 0; i < signal.size(); ++i) {
+        double s = signal[i];
+        if (s > 0) cur = std::min(qty, cur + qty);
+        else if (s < 0) cur = std::max(-qty, cur - qty);
+        out[i] = cur;
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,175 @@
+#include "walk_forward.hpp"
+#include "backtester.hpp"
+#include "online_stats.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hft {
+
+namespace {
+
+// Best combination of one fold seen by one worker
+struct FoldBest {
+    bool set = false;
+    double score = 0;
+    std::size_t index = 0;
+    std::vector<double> test_rets; // per-bar returns over the test window
+    std::size_t test_trades = 0;
+};
+
+bool beats(double score, std::size_t index, const FoldBest& b) {
+    if (!b.set) return true;
+    if (score != b.score) return score > b.score;
+    return index < b.index;
+}
+
+// Per-bar returns of an equity curve, r[0] = 0 as in Backtester::run, and
+// their prefix sums so any window's mean and variance cost O(1)
+struct ReturnSums {
+    std::vector<double> s1, s2;
+
+    void build(const std::vector<double>& eq) {
+        s1.assign(eq.size() + 1, 0.0);
+        s2.assign(eq.size() + 1, 0.0);
+        for (std::size_t i = 0; i < eq.size(); ++i) {
+            double r = ret(eq, i);
+            s1[i + 1] = s1[i] + r;
+            s2[i + 1] = s2[i] + r * r;
+        }
+    }
+    static double ret(const std::vector<double>& eq, std::size_t i) {
+        return i ? (eq[i] - eq[i - 1]) / eq[i - 1] : 0.0;
+    }
+};
+
+// Score of the bars [from, to); a window's first return is the move into
+// its first bar, so windows starting at 0 begin one bar later
+double window_score(const std::vector<double>& eq, const ReturnSums& rs, std::size_t from, std::size_t to,
+                    SweepMetric metric) {
+    std::size_t a = std::max<std::size_t>(from, 1);
+    if (to <= a) return 0.0;
+    double score = 0;
+    switch (metric) {
+    case SweepMetric::FinalEquity:
+        score = eq[to - 1] / eq[a - 1] - 1.0;
+        break;
+    case SweepMetric::MaxDrawdown: {
+        RunningDrawdown dd;
+        for (std::size_t i = a - 1; i < to; ++i) dd.add(eq[i]);
+        score = -dd.max_dd;
+        break;
+    }
+    default: {
+        double m = (double)(to - a);
+        double mean = (rs.s1[to] - rs.s1[a]) / m;
+        double var = std::max(0.0, (rs.s2[to] - rs.s2[a]) / m - mean * mean);
+        double sd = std::sqrt(var);
+        score = sd == 0.0 ? 0.0 : mean / sd;
+    }
+    }
+    // A broken run (e.g. equity through zero) never wins
+    return std::isnan(score) ? -std::numeric_limits<double>::infinity() : score;
+}
+
+}
+
+WalkForwardResult WalkForward::run(const BarView& bars, const ParamGrid& grid,
+                                   const StrategyFactory& factory, const WalkForwardConfig& cfg) {
+    WalkForwardResult res;
+    std::size_t n = bars.size();
+    std::size_t train = std::max<std::size_t>(1, cfg.train_bars);
+    std::size_t test = std::max<std::size_t>(1, cfg.test_bars);
+    // Test windows tile the bars after the first train window; the last one
+    // may be shorter
+    for (std::size_t s = 0; s + train < n; s += test) {
+        WalkForwardFold f;
+        f.train_from = cfg.anchored ? 0 : s;
+        f.train_to = s + train;
+        f.test_from = f.train_to;
+        f.test_to = std::min(n, f.test_from + test);
+        res.folds.push_back(f);
+    }
+    std::size_t nf = res.folds.size();
+    std::size_t g = grid.size();
+    if (nf == 0 || g == 0) return res;
+
+    ThreadPool pool(cfg.threads);
+    std::vector<std::vector<FoldBest>> best(pool.size(), std::vector<FoldBest>(nf));
+    std::vector<ReturnSums> sums(pool.size());
+
+    pool.parallel_for(g, [&](std::size_t idx, std::size_t worker) {
+        auto strat = factory(grid.at(idx));
+        if (!strat) return;
+        // One continuous run serves every fold
+        BacktestResult r = Backtester::run(bars, *strat, cfg.costs);
+        const std::vector<double>& eq = r.equity_curve;
+        ReturnSums& rs = sums[worker];
+        rs.build(eq);
+        for (std::size_t k = 0; k < nf; ++k) {
+            const WalkForwardFold& f = res.folds[k];
+            double score = window_score(eq, rs, f.train_from, f.train_to, cfg.metric);
+            FoldBest& b = best[worker][k];
+            if (!beats(score, idx, b)) continue;
+            b.set = true;
+            b.score = score;
+            b.index = idx;
+            b.test_rets.clear();
+            for (std::size_t i = f.test_from; i < f.test_to; ++i) b.test_rets.push_back(ReturnSums::ret(eq, i));
+            // Trades are in bar order, so the window's are a contiguous range
+            auto by_ts = [](const Trade& t, std::int64_t ts) { return t.entry_ts < ts; };
+            auto lo = std::lower_bound(r.trades.begin(), r.trades.end(), bars.ts(f.test_from), by_ts);
+            auto hi = std::lower_bound(lo, r.trades.end(), bars.ts(f.test_to - 1) + 1, by_ts);
+            b.test_trades = (std::size_t)(hi - lo);
+        }
+    });
+
+    // Stitch the winners' test windows into one out-of-sample curve
+    double eq = StrategyContext{}.cash;
+    RunningMoments oos_rets;
+    RunningDrawdown oos_dd;
+    oos_dd.add(eq);
+    res.oos_ts.reserve(n);
+    res.oos_equity.reserve(n);
+    for (std::size_t k = 0; k < nf; ++k) {
+        const FoldBest* w = nullptr;
+        for (const auto& per_worker : best) {
+            const FoldBest& b = per_worker[k];
+            if (b.set && (!w || beats(b.score, b.index, *w))) w = &b;
+        }
+        WalkForwardFold& f = res.folds[k];
+        if (!w) continue;
+        f.best_index = w->index;
+        f.params = grid.at(w->index);
+        f.train_score = w->score;
+        f.test_trades = w->test_trades;
+
+        RunningMoments rets;
+        RunningDrawdown dd;
+        double growth = 1.0;
+        dd.add(growth);
+        for (std::size_t i = 0; i < w->test_rets.size(); ++i) {
+            double r = w->test_rets[i];
+            growth *= 1.0 + r;
+            eq *= 1.0 + r;
+            rets.add(r);
+            dd.add(growth);
+            oos_rets.add(r);
+            oos_dd.add(eq);
+            res.oos_ts.push_back(bars.ts(f.test_from + i));
+            res.oos_equity.push_back(eq);
+        }
+        double sd = rets.stdev();
+        f.test_return = growth - 1.0;
+        f.test_sharpe = sd == 0.0 ? 0.0 : rets.mean / sd;
+        f.test_max_dd = dd.max_dd;
+    }
+    double sd = oos_rets.stdev();
+    res.oos_sharpe = sd == 0.0 ? 0.0 : oos_rets.mean / sd;
+    res.oos_max_dd = oos_dd.max_dd;
+    res.oos_return = eq / StrategyContext{}.cash - 1.0;
+    return res;
+}
+
+}
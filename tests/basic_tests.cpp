@@ -1,15 +1,1766 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include "data_loader.hpp"
 #include "backtester.hpp"
+#include "backtester_t.hpp"
+#include "advanced_backtester.hpp"
+#include "bar_store.hpp"
+#include "synthetic.hpp"
+#include "bar_source.hpp"
+#include "strategies/mean_reversion.hpp"
+#include "parameter_sweep.hpp"
+#include "batch_momentum.hpp"
+#include "walk_forward.hpp"
+#include "risk.hpp"
+#include "indicators.hpp"
+#include <cmath>
 #include "strategies/momentum.hpp"
+#include "simd_kernels.hpp"
+#include "performance.hpp"
+#include "bar_columns.hpp"
+#include "portfolio_backtester.hpp"
+#include "limit_order_book.hpp"
+#include "itch_feed.hpp"
+#include "feed_replay.hpp"
+#include "monte_carlo.hpp"
+#include "online_stats.hpp"
+#include "advanced_reports.hpp"
+#include "report_writer.hpp"
+#include "profiler.hpp"
+#include "pipeline.hpp"
+#include "job_scheduler.hpp"
+#include "vector_backtester.hpp"
+#include <thread>
+#include <map>
+#include <random>
+#include <new>
+#include <cstdlib>
 
-int main() {
-    using namespace hft;
+using namespace hft;
+
+// Allocation hook: counts global operator new calls while enabled
+static std::size_t g_allocs = 0;
+static bool g_count_allocs = false;
+
+// Kept out of line: once inlined, GCC pairs malloc/free with the
+// new/delete expressions around them and reports -Wmismatched-new-delete
+#if defined(__GNUC__) && !defined(__clang__)
+#define HFT_TEST_NOINLINE __attribute__((noinline))
+#else
+#define HFT_TEST_NOINLINE
+#endif
+HFT_TEST_NOINLINE void* operator new(std::size_t n) {
+    if (g_count_allocs) ++g_allocs;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+HFT_TEST_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+HFT_TEST_NOINLINE void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+template <class Fn>
+static std::size_t count_allocs(Fn&& fn) {
+    g_allocs = 0;
+    g_count_allocs = true;
+    fn();
+    g_count_allocs = false;
+    return g_allocs;
+}
+
+static bool same_bar(const Bar& a, const Bar& b) {
+    return std::memcmp(&a, &b, sizeof(Bar)) == 0;
+}
+
+static int test_backtester_basic() {
     auto bars = DataLoader::load_csv("data/sample.csv");
     if (bars.empty()) { std::cout << "FAIL: sample.csv missing\n"; return 1; }
     MomentumStrategy s(5, 1);
     auto res = Backtester::run(bars, s);
     if (res.equity_curve.size() != bars.size()) { std::cout << "FAIL: equity size mismatch\n"; return 1; }
+    return 0;
+}
+
+static int test_load_csv_mmap() {
+    auto ref = DataLoader::load_csv("data/sample.csv");
+    LoadStats st;
+    auto fast = DataLoader::load_csv_mmap("data/sample.csv", &st);
+    if (fast.size() != ref.size() || st.rows != ref.size() || st.malformed != 0) {
+        std::cout << "FAIL: mmap loader row count\n"; return 1;
+    }
+    for (size_t i = 0; i < ref.size(); ++i) {
+        if (!same_bar(ref[i], fast[i])) { std::cout << "FAIL: mmap loader bar " << i << " differs\n"; return 1; }
+    }
+
+    // CRLF endings, exponents, long mantissas, a bad row and no trailing newline
+    const char* path = "test_mmap_tmp.csv";
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << "ts,open,high,low,close,volume\r\n"
+          << "1,100.25,101,-99.5,1.5e2,12000\r\n"
+          << "2,0.1,0.30000000000000004,123456789.123456789,7E-3,1e6\r\n"
+          << "3,abc,1,1,1,1\r\n"
+          << "\r\n"
+          << "4,1,2,3,4,5";
+    }
+    auto a = DataLoader::load_csv(path);
+    auto b = DataLoader::load_csv_mmap(path, &st);
+    std::remove(path);
+    if (a.size() != 3 || b.size() != 3 || st.malformed != 1) {
+        std::cout << "FAIL: mmap loader malformed handling (" << b.size() << " rows, " << st.malformed << " bad)\n"; return 1;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!same_bar(a[i], b[i])) { std::cout << "FAIL: mmap loader edge bar " << i << " differs\n"; return 1; }
+    }
+    return 0;
+}
+
+static int test_bar_store() {
+    auto a = generate_random_walk(5000, 100.0, 0.0002, 0.005, 1731321600000, 60000); // ~3.5 days
+    auto b = generate_random_walk(300);
+    const char* path = "test_store_tmp.hftb";
+    {
+        BarStoreWriter w;
+        if (!w.open(path) || !w.add_symbol("AAA", a) || !w.add_symbol("BBB", b) || w.add_symbol("AAA", b) || !w.close()) {
+            std::cout << "FAIL: bar store write\n"; return 1;
+        }
+    }
+    int fails = 0;
+    {
+        BarStore store;
+        if (!store.open(path) || store.symbols().size() != 2 || store.num_rows() != a.size() + b.size()) {
+            std::cout << "FAIL: bar store open\n"; fails = 1;
+        } else {
+            BarView va = store.bars("AAA");
+            for (size_t i = 0; i < a.size() && !fails; ++i) {
+                if (!same_bar(va[i], a[i])) { std::cout << "FAIL: bar store row " << i << "\n"; fails = 1; }
+            }
+            // Range spanning a day boundary, with bounds falling between bars
+            std::int64_t from = a[1000].ts - 1, to = a[3500].ts + 1;
+            BarView r = store.range("AAA", from, to);
+            if (r.size() != 2501 || !same_bar(r[0], a[1000]) || !same_bar(r[2500], a[3500])) {
+                std::cout << "FAIL: bar store range (" << r.size() << ")\n"; fails = 1;
+            }
+            if (!store.range("AAA", 0, a[0].ts).empty() || !store.range("ZZZ", 0, 1).empty() ||
+                store.range("BBB", 0, INT64_MAX).size() != b.size()) {
+                std::cout << "FAIL: bar store empty ranges\n"; fails = 1;
+            }
+            // Engines consume the mapped view directly
+            MomentumStrategy s1(10, 1), s2(10, 1);
+            auto r1 = Backtester::run(a, s1);
+            auto r2 = Backtester::run(va, s2);
+            if (r1.final_equity != r2.final_equity || r1.trades.size() != r2.trades.size()) {
+                std::cout << "FAIL: backtest over bar store view\n"; fails = 1;
+            }
+            MomentumStrategy s3(10, 1), s4(10, 1);
+            auto r3 = AdvancedBacktester::run("A", a, s3, CostModel{}, RiskControl{}, OrderBook{100, 1, 1, 0.5});
+            auto r4 = AdvancedBacktester::run("A", va, s4, CostModel{}, RiskControl{}, OrderBook{100, 1, 1, 0.5});
+            if (r3.final_equity != r4.final_equity || r3.sharpe != r4.sharpe) {
+                std::cout << "FAIL: advanced backtest over bar store view\n"; fails = 1;
+            }
+        }
+    }
+    std::remove(path);
+    return fails;
+}
+
+static bool close_to(double a, double b, double tol = 1e-9) {
+    return std::abs(a - b) <= tol * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+}
+
+static int test_streaming() {
+    auto bars = generate_random_walk(20000);
+    CostModel costs{0.001, 1.0};
+    int fails = 0;
+
+    MeanReversionStrategy m1(20, 0.003, 1), m2(20, 0.003, 1);
+    auto full = Backtester::run(bars, m1, costs);
+    ViewBarSource src(BarView::of(bars));
+    StreamOptions opt; opt.chunk_bars = 777;
+    auto st = Backtester::run_stream(src, m2, costs, opt);
+    if (st.bars != bars.size() || st.num_trades != full.trades.size() || st.final_equity != full.final_equity ||
+        st.max_dd != full.drawdown || !close_to(st.sharpe, full.sharpe)) {
+        std::cout << "FAIL: streaming backtest differs from in-memory run\n"; fails = 1;
+    }
+
+    // Chunked CSV reader with a block smaller than a line, plus a downsampled curve
+    const char* csv = "test_stream_tmp.csv";
+    const char* curve = "test_stream_curve_tmp.csv";
+    {
+        std::ofstream f(csv);
+        f.precision(17);
+        f << "ts,open,high,low,close,volume\n";
+        for (const auto& b : bars) f << b.ts << "," << b.open << "," << b.high << "," << b.low << "," << b.close << "," << b.volume << "\n";
+    }
+    OrderBook lob{100, 2, 2, 0.5};
+    MomentumStrategy a1(30, 5), a2(30, 5);
+    auto adv = AdvancedBacktester::run("X", bars, a1, costs, RiskControl{}, lob);
+    CsvBarSource csv_src(csv, 37);
+    StreamOptions copt; copt.curve_path = curve; copt.curve_every = 1000;
+    auto ast = AdvancedBacktester::run_stream("X", csv_src, a2, costs, RiskControl{}, lob, copt);
+    if (ast.bars != bars.size() || csv_src.malformed() != 0 || (int)ast.num_trades != adv.num_trades ||
+        ast.final_equity != adv.final_equity || ast.max_dd != adv.max_dd || !close_to(ast.sharpe, adv.sharpe) ||
+        ast.curve_points != 21) {
+        std::cout << "FAIL: streaming advanced backtest from CSV\n"; fails = 1;
+    }
+    std::remove(csv);
+    std::remove(curve);
+    return fails;
+}
+
+static int test_parameter_sweep() {
+    auto bars = generate_random_walk(3000);
+    CostModel costs{0.0, 1.0};
+    ParamGrid grid;
+    grid.add("lookback", ParamGrid::range(5, 60, 5)).add("threshold", {0.002, 0.004}).add("qty", {1, 2});
+    if (grid.size() != 48 || grid.at(47) != std::vector<double>{60, 0.004, 2}) {
+        std::cout << "FAIL: param grid decode\n"; return 1;
+    }
+    StrategyFactory factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+        return std::unique_ptr<Strategy>(new MeanReversionStrategy((int)p[0], p[1], (int)p[2]));
+    };
+    SweepConfig cfg; cfg.costs = costs; cfg.top_k = 5;
+    cfg.threads = 1;
+    auto serial = ParameterSweep::run(BarView::of(bars), grid, factory, cfg);
+    cfg.threads = 4;
+    auto parallel = ParameterSweep::run(BarView::of(bars), grid, factory, cfg);
+
+    // Reference: plain serial loop keeping the best Sharpe
+    double best = -1e9; std::size_t best_idx = 0;
+    for (std::size_t i = 0; i < grid.size(); ++i) {
+        auto p = grid.at(i);
+        MeanReversionStrategy s((int)p[0], p[1], (int)p[2]);
+        auto r = Backtester::run(bars, s, costs);
+        if (r.sharpe > best + 1e-12) { best = r.sharpe; best_idx = i; }
+    }
+    if (serial.size() != 5 || parallel.size() != 5 || serial[0].index != best_idx || !close_to(serial[0].sharpe, best)) {
+        std::cout << "FAIL: parameter sweep best entry\n"; return 1;
+    }
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        if (serial[i].index != parallel[i].index || serial[i].score != parallel[i].score ||
+            (i > 0 && serial[i].score > serial[i - 1].score)) {
+            std::cout << "FAIL: parameter sweep ordering\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_rolling_volatility() {
+    auto bars = generate_random_walk(20000, 100.0, 0.0002, 0.02);
+    for (int lb : {1, 5, 20}) {
+        RollingVolatility vol(lb);
+        std::vector<double> prices;
+        for (const auto& b : bars) {
+            prices.push_back(b.close);
+            vol.update(b.close);
+            double ref = compute_volatility(prices, lb);
+            if (!close_to(vol.value(), ref, 1e-9)) {
+                std::cout << "FAIL: rolling volatility lb=" << lb << " at " << prices.size()
+                          << ": " << vol.value() << " vs " << ref << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_streaming_indicators() {
+    auto bars = generate_random_walk(3000);
+    std::vector<double> x;
+    for (const auto& b : bars) x.push_back(b.close);
+    const int w = 14;
+
+    // Batch and streaming paths agree bit for bit
+    Sma s(w); Ema e(w); Rsi r(w);
+    auto bs = sma(x, w), be = ema(x, w), br = rsi(x, w);
+    for (size_t i = 0; i < x.size(); ++i) {
+        double vs = s.update(x[i]), ve = e.update(x[i]), vr = r.update(x[i]);
+        bool ok = (std::isnan(vs) ? std::isnan(bs[i]) : vs == bs[i]) &&
+                  (std::isnan(ve) ? std::isnan(be[i]) : ve == be[i]) &&
+                  (std::isnan(vr) ? std::isnan(br[i]) : vr == br[i]);
+        if (!ok) { std::cout << "FAIL: streaming vs batch indicator at " << i << "\n"; return 1; }
+    }
+    if (!std::isnan(bs[w - 2]) || std::isnan(bs[w - 1]) || !std::isnan(br[w]) || std::isnan(br[w + 1])) {
+        std::cout << "FAIL: indicator warm-up\n"; return 1;
+    }
+
+    // Window statistics against brute force
+    RollingStdev sd(w); RollingMinMax mm(w); Vwap vw(w), session;
+    double spv = 0, sv = 0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const Bar& b = bars[i];
+        sd.update(b); mm.update(b); vw.update(b); session.update(b);
+        double pv = (b.high + b.low + b.close) / 3.0 * b.volume;
+        spv += pv; sv += b.volume;
+        if (!close_to(session.value(), spv / sv)) { std::cout << "FAIL: session vwap\n"; return 1; }
+        if (i + 1 < (size_t)w) {
+            if (sd.ready() || mm.ready() || vw.ready()) { std::cout << "FAIL: rolling warm-up\n"; return 1; }
+            continue;
+        }
+        double mean = 0, lo = x[i], hi = x[i], wpv = 0, wv = 0;
+        for (size_t k = i + 1 - w; k <= i; ++k) {
+            mean += x[k]; lo = std::min(lo, x[k]); hi = std::max(hi, x[k]);
+            wpv += (bars[k].high + bars[k].low + bars[k].close) / 3.0 * bars[k].volume; wv += bars[k].volume;
+        }
+        mean /= w;
+        double var = 0;
+        for (size_t k = i + 1 - w; k <= i; ++k) var += (x[k] - mean) * (x[k] - mean);
+        double stdev = std::sqrt(var / w);
+        if (!close_to(sd.mean(), mean) || std::abs(sd.value() - stdev) > 1e-9 ||
+            mm.min() != lo || mm.max() != hi || !close_to(vw.value(), wpv / wv) ||
+            (stdev > 1e-6 && !close_to(sd.zscore(x[i]), (x[i] - mean) / stdev, 1e-6))) {
+            std::cout << "FAIL: rolling window statistics at " << i << "\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_simd_kernels() {
+    // Odd length so every vector loop has a tail, long enough to cross blocks
+    auto bars = generate_random_walk(10007, 100.0, 0.0002, 0.02);
+    std::vector<double> x;
+    for (const auto& b : bars) x.push_back(b.close);
+    const size_t n = x.size();
+    const simd::KernelTable& ref = simd::kernels(simd::Isa::Scalar);
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Avx2, simd::Isa::Avx512}) {
+        if (!simd::isa_supported(isa)) continue;
+        const simd::KernelTable& k = simd::kernels(isa);
+        std::string tag = simd::isa_name(isa);
+        std::vector<double> a(n), b(n);
+
+        ref.simple_returns(x.data(), n, a.data());
+        k.simple_returns(x.data(), n, b.data());
+        for (size_t i = 0; i + 1 < n; ++i) {
+            if (b[i] != a[i] || a[i] != (x[i + 1] - x[i]) / x[i]) {
+                std::cout << "FAIL: simd returns " << tag << " at " << i << "\n"; return 1;
+            }
+        }
+        for (int w : {1, 7, 20}) {
+            k.sma(x.data(), n, w, a.data());
+            k.rolling_variance(x.data(), n, w, b.data());
+            for (size_t i = 0; i < n; ++i) {
+                if (i + 1 < (size_t)w) {
+                    if (!std::isnan(a[i]) || !std::isnan(b[i])) { std::cout << "FAIL: simd warm-up " << tag << "\n"; return 1; }
+                    continue;
+                }
+                double mean = 0, var = 0;
+                for (size_t j = i + 1 - w; j <= i; ++j) mean += x[j];
+                mean /= w;
+                for (size_t j = i + 1 - w; j <= i; ++j) var += (x[j] - mean) * (x[j] - mean);
+                var /= w;
+                if (!close_to(a[i], mean) || std::abs(b[i] - var) > 1e-8) {
+                    std::cout << "FAIL: simd rolling w=" << w << " " << tag << " at " << i << ": "
+                              << a[i] << "/" << b[i] << " vs " << mean << "/" << var << "\n";
+                    return 1;
+                }
+            }
+        }
+        {
+            // A long trend: the shifted sums must not lose precision far
+            // from the start of the series
+            const size_t m = 300000;
+            const int w = 20;
+            std::vector<double> t(m), v(m);
+            for (size_t i = 0; i < m; ++i) t[i] = 100.0 + 0.05 * i + std::sin(i * 0.7);
+            k.rolling_variance(t.data(), m, w, v.data());
+            for (size_t i = w - 1; i < m; i += 97) {
+                double mean = 0, var = 0;
+                for (size_t j = i + 1 - w; j <= i; ++j) mean += t[j];
+                mean /= w;
+                for (size_t j = i + 1 - w; j <= i; ++j) var += (t[j] - mean) * (t[j] - mean);
+                var /= w;
+                if (std::abs(v[i] - var) > 1e-8 * var) {
+                    std::cout << "FAIL: simd rolling variance on a trend " << tag << " at " << i << "\n"; return 1;
+                }
+            }
+        }
+
+        // Drawdown is a max/divide scan and must match exactly
+        for (size_t len : {size_t(0), size_t(1), size_t(5), size_t(13), n}) {
+            if (k.max_drawdown(x.data(), len) != ref.max_drawdown(x.data(), len)) {
+                std::cout << "FAIL: simd drawdown " << tag << " len=" << len << "\n"; return 1;
+            }
+        }
+
+        std::vector<double> r(n - 1);
+        ref.simple_returns(x.data(), n, r.data());
+        double m0, v0, m1, v1;
+        ref.mean_variance(r.data(), r.size(), &m0, &v0);
+        k.mean_variance(r.data(), r.size(), &m1, &v1);
+        size_t c0 = 0, c1 = 0;
+        double d0 = ref.downside_deviation(r.data(), r.size(), m0, &c0);
+        double d1 = k.downside_deviation(r.data(), r.size(), m0, &c1);
+        if (!close_to(m0, m1, 1e-9) || !close_to(v0, v1, 1e-9) || !close_to(d0, d1, 1e-9) || c0 != c1 || c0 == 0) {
+            std::cout << "FAIL: simd moments " << tag << "\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_bar_columns() {
+    auto ref = DataLoader::load_csv("data/sample.csv");
+    LoadStats st;
+    BarColumns cols = DataLoader::load_csv_columns("data/sample.csv", &st);
+    if (cols.size() != ref.size() || st.rows != ref.size()) { std::cout << "FAIL: column loader row count\n"; return 1; }
+    const void* arrays[] = {cols.ts(), cols.open(), cols.high(), cols.low(), cols.close(), cols.volume()};
+    for (const void* a : arrays) {
+        if (reinterpret_cast<std::uintptr_t>(a) % 64 != 0) { std::cout << "FAIL: column not 64-byte aligned\n"; return 1; }
+    }
+    BarView v = cols.view();
+    for (size_t i = 0; i < ref.size(); ++i) {
+        if (!same_bar(cols[i], ref[i]) || !same_bar(v[i], ref[i])) { std::cout << "FAIL: column bar " << i << "\n"; return 1; }
+    }
+
+    // Generators agree across layouts, and the engines give identical results
+    auto aos = generate_random_walk(5000);
+    auto soa = generate_random_walk_columns(5000);
+    BarColumns copy = BarColumns::from(aos);
+    for (size_t i = 0; i < aos.size(); ++i) {
+        if (!same_bar(soa[i], aos[i]) || !same_bar(copy[i], aos[i])) { std::cout << "FAIL: column generator " << i << "\n"; return 1; }
+    }
+    MomentumStrategy s1(10, 1), s2(10, 1);
+    auto a = Backtester::run(aos, s1);
+    auto b = Backtester::run(soa.view(), s2);
+    if (a.final_equity != b.final_equity || a.trades.size() != b.trades.size() || a.sharpe != b.sharpe) {
+        std::cout << "FAIL: engine on columns differs\n"; return 1;
+    }
+    return 0;
+}
+
+// Records the event order and buys one unit of every symbol on its first bar
+struct OrderProbe : PortfolioStrategy {
+    std::vector<std::pair<std::int64_t, std::size_t>> seen;
+    void on_bar(std::size_t sym, const Bar& bar, const PortfolioBook& book, std::vector<PortfolioFill>& orders) override {
+        seen.push_back({bar.ts, sym});
+        if (book.position(sym) == 0) orders.push_back({(std::uint32_t)sym, {bar.ts, bar.close, bar.ts, bar.close, 1}});
+    }
+};
+
+// Trades symbol 1 (and an unpriced symbol 2) only on symbol 0's bars
+struct CrossProbe : PortfolioStrategy {
+    void on_bar(std::size_t sym, const Bar& bar, const PortfolioBook&, std::vector<PortfolioFill>& orders) override {
+        if (sym != 0) return;
+        orders.push_back({1, {bar.ts, 0.0, bar.ts, 0.0, 1}});
+        orders.push_back({2, {bar.ts, 0.0, bar.ts, 0.0, 1}});
+    }
+};
+
+static int test_portfolio_backtester() {
+    // One symbol, no costs or spread: the shared book matches Backtester::run
+    auto bars = generate_random_walk(3000);
+    OrderBook flat{100.0, 0.0, 0.0, 0.0};
+    MomentumStrategy ref_strat(10, 2);
+    auto ref = Backtester::run(bars, ref_strat);
+    PerSymbolStrategy one(1, [](std::size_t) { return std::make_unique<MomentumStrategy>(10, 2); });
+    auto pr = PortfolioBacktester::run({{"A", BarView::of(bars)}}, one, CostModel{}, PortfolioRisk{}, flat);
+    if (pr.equity_curve.size() != ref.equity_curve.size() || pr.num_trades != ref.trades.size() || pr.events != bars.size()) {
+        std::cout << "FAIL: portfolio single-symbol shape\n"; return 1;
+    }
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (!close_to(pr.equity_curve[i], ref.equity_curve[i], 1e-12)) { std::cout << "FAIL: portfolio equity at " << i << "\n"; return 1; }
+    }
+
+    // Interleaved and overlapping timestamps come out merged, ties by symbol
+    auto a = generate_random_walk(500, 100.0, 0.0, 0.01, 0, 2);
+    auto b = generate_random_walk(300, 500.0, 0.0, 0.01, 1, 3);
+    auto c = generate_random_walk(400, 20.0, 0.0, 0.01, 0, 2);
+    OrderProbe probe;
+    PortfolioRisk risk;
+    risk.max_gross_exposure = 130.0; // room for A and C, never for B
+    auto r = PortfolioBacktester::run({{"A", BarView::of(a)}, {"B", BarView::of(b)}, {"C", BarView::of(c)}, {"E", BarView()}},
+                                      probe, CostModel{}, risk, flat);
+    if (probe.seen.size() != 1200 || r.events != 1200 || r.symbols.size() != 4) { std::cout << "FAIL: portfolio event count\n"; return 1; }
+    for (size_t i = 1; i < probe.seen.size(); ++i) {
+        if (probe.seen[i] < probe.seen[i - 1]) { std::cout << "FAIL: portfolio merge order at " << i << "\n"; return 1; }
+    }
+    if (r.symbols[0].position != 1 || r.symbols[1].position != 0 || r.symbols[2].position != 1 || r.rejected != 300) {
+        std::cout << "FAIL: portfolio gross exposure limit\n"; return 1;
+    }
+    double mtm = r.symbols[0].last_close + r.symbols[2].last_close;
+    if (!close_to(r.final_equity, 100000.0 - a[0].close - c[0].close + mtm, 1e-12)) {
+        std::cout << "FAIL: portfolio final equity\n"; return 1;
+    }
+
+    // Orders for another symbol fill at that symbol's last close; B's first
+    // bar comes after A's, so the first order has no price and is refused,
+    // as is every order for C, which never trades before the end
+    std::vector<Bar> xa = {{10, 1, 1, 1, 50.0, 1}, {20, 1, 1, 1, 51.0, 1}, {30, 1, 1, 1, 52.0, 1}};
+    std::vector<Bar> xb = {{15, 1, 1, 1, 200.0, 1}, {25, 1, 1, 1, 210.0, 1}};
+    std::vector<Bar> xc = {{40, 1, 1, 1, 5.0, 1}};
+    CrossProbe cross;
+    PortfolioOptions keep;
+    keep.keep_trades = true;
+    auto x = PortfolioBacktester::run({{"A", BarView::of(xa)}, {"B", BarView::of(xb)}, {"C", BarView::of(xc)}}, cross,
+                                      CostModel{}, PortfolioRisk{}, flat, keep);
+    if (x.symbols[0].position != 0 || x.symbols[1].position != 2 || x.symbols[2].position != 0 || x.rejected != 4 ||
+        x.trades.size() != 2 || x.trades[0].symbol != 1 || x.trades[0].trade.entry_price != 200.0 ||
+        x.trades[1].trade.entry_price != 210.0 || x.final_equity != 100000.0 - 200.0 - 210.0 + 2 * 210.0) {
+        std::cout << "FAIL: portfolio cross-symbol orders\n"; return 1;
+    }
+    return 0;
+}
+
+static int test_limit_order_book() {
+    LimitOrderBook book(0.01, 64);
+    book.add(1, Side::Buy, 100.00, 10);
+    book.add(2, Side::Buy, 100.00, 5);
+    book.add(3, Side::Buy, 99.99, 7);
+    book.add(4, Side::Sell, 100.02, 8);
+    book.add(5, Side::Sell, 100.03, 4);
+    if (book.add(2, Side::Buy, 99.0, 1) || !close_to(book.best_bid(), 100.00) || !close_to(book.best_ask(), 100.02) ||
+        book.qty_at(Side::Buy, 100.00) != 15 || book.order_count() != 5) {
+        std::cout << "FAIL: book add / top of book\n"; return 1;
+    }
+
+    // Queue position through size-up, executions and partial cancels
+    book.modify(1, 12); // size-up goes behind order 2
+    OrderId sim = book.place(Side::Buy, 100.00, 6);
+    if (book.sim_state(sim).queue_ahead != 17) { std::cout << "FAIL: sim queue position\n"; return 1; }
+    book.execute(2, 5);
+    book.reduce(1, 2);
+    if (book.sim_state(sim).queue_ahead != 10 || !book.fills().empty()) { std::cout << "FAIL: sim queue after trades\n"; return 1; }
+    book.add(6, Side::Buy, 100.00, 3);
+    book.execute(1, 10);
+    book.execute(6, 3); // queued behind the simulated order: partial fill
+    SimOrderState st = book.sim_state(sim);
+    if (book.fills().size() != 1 || st.filled != 3 || st.remaining != 3 || st.queue_ahead != 0 || !st.active) {
+        std::cout << "FAIL: sim partial fill\n"; return 1;
+    }
+    book.execute(3, 5); // trades through at 99.99: the rest fills at 100.00
+    st = book.sim_state(sim);
+    if (st.active || st.filled != 6 || book.fills().back().qty != 3 || !close_to(book.fills().back().price, 100.00)) {
+        std::cout << "FAIL: sim trade-through fill\n"; return 1;
+    }
+
+    // Displayed depth: partial sweeps, level walk and emptied sides
+    double avg = 0;
+    if (book.sweep(Side::Buy, 10, &avg) != 10 || !close_to(avg, (8 * 100.02 + 2 * 100.03) / 10) ||
+        book.sweep(Side::Buy, 20, &avg) != 12 || book.sweep(Side::Buy, 20, &avg, 100.02) != 8) {
+        std::cout << "FAIL: book sweep\n"; return 1;
+    }
+    book.cancel(4);
+    if (!close_to(book.best_ask(), 100.03)) { std::cout << "FAIL: best ask after cancel\n"; return 1; }
+    book.cancel(5);
+    if (book.has_ask() || !close_to(book.best_bid(), 99.99) || book.qty_at(Side::Buy, 99.99) != 2) {
+        std::cout << "FAIL: book after clearing asks\n"; return 1;
+    }
+
+    // An incoming order priced through a resting simulated order trades with it
+    book.clear_fills();
+    OrderId ask = book.place(Side::Sell, 100.05, 5);
+    book.add(8, Side::Buy, 100.06, 2);
+    if (book.fills().size() != 1 || book.sim_state(ask).filled != 2 || !close_to(book.fills()[0].price, 100.05)) {
+        std::cout << "FAIL: sim cross fill\n"; return 1;
+    }
+    book.replace(8, 9, 100.01, 4);
+    if (book.qty_at(Side::Buy, 100.06) != 0 || !close_to(book.best_bid(), 100.01) || !book.cancel(ask) || book.cancel(ask)) {
+        std::cout << "FAIL: book replace / sim cancel\n"; return 1;
+    }
+
+    // Several resting simulated orders fill in price-time order, skipping
+    // a cancelled one
+    book.clear_fills();
+    OrderId a1 = book.place(Side::Sell, 100.10, 3);
+    OrderId a2 = book.place(Side::Sell, 100.08, 3);
+    OrderId a3 = book.place(Side::Sell, 100.08, 3);
+    OrderId a4 = book.place(Side::Sell, 100.09, 3);
+    book.cancel(a2);
+    book.add(10, Side::Buy, 100.10, 7);
+    const auto& f = book.fills();
+    if (f.size() != 3 || f[0].id != a3 || f[1].id != a4 || f[2].id != a1 || f[2].qty != 1 ||
+        book.sim_state(a2).filled != 0 || !book.sim_state(a1).active || book.sim_state(a4).active) {
+        std::cout << "FAIL: sim price-time order\n"; return 1;
+    }
+
+    // Random flow against a map-based reference, across window growth
+    std::mt19937_64 rng(7);
+    LimitOrderBook lob(0.01, 16);
+    std::map<OrderId, std::pair<std::int64_t, std::int64_t>> live; // id -> (ticks, qty), bids only
+    OrderId next_id = 1;
+    for (int i = 0; i < 20000; ++i) {
+        int op = (int)(rng() % 4);
+        if (op < 2 || live.empty()) {
+            std::int64_t px = 10000 + (std::int64_t)(rng() % 400) - 200;
+            std::int64_t q = 1 + (std::int64_t)(rng() % 50);
+            lob.add(next_id, Side::Buy, px * 0.01, q);
+            live[next_id++] = {px, q};
+        } else {
+            auto it = live.begin();
+            std::advance(it, (long)(rng() % live.size()));
+            if (op == 2) { lob.cancel(it->first); live.erase(it); }
+            else {
+                std::int64_t q = 1 + (std::int64_t)(rng() % 60);
+                lob.execute(it->first, q);
+                if (q >= it->second.second) live.erase(it); else it->second.second -= q;
+            }
+        }
+        std::int64_t best = -1;
+        for (const auto& kv : live) best = std::max(best, kv.second.first);
+        if (lob.order_count() != live.size() || (best >= 0) != lob.has_bid() ||
+            (best >= 0 && lob.to_ticks(lob.best_bid()) != best)) {
+            std::cout << "FAIL: book random flow at op " << i << "\n"; return 1;
+        }
+    }
+    std::map<std::int64_t, std::int64_t> by_px;
+    for (const auto& kv : live) by_px[kv.second.first] += kv.second.second;
+    for (const auto& kv : by_px) {
+        if (lob.qty_at(Side::Buy, kv.first * 0.01) != kv.second) { std::cout << "FAIL: book level qty\n"; return 1; }
+    }
+
+    // As the advanced engine's fill model: formula model matches the
+    // OrderBook overload, and a thin synthetic ladder fills partially
+    auto bars = generate_random_walk(2000);
+    OrderBook formula{100.0, 2.0, 2.0, 0.5};
+    RiskControl risk;
+    MomentumStrategy m1(10, 5), m2(10, 5), m3(10, 5);
+    FormulaFillModel fm(formula);
+    auto a = AdvancedBacktester::run("A", BarView::of(bars), m1, CostModel{}, risk, formula);
+    auto b = AdvancedBacktester::run("A", BarView::of(bars), m2, CostModel{}, risk, fm);
+    LimitOrderBook ladder(0.01);
+    BookFillModel bm(ladder);
+    bm.synthesize(3, 1, 1e-4); // ~1 unit per level
+    auto c = AdvancedBacktester::run("A", BarView::of(bars), m3, CostModel{}, risk, bm);
+    if (a.final_equity != b.final_equity || a.num_trades != b.num_trades || c.trades.empty()) {
+        std::cout << "FAIL: fill model engine\n"; return 1;
+    }
+    for (const auto& t : c.trades) {
+        if (std::abs(t.quantity) > 3) { std::cout << "FAIL: ladder fill not partial\n"; return 1; }
+    }
+
+    // Partial and empty fills replace the strategy's own booking: cash,
+    // position and equity follow the accepted trades alone
+    {
+        CostModel cm{0.001, 0.5};
+        RiskControl loose;
+        loose.max_daily_loss = 1e12;
+        LimitOrderBook thin(0.01);
+        BookFillModel tm(thin);
+        tm.synthesize(2, 1, 1e-4); // ~2 units over two levels per bar
+        MomentumStrategy m4(10, 5);
+        auto d = AdvancedBacktester::run("A", BarView::of(bars), m4, cm, loose, tm);
+        double cash = 100000.0;
+        int pos = 0;
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < bars.size(); ++i) {
+            for (; k < d.trades.size() && d.trades[k].entry_ts == bars[i].ts; ++k) {
+                const Trade& t = d.trades[k];
+                cash -= t.quantity * t.entry_price + cm.cost(t.entry_price, t.quantity);
+                pos += t.quantity;
+            }
+            if (!close_to(d.equity_curve[i], cash + pos * bars[i].close, 1e-6)) {
+                std::cout << "FAIL: thin-book accounting at bar " << i << "\n"; return 1;
+            }
+        }
+        if (k != d.trades.size() || std::abs(pos) > 5 || !close_to(d.final_equity, cash + pos * bars.back().close, 1e-6)) {
+            std::cout << "FAIL: thin-book position / equity\n"; return 1;
+        }
+    }
+
+    // Two orders on one bar share its ladder; the next bar starts afresh
+    Bar bar{};
+    bar.ts = 1;
+    bar.close = 100.00;
+    bar.volume = 20000;
+    bm.synthesize(3, 1, 1e-4); // 2 per level at 100.01, 100.02, 100.03
+    FillResult f1 = bm.fill(bar, 3), f2 = bm.fill(bar, 5), f3 = bm.fill(bar, -2);
+    if (f1.filled != 3 || !close_to(f1.price, (2 * 100.01 + 100.02) / 3) || f2.filled != 3 ||
+        !close_to(f2.price, (100.02 + 2 * 100.03) / 3) || bm.fill(bar, 1).filled != 0 || f3.filled != -2) {
+        std::cout << "FAIL: ladder depth shared within a bar\n"; return 1;
+    }
+    bar.ts = 2;
+    if (bm.fill(bar, 6).filled != 6) { std::cout << "FAIL: ladder depth after a new bar\n"; return 1; }
+    return 0;
+}
+
+static int test_itch_feed() {
+    const char* path = "test_feed_tmp.itch";
+    const std::int64_t t0 = 1731321600000000000LL;
+    const std::int64_t sec = 1000000000LL;
+    {
+        FeedWriter w(path);
+        w.symbol(t0, 0, "AAA");
+        w.symbol(t0, 1, "BBB");
+        w.add(t0 + 1, 0, 1, Side::Buy, 99.99, 300);
+        w.add(t0 + 2, 0, 2, Side::Sell, 100.01, 200);
+        w.add(t0 + 3, 1, 3, Side::Buy, 50.00, 100);
+        w.quote(t0 + 4, 0, 99.99, 300, 100.01, 200);
+        w.execute(t0 + 5, 0, 2, 50, 7);              // buyer lifts 50 @ 100.01
+        w.cancel(t0 + 6, 0, 1, 100);
+        w.replace(t0 + 7, 0, 1, 4, 100.00, 150);
+        w.trade(t0 + sec + 1, 0, Side::Sell, 100.00, 25); // next 1s bucket
+        w.execute(t0 + sec + 2, 0, 4, 150);          // seller hits 150 @ 100.00
+        w.remove(t0 + sec + 3, 1, 3);
+        if (!w.close() || w.messages() != 12) { std::cout << "FAIL: feed writer\n"; return 1; }
+    }
+
+    // Decode: directory consumed, fields round-trip
+    FeedReader r(path);
+    std::vector<MarketEvent> evs;
+    MarketEvent ev;
+    while (r.next(ev)) evs.push_back(ev);
+    if (evs.size() != 10 || r.messages() != 12 || r.malformed() || r.truncated() ||
+        r.symbol(0) != "AAA" || r.locate("BBB") != 1 || r.locate("CCC") != -1) {
+        std::cout << "FAIL: feed decode counts\n"; return 1;
+    }
+    const BookDelta& a = evs[1].book;
+    const QuoteEvent& q = evs[3].quote;
+    const TradeEvent& p = evs[7].trade;
+    if (evs[1].type != EventType::Book || a.action != BookAction::Add || a.side != Side::Sell || a.id != 2 ||
+        a.ts_ns != t0 + 2 || !close_to(a.price, 100.01) || a.qty != 200 ||
+        evs[3].type != EventType::Quote || !close_to(q.bid, 99.99) || q.ask_qty != 200 ||
+        evs[6].book.action != BookAction::Replace || evs[6].book.new_id != 4 || !close_to(evs[6].book.price, 100.00) ||
+        evs[7].type != EventType::Trade || p.aggressor != Side::Sell || p.qty != 25) {
+        std::cout << "FAIL: feed decode fields\n"; return 1;
+    }
+
+    // A cut-off message is flagged, not decoded
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    FeedReader cut(bytes.data(), bytes.size() - 3);
+    std::size_t n = 0;
+    while (cut.next(ev)) ++n;
+    if (n != 9 || !cut.truncated()) { std::cout << "FAIL: truncated feed\n"; return 1; }
+
+    // Book replay prices executions from the book and feeds bars
+    struct Tape : MarketEventHandler {
+        std::vector<TradeEvent> trades;
+        void on_trade(const TradeEvent& t) override { trades.push_back(t); }
+    };
+    Tape tape;
+    BookReplay books(&tape);
+    r.rewind();
+    r.replay(books);
+    const LimitOrderBook* aaa = books.find(0);
+    if (!aaa || books.rejected() || aaa->order_count() != 1 || aaa->has_bid() ||
+        aaa->qty_at(Side::Sell, 100.01) != 150 || !books.find(1) || books.find(1)->order_count() != 0 ||
+        tape.trades.size() != 3 || !close_to(tape.trades[0].price, 100.01) || tape.trades[0].aggressor != Side::Buy ||
+        tape.trades[0].qty != 50 || !close_to(tape.trades[2].price, 100.00) || tape.trades[2].qty != 150) {
+        std::cout << "FAIL: book replay\n"; return 1;
+    }
+    std::vector<Bar> agg;
+    BarAggregator bars(1000, [&](std::uint16_t s, const Bar& b) { if (s == 0) agg.push_back(b); });
+    for (const auto& t : tape.trades) bars.on_trade(t);
+    bars.flush();
+    if (agg.size() != 2 || agg[0].ts != t0 / 1000000 || !close_to(agg[0].close, 100.01) || agg[0].volume != 50 ||
+        agg[1].ts != t0 / 1000000 + 1000 || !close_to(agg[1].open, 100.00) || agg[1].volume != 175) {
+        std::cout << "FAIL: bar aggregation\n"; return 1;
+    }
+
+    // Strategies run on a synthetic feed exactly as on the same bars in memory
+    if (!write_synthetic_feed(path, {"AAA", "BBB", "CCC"}, 60000, t0, 5000000)) {
+        std::cout << "FAIL: synthetic feed\n"; return 1;
+    }
+    std::vector<Bar> ref;
+    {
+        Tape all;
+        BookReplay rb(&all);
+        FeedReader fr(path);
+        fr.replay(rb);
+        BarAggregator ab(1000, [&](std::uint16_t s, const Bar& b) { if ((int)s == fr.locate("BBB")) ref.push_back(b); });
+        for (const auto& t : all.trades) ab.on_trade(t);
+        ab.flush();
+        if (rb.rejected() || fr.malformed()) { std::cout << "FAIL: synthetic feed replay\n"; return 1; }
+    }
+    FeedBarSource src(path, "BBB", 1000);
+    std::vector<Bar> streamed(ref.size() + 8);
+    std::size_t got = 0, k;
+    while (got + 7 <= streamed.size() && (k = src.next(streamed.data() + got, 7)) > 0) got += k;
+    if (ref.size() < 50 || got != ref.size() || !std::equal(ref.begin(), ref.end(), streamed.begin(), same_bar)) {
+        std::cout << "FAIL: feed bar source\n"; return 1;
+    }
+    MomentumStrategy m1(5, 1), m2(5, 1);
+    FeedBarSource src2(path, "BBB", 1000);
+    auto rs = Backtester::run_stream(src2, m1, CostModel{0.0, 1.0});
+    auto rv = Backtester::run(ref, m2, CostModel{0.0, 1.0});
+    std::remove(path);
+    if (rs.bars != ref.size() || !close_to(rs.final_equity, rv.final_equity) || rs.num_trades != rv.trades.size()) {
+        std::cout << "FAIL: run_stream on feed\n"; return 1;
+    }
+    return 0;
+}
+
+// Setup allocations are fixed; a run 10x longer must not make a single
+// extra one, i.e. the per-bar path allocates nothing
+static int test_hot_loop_allocations() {
+    auto small = generate_random_walk(2000);
+    auto big = generate_random_walk(20000);
+    CostModel costs{0.0, 1.0};
+    OrderBook lob{100, 1, 1, 0.5};
+    auto basic = [&](const std::vector<Bar>& b) {
+        return count_allocs([&] { MomentumStrategy m(10, 1); Backtester::run(b, m, costs); });
+    };
+    auto advanced = [&](const std::vector<Bar>& b) {
+        return count_allocs([&] { MeanReversionStrategy m(10, 0.002, 1); AdvancedBacktester::run("X", b, m, costs, RiskControl{}, lob); });
+    };
+    auto streamed = [&](const std::vector<Bar>& b) {
+        return count_allocs([&] {
+            MomentumStrategy m(10, 1);
+            ViewBarSource src(BarView::of(b));
+            AdvancedBacktester::run_stream("X", src, m, costs, RiskControl{}, lob);
+        });
+    };
+    auto portfolio = [&](const std::vector<Bar>& b) {
+        return count_allocs([&] {
+            std::vector<PortfolioAsset> assets{{"A", BarView::of(b)}, {"B", BarView::of(b)}};
+            PerSymbolStrategy per(2, [](std::size_t) { return std::unique_ptr<Strategy>(new MomentumStrategy(10, 1)); });
+            PortfolioOptions opt;
+            opt.keep_trades = true;
+            PortfolioBacktester::run(assets, per, costs, PortfolioRisk{}, lob, opt);
+        });
+    };
+    std::size_t a = basic(small), b = basic(big);
+    std::size_t c = advanced(small), d = advanced(big);
+    std::size_t e = streamed(small), f = streamed(big);
+    std::size_t g = portfolio(small), h = portfolio(big);
+    if (a != b || c != d || e != f || g != h) {
+        std::cout << "FAIL: per-bar allocations (basic " << a << "/" << b << ", advanced " << c << "/" << d
+                  << ", stream " << e << "/" << f << ", portfolio " << g << "/" << h << ")\n";
+        return 1;
+    }
+    return 0;
+}
+
+static bool same_doubles(const std::vector<double>& a, const std::vector<double>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0);
+}
+
+static bool same_trades(const std::vector<Trade>& a, const std::vector<Trade>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].entry_ts != b[i].entry_ts || a[i].quantity != b[i].quantity ||
+            std::memcmp(&a[i].entry_price, &b[i].entry_price, sizeof(double)) != 0) return false;
+    }
+    return true;
+}
+
+// Compile-time dispatch must not change a single bit of the results
+static int test_backtester_template() {
+    auto bars = generate_random_walk(5000);
+    BarView v = BarView::of(bars);
+    CostModel costs{0.01, 1.5};
+    MomentumStrategy m1(15, 2), m2(15, 2);
+    MeanReversionStrategy r1(20, 0.002, 3), r2(20, 0.002, 3);
+    auto vm = Backtester::run(v, m1, costs);
+    auto tm = BacktesterT<MomentumStrategy>::run(v, m2, costs);
+    auto vr = Backtester::run(v, r1, costs);
+    auto tr = BacktesterT<MeanReversionStrategy>::run(v, r2, costs);
+    for (auto* p : {&vm, &vr}) {
+        const BacktestResult& a = *p;
+        const BacktestResult& b = p == &vm ? tm : tr;
+        if (a.trades.empty() || !same_doubles(a.equity_curve, b.equity_curve) || !same_trades(a.trades, b.trades) ||
+            std::memcmp(&a.sharpe, &b.sharpe, sizeof(double)) != 0 ||
+            std::memcmp(&a.drawdown, &b.drawdown, sizeof(double)) != 0) {
+            std::cout << "FAIL: templated backtester differs from virtual\n"; return 1;
+        }
+    }
+
+    MomentumStrategy m3(15, 2), m4(15, 2);
+    ViewBarSource s3(v), s4(v);
+    auto vs = Backtester::run_stream(s3, m3, costs);
+    auto ts = BacktesterT<MomentumStrategy>::run_stream(s4, m4, costs);
+    if (vs.num_trades != ts.num_trades || std::memcmp(&vs.final_equity, &ts.final_equity, sizeof(double)) != 0 ||
+        std::memcmp(&vs.sharpe, &ts.sharpe, sizeof(double)) != 0) {
+        std::cout << "FAIL: templated run_stream differs from virtual\n"; return 1;
+    }
+
+    // A fill model that fills at the formula price is reconciled with the
+    // strategy's own accounting: equity moves by the price difference and costs
+    OrderBook lob{100, 5, 5, 0.0};
+    FormulaFillModel formula(lob);
+    MomentumStrategy m5(15, 2);
+    auto fm = BacktesterT<MomentumStrategy, CostModel, ModelFill<FormulaFillModel>>::run(
+        v, m5, CostModel{}, ModelFill<FormulaFillModel>{formula});
+    double expect = 100000.0;
+    for (const Trade& t : fm.trades) expect -= t.quantity * t.entry_price;
+    MomentumStrategy m6(15, 2);
+    auto plain = Backtester::run(v, m6, CostModel{});
+    int pos = 0;
+    for (const Trade& t : plain.trades) pos += t.quantity;
+    expect += pos * bars.back().close;
+    if (fm.trades.size() != plain.trades.size() || !close_to(fm.final_equity, expect) ||
+        !(fm.final_equity < plain.final_equity)) {
+        std::cout << "FAIL: templated backtester with fill model\n"; return 1;
+    }
+    return 0;
+}
+
+// Batched momentum must match N independent streaming runs bit for bit,
+// on every instruction set
+static int test_batch_momentum() {
+    auto bars = generate_random_walk(3000);
+    BarView v = BarView::of(bars);
+    CostModel costs{0.01, 1.5};
+    std::vector<MomentumParams> params;
+    for (int lb = 0; lb <= 41; ++lb) for (int q : {1, 3, 0}) params.push_back({lb, q});
+
+    std::vector<StreamResult> ref;
+    for (const auto& p : params) {
+        MomentumStrategy m(p.lookback, p.qty);
+        ViewBarSource src(v);
+        ref.push_back(Backtester::run_stream(src, m, costs));
+    }
+    simd::Isa saved = simd::active_isa();
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Avx2}) {
+        if (!simd::set_isa(isa)) continue;
+        auto got = BatchMomentum::run(v, params, costs);
+        ViewBarSource src(v);
+        auto streamed = BatchMomentum::run_stream(src, params, costs);
+        for (std::size_t j = 0; j < params.size(); ++j) {
+            for (const StreamResult* r : {&got[j], &streamed[j]}) {
+                if (r->bars != ref[j].bars || r->num_trades != ref[j].num_trades ||
+                    std::memcmp(&r->final_equity, &ref[j].final_equity, sizeof(double)) != 0 ||
+                    std::memcmp(&r->sharpe, &ref[j].sharpe, sizeof(double)) != 0 ||
+                    std::memcmp(&r->max_dd, &ref[j].max_dd, sizeof(double)) != 0) {
+                    std::cout << "FAIL: batch momentum " << simd::isa_name(isa) << " lookback " << params[j].lookback
+                              << " qty " << params[j].qty << "\n";
+                    simd::set_isa(saved);
+                    return 1;
+                }
+            }
+        }
+    }
+    simd::set_isa(saved);
+
+    // The batched sweep ranks exactly like the per-combination one
+    ParamGrid grid;
+    grid.add("lookback", ParamGrid::range(2, 60, 1)).add("qty", {1, 2});
+    SweepConfig cfg;
+    cfg.top_k = 7;
+    cfg.threads = 3;
+    cfg.costs = costs;
+    auto a = ParameterSweep::run(v, grid, [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+        return std::unique_ptr<Strategy>(new MomentumStrategy((int)p[0], (int)p[1]));
+    }, cfg);
+    auto b = ParameterSweep::run_momentum(v, grid, cfg);
+    if (a.size() != 7 || b.size() != a.size()) { std::cout << "FAIL: batched sweep size\n"; return 1; }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].index != b[i].index || a[i].params != b[i].params || a[i].score != b[i].score ||
+            a[i].num_trades != b[i].num_trades) {
+            std::cout << "FAIL: batched sweep entry " << i << "\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_walk_forward() {
+    auto bars = generate_random_walk(1200);
+    BarView v = BarView::of(bars);
+    ParamGrid grid;
+    grid.add("lookback", ParamGrid::range(3, 30, 3)).add("qty", {1, 2});
+    StrategyFactory factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+        return std::unique_ptr<Strategy>(new MomentumStrategy((int)p[0], (int)p[1]));
+    };
+    WalkForwardConfig cfg;
+    cfg.train_bars = 300;
+    cfg.test_bars = 150;
+    cfg.threads = 3;
+    cfg.costs = CostModel{0.0, 1.0};
+    auto wf = WalkForward::run(v, grid, factory, cfg);
+    if (wf.folds.size() != 6 || wf.folds[1].train_from != 150 || wf.folds[1].test_from != 450 ||
+        wf.folds.back().test_to != 1200 || wf.oos_equity.size() != 900 || wf.oos_ts.front() != bars[300].ts) {
+        std::cout << "FAIL: walk-forward fold layout\n"; return 1;
+    }
+
+    // Brute force: every combination's train-window Sharpe from a full run
+    std::vector<std::vector<double>> curves;
+    for (std::size_t i = 0; i < grid.size(); ++i) {
+        auto s = factory(grid.at(i));
+        curves.push_back(Backtester::run(v, *s, cfg.costs).equity_curve);
+    }
+    auto window_sharpe = [](const std::vector<double>& e, std::size_t from, std::size_t to) {
+        std::vector<double> r;
+        for (std::size_t i = std::max<std::size_t>(from, 1); i < to; ++i) r.push_back((e[i] - e[i - 1]) / e[i - 1]);
+        return sharpe_ratio(r);
+    };
+    double eq = 100000.0;
+    for (const auto& f : wf.folds) {
+        double best = -1e300;
+        for (const auto& c : curves) best = std::max(best, window_sharpe(c, f.train_from, f.train_to));
+        const auto& w = curves[f.best_index];
+        if (std::abs(window_sharpe(w, f.train_from, f.train_to) - best) > 1e-9 ||
+            !close_to(f.train_score, best, 1e-6) || f.params != grid.at(f.best_index)) {
+            std::cout << "FAIL: walk-forward in-sample choice\n"; return 1;
+        }
+        for (std::size_t i = f.test_from; i < f.test_to; ++i) eq *= w[i] / w[i - 1];
+        if (!close_to(f.test_return + 1.0, w[f.test_to - 1] / w[f.test_from - 1], 1e-9)) {
+            std::cout << "FAIL: walk-forward test return\n"; return 1;
+        }
+    }
+    if (!close_to(wf.oos_equity.back(), eq, 1e-9)) { std::cout << "FAIL: stitched out-of-sample equity\n"; return 1; }
+
+    // Independent of the thread count; anchored folds all train from bar 0
+    cfg.threads = 1;
+    auto one = WalkForward::run(v, grid, factory, cfg);
+    for (std::size_t k = 0; k < wf.folds.size(); ++k) {
+        if (one.folds[k].best_index != wf.folds[k].best_index) { std::cout << "FAIL: walk-forward threads\n"; return 1; }
+    }
+    if (one.oos_equity != wf.oos_equity) { std::cout << "FAIL: walk-forward threads curve\n"; return 1; }
+    cfg.anchored = true;
+    auto anch = WalkForward::run(v, grid, factory, cfg);
+    if (anch.folds.size() != 6 || anch.folds[3].train_from != 0 || anch.folds[3].train_to != 750) {
+        std::cout << "FAIL: anchored walk-forward\n"; return 1;
+    }
+    return 0;
+}
+
+static int test_monte_carlo() {
+    // Random123 known-answer vectors for Philox4x32-10
+    auto kat = Philox4x32::block({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u});
+    if (kat != Philox4x32::Block{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u} ||
+        Philox4x32::block({0, 0, 0, 0}, {0, 0}) != Philox4x32::Block{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}) {
+        std::cout << "FAIL: philox known answers\n"; return 1;
+    }
+    // Bulk and one-at-a-time draws agree; moments of a large sample
+    Philox4x32 a(7, 3), b(7, 3);
+    std::vector<double> z(200001);
+    a.fill_normal(z.data(), z.size());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        if (b.normal() != z[i]) { std::cout << "FAIL: philox fill_normal\n"; return 1; }
+    }
+    RunningMoments m;
+    for (double x : z) m.add(x);
+    if (std::abs(m.mean) > 0.01 || std::abs(m.variance() - 1.0) > 0.01) { std::cout << "FAIL: philox normal moments\n"; return 1; }
+    if (Philox4x32(7, 4).next_u64() == Philox4x32(7, 3).next_u64()) { std::cout << "FAIL: philox streams\n"; return 1; }
+
+    // Paths do not depend on how they are pulled
+    PathSpec spec;
+    spec.bars = 700;
+    for (PathModel model : {PathModel::Gbm, PathModel::Jump, PathModel::Garch}) {
+        spec.model = model;
+        std::vector<Bar> whole;
+        monte_carlo_path_into(whole, spec, 42, 5);
+        PathBarSource src(spec, 42, 5);
+        std::vector<Bar> pulled(whole.size());
+        std::size_t got = 0;
+        for (std::size_t m2; (m2 = src.next(pulled.data() + got, 97)) > 0;) got += m2;
+        if (got != 700 || whole.size() != 700) { std::cout << "FAIL: monte carlo path length\n"; return 1; }
+        for (std::size_t i = 0; i < got; ++i) {
+            if (!same_bar(whole[i], pulled[i])) { std::cout << "FAIL: monte carlo chunking\n"; return 1; }
+        }
+    }
+    // Log-return volatility matches the spec for every regime, jumps add
+    // their variance on top
+    spec.bars = 20000;
+    auto rv = [&](PathModel model) {
+        spec.model = model;
+        std::vector<Bar> p;
+        monte_carlo_path_into(p, spec, 1, 0);
+        RunningMoments r;
+        for (std::size_t i = 1; i < p.size(); ++i) r.add(std::log(p[i].close / p[i - 1].close));
+        return r.stdev();
+    };
+    double gbm = rv(PathModel::Gbm), garch = rv(PathModel::Garch), jump = rv(PathModel::Jump);
+    double jump_sd = std::sqrt(spec.vol * spec.vol + spec.jump_prob * spec.jump_vol * spec.jump_vol);
+    if (!close_to(gbm, spec.vol, 2e-4) || !close_to(garch, spec.vol, 5e-4) || !close_to(jump, jump_sd, 5e-4)) {
+        std::cout << "FAIL: monte carlo path volatility\n"; return 1;
+    }
+
+    // The driver agrees with a direct run per path and with any thread count
+    MonteCarloConfig cfg;
+    cfg.spec.bars = 500;
+    cfg.spec.model = PathModel::Jump;
+    cfg.paths = 64;
+    cfg.threads = 3;
+    cfg.chunk_bars = 128;
+    cfg.costs = CostModel{0.0, 1.0};
+    auto make = [] { return std::unique_ptr<Strategy>(new MomentumStrategy(10, 1)); };
+    auto mc = MonteCarlo::run(make, cfg);
+    std::vector<double> eq;
+    for (std::size_t p = 0; p < cfg.paths; ++p) {
+        std::vector<Bar> bars;
+        monte_carlo_path_into(bars, cfg.spec, cfg.seed, p);
+        MomentumStrategy s(10, 1);
+        eq.push_back(Backtester::run(bars, s, cfg.costs).equity_curve.back());
+    }
+    std::sort(eq.begin(), eq.end());
+    if (mc.pooled.bars() != 64 * 500 || mc.paths != 64 || !close_to(mc.final_equity.min, eq.front(), 1e-6) || !close_to(mc.final_equity.max, eq.back(), 1e-6) ||
+        !close_to(mc.final_equity.p50, eq[32], 1e-6) || mc.final_equity.p05 > mc.final_equity.p95) {
+        std::cout << "FAIL: monte carlo vs direct runs\n"; return 1;
+    }
+    cfg.threads = 1;
+    auto one = MonteCarlo::run(make, cfg);
+    if (one.sharpe.mean != mc.sharpe.mean || one.max_dd.p95 != mc.max_dd.p95 || one.prob_loss != mc.prob_loss ||
+        one.pooled.sortino() != mc.pooled.sortino()) {
+        std::cout << "FAIL: monte carlo threads\n"; return 1;
+    }
+    cfg.seed = 43;
+    if (MonteCarlo::run(make, cfg).final_equity.mean == mc.final_equity.mean) { std::cout << "FAIL: monte carlo seed\n"; return 1; }
+
+    // generate_random_walk keeps seed 42 by default
+    auto d = generate_random_walk(50), s42 = generate_random_walk(50, 100.0, 0.0002, 0.005, 1731321600000, 60000, 42);
+    auto s7 = generate_random_walk(50, 100.0, 0.0002, 0.005, 1731321600000, 60000, 7);
+    if (!same_bar(d[49], s42[49]) || same_bar(d[49], s7[49])) { std::cout << "FAIL: random walk seed\n"; return 1; }
+    return 0;
+}
+
+static int test_metrics_accumulator() {
+    auto bars = generate_random_walk(3000, 100.0, 0.0002, 0.02);
+    MomentumStrategy mom(10, 5);
+    auto r = Backtester::run(bars, mom, CostModel{0.0, 1.0});
+    const auto& eq = r.equity_curve;
+    const MetricsAccumulator& m = r.metrics;
+
+    // Against explicit passes over the stored curve
+    std::vector<double> rets;
+    for (std::size_t i = 1; i < eq.size(); ++i) rets.push_back((eq[i] - eq[i - 1]) / eq[i - 1]);
+    double mean, var;
+    simd::kernels().mean_variance(rets.data(), rets.size(), &mean, &var);
+    double down = simd::kernels().downside_deviation(rets.data(), rets.size(), mean, nullptr);
+    std::size_t wins = 0, losses = 0, under = 0, longest = 0;
+    double gw = 0, gl = 0, peak = eq[0];
+    for (std::size_t i = 1; i < eq.size(); ++i) {
+        double pnl = eq[i] - eq[i - 1];
+        if (pnl > 0) { ++wins; gw += pnl; } else if (pnl < 0) { ++losses; gl -= pnl; }
+    }
+    for (double v : eq) {
+        if (v >= peak) { peak = v; under = 0; } else longest = std::max(longest, ++under);
+    }
+    double total = eq.back() / eq.front() - 1.0;
+    double annual = std::pow(1.0 + total, 252.0 / rets.size()) - 1.0; // over returns, not points
+    if (m.bars() != eq.size() || !close_to(m.sharpe(), sharpe_ratio(rets), 1e-12) || r.sharpe != m.sharpe() ||
+        m.max_drawdown() != max_drawdown(eq) || r.drawdown != m.max_drawdown() ||
+        !close_to(m.downside_deviation(), down, 1e-12) || m.max_drawdown_bars() != longest || longest == 0 ||
+        m.winning_bars() != wins || m.losing_bars() != losses || !close_to(m.profit_factor(), gw / gl, 1e-9) ||
+        !close_to(m.win_rate(), (double)wins / (wins + losses)) || !close_to(m.total_return(), total, 1e-12) ||
+        !close_to(m.annualized_return(), annual, 1e-12) || !close_to(m.calmar(), annual / max_drawdown(eq), 1e-9)) {
+        std::cout << "FAIL: metrics accumulator vs explicit passes\n"; return 1;
+    }
+    auto pm = compute_metrics(eq, (int)r.trades.size());
+    if (!close_to(pm.sortino_ratio, mean / down * std::sqrt(252.0), 1e-9) || pm.sharpe_ratio != m.sharpe(252.0)) {
+        std::cout << "FAIL: compute_metrics\n"; return 1;
+    }
+
+    // Streaming and in-memory runs feed the same accumulator
+    MomentumStrategy mom2(10, 5);
+    ViewBarSource src(BarView::of(bars));
+    auto sr = Backtester::run_stream(src, mom2, CostModel{0.0, 1.0});
+    if (sr.metrics.sharpe() != m.sharpe() || sr.metrics.sortino() != m.sortino() ||
+        sr.metrics.max_drawdown_bars() != m.max_drawdown_bars()) {
+        std::cout << "FAIL: metrics accumulator stream vs run\n"; return 1;
+    }
+
+    // Merging pools two series: moments over both return sets, the worse
+    // drawdown, and the combined book's return
+    auto other = generate_random_walk(1000, 50.0, 0.0, 0.01, 0, 1, 7);
+    MeanReversionStrategy mr(20, 0.002, 3);
+    auto r2 = Backtester::run(other, mr, CostModel{0.0, 1.0});
+    MetricsAccumulator both = r.metrics;
+    both.merge(r2.metrics);
+    RunningMoments pooled;
+    for (double x : rets) pooled.add(x);
+    for (std::size_t i = 1; i < r2.equity_curve.size(); ++i)
+        pooled.add((r2.equity_curve[i] - r2.equity_curve[i - 1]) / r2.equity_curve[i - 1]);
+    double book = (eq.back() + r2.equity_curve.back()) / (eq.front() + r2.equity_curve.front()) - 1.0;
+    if (both.bars() != 4000 || both.returns().n != pooled.n || !close_to(both.returns().mean, pooled.mean, 1e-15) ||
+        !close_to(both.returns().variance(), pooled.variance(), 1e-15) ||
+        both.max_drawdown() != std::max(r.drawdown, r2.drawdown) || !close_to(both.total_return(), book, 1e-12) ||
+        both.winning_bars() != r.metrics.winning_bars() + r2.metrics.winning_bars()) {
+        std::cout << "FAIL: metrics accumulator merge\n"; return 1;
+    }
+    MetricsAccumulator empty;
+    empty.merge(r2.metrics);
+    if (empty.sharpe() != r2.metrics.sharpe() || empty.total_return() != r2.metrics.total_return()) {
+        std::cout << "FAIL: metrics accumulator merge into empty\n"; return 1;
+    }
+
+    // One series split in time: the later chunk carries the boundary
+    // return, peak and time under water, and appending gives one pass
+    for (std::size_t cut : {(std::size_t)1, (std::size_t)700, (std::size_t)1500, eq.size() - 1}) {
+        MetricsAccumulator head, tail;
+        for (std::size_t i = 0; i < cut; ++i) head.add(eq[i]);
+        tail = MetricsAccumulator::after(head);
+        for (std::size_t i = cut; i < eq.size(); ++i) tail.add(eq[i]);
+        head.append(tail);
+        if (head.bars() != m.bars() || head.returns().n != m.returns().n || head.winning_bars() != m.winning_bars() ||
+            head.losing_bars() != m.losing_bars() || head.max_drawdown() != m.max_drawdown() ||
+            head.max_drawdown_bars() != m.max_drawdown_bars() || head.total_return() != m.total_return() ||
+            head.final_equity() != m.final_equity() || head.annualized_return() != m.annualized_return() ||
+            !close_to(head.sharpe(), m.sharpe(), 1e-12) || !close_to(head.sortino(), m.sortino(), 1e-12) ||
+            !close_to(head.profit_factor(), m.profit_factor(), 1e-12)) {
+            std::cout << "FAIL: metrics accumulator append at " << cut << "\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_report_writer() {
+    // Shortest round-trip text for doubles, exact integers
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    char buf[kMaxNumberChars + 1];
+    for (int i = 0; i < 20000; ++i) {
+        double v = u(rng) * std::pow(10.0, (double)(i % 40) - 20);
+        *format_real(buf, v) = 0;
+        if (std::strtod(buf, nullptr) != v) { std::cout << "FAIL: format_real round trip " << buf << "\n"; return 1; }
+    }
+    *format_real(buf, 100000.0) = 0;
+    std::string plain = buf;
+    *format_integer(buf, -1234567890123LL) = 0;
+    if (plain != "100000" || std::string(buf) != "-1234567890123") { std::cout << "FAIL: report number text\n"; return 1; }
+
+    // Runs of the advanced engine written through a background queue, in
+    // both formats, and read back exactly
+    auto a = generate_random_walk(1500), b = generate_random_walk(900, 50.0, 0.0, 0.01, 0, 1, 9);
+    MomentumStrategy m1(10, 5), m2(10, 5);
+    RiskControl risk;
+    OrderBook lob;
+    std::vector<AssetBacktest> results;
+    results.push_back(AdvancedBacktester::run("A_MOM", a, m1, CostModel{}, risk, lob));
+    results.push_back(AdvancedBacktester::run("B_MOM", b, m2, CostModel{}, risk, lob));
+    const std::string base = "test_report_tmp";
+    bool ok = false;
+    {
+        ReportQueue q;
+        q.submit([&] { ok = write_advanced_report(base, results, ReportFormat::Both); });
+        q.wait();
+    }
+    ColumnarReader rd;
+    if (!ok || !rd.open(base + ".hftc") || rd.columns() != 6 + 2 * results.size()) {
+        std::cout << "FAIL: columnar report open\n"; return 1;
+    }
+    std::size_t ia = rd.find("equity/A_MOM"), ib = rd.find("pnl/B_MOM"), it = rd.find("summary/trades");
+    if (rd.count(ia) != 1500 || rd.count(ib) != 900 || rd.find("nope") != rd.columns() ||
+        rd.strings(rd.find("summary/asset")) != std::vector<std::string>{"A_MOM", "B_MOM"} ||
+        rd.i64(it)[1] != results[1].num_trades || rd.f64(it) != nullptr ||
+        !std::equal(results[0].equity_curve.begin(), results[0].equity_curve.end(), rd.f64(ia)) ||
+        !std::equal(results[1].pnl_series.begin(), results[1].pnl_series.end(), rd.f64(ib))) {
+        std::cout << "FAIL: columnar report contents\n"; return 1;
+    }
+    std::ifstream det(base + "_details.csv");
+    std::string line;
+    std::getline(det, line);
+    std::size_t rows = 0;
+    while (std::getline(det, line)) {
+        std::size_t c1 = line.find(','), c2 = line.find(',', c1 + 1), c3 = line.find(',', c2 + 1);
+        const AssetBacktest& r = rows < 1500 ? results[0] : results[1];
+        std::size_t i = std::stoul(line.substr(c1 + 1, c2 - c1 - 1));
+        if (line.substr(0, c1) != r.asset || std::strtod(line.c_str() + c2 + 1, nullptr) != r.equity_curve[i] ||
+            std::strtod(line.c_str() + c3 + 1, nullptr) != r.pnl_series[i]) {
+            std::cout << "FAIL: details CSV row " << rows << "\n"; return 1;
+        }
+        ++rows;
+    }
+    if (rows != 2400) { std::cout << "FAIL: details CSV rows\n"; return 1; }
+    det.close();
+    for (const char* sfx : {".hftc", "_summary.csv", "_details.csv", "_equity.csv"}) std::remove((base + sfx).c_str());
+
+    // A truncated file is rejected
+    {
+        BufferedWriter w(base + ".hftc", 16);
+        w.text("HFTC");
+        w.close();
+    }
+    if (rd.open(base + ".hftc")) { std::cout << "FAIL: truncated columnar file accepted\n"; return 1; }
+    // So is a count whose byte size wraps around to the stored one
+    {
+        char buf[64] = {};
+        std::uint32_t head[4] = {0, 1, 1, 0}, entry[2] = {1, 1};
+        std::uint64_t sizes[3] = {(std::uint64_t(1) << 61) + 1, 56, 8};
+        std::memcpy(head, "HFTC", 4);
+        std::memcpy(buf, head, 16);
+        std::memcpy(buf + 16, entry, 8);
+        std::memcpy(buf + 24, sizes, 24);
+        buf[48] = 'x';
+        BufferedWriter w(base + ".hftc", 64);
+        w.write(buf, sizeof buf);
+        w.close();
+    }
+    if (rd.open(base + ".hftc")) { std::cout << "FAIL: wrapped columnar count accepted\n"; return 1; }
+    std::remove((base + ".hftc").c_str());
+
+    // Jobs run in submission order
+    std::vector<int> order;
+    {
+        ReportQueue q;
+        for (int i = 0; i < 50; ++i) q.submit([&order, i] { order.push_back(i); });
+    }
+    for (int i = 0; i < 50; ++i) {
+        if (order.size() != 50 || order[i] != i) { std::cout << "FAIL: report queue order\n"; return 1; }
+    }
+    return 0;
+}
+
+static int test_profiler() {
+    using prof::LatencyHistogram;
+    // Buckets cover every value and stay within 1/32 of it
+    for (std::uint64_t v : {0ull, 1ull, 31ull, 32ull, 33ull, 63ull, 64ull, 1000ull, 123456789ull, ~0ull}) {
+        std::size_t i = LatencyHistogram::index(v);
+        std::uint64_t lo = LatencyHistogram::lower_bound(i), w = LatencyHistogram::width(i);
+        if (i >= LatencyHistogram::kBuckets || v < lo || v - lo >= w || (v >= 32 && w > lo / 16)) {
+            std::cout << "FAIL: histogram bucket for " << v << "\n"; return 1;
+        }
+    }
+    LatencyHistogram h, lo_half, hi_half;
+    for (std::uint64_t v = 1; v <= 100000; ++v) {
+        h.record(v);
+        (v <= 50000 ? lo_half : hi_half).record(v);
+    }
+    if (h.count() != 100000 || h.min() != 1 || h.max() != 100000 || !close_to(h.mean(), 50000.5)) {
+        std::cout << "FAIL: histogram count/min/max/mean\n"; return 1;
+    }
+    for (double p : {0.5, 0.9, 0.99}) {
+        double want = p * 100000, got = (double)h.percentile(p);
+        if (std::abs(got - want) > want / 32) { std::cout << "FAIL: histogram p" << p << " " << got << "\n"; return 1; }
+    }
+    lo_half.merge(hi_half);
+    if (lo_half.count() != h.count() || lo_half.percentile(0.99) != h.percentile(0.99)) {
+        std::cout << "FAIL: histogram merge\n"; return 1;
+    }
+    LatencyHistogram small;
+    for (std::uint64_t v : {3, 3, 3, 7}) small.record(v);
+    if (small.percentile(0.5) != 3 || small.percentile(1.0) != 7) { std::cout << "FAIL: exact small values\n"; return 1; }
+
+    // Each thread records into its own log; the summary merges them
+    prof::reset();
+    auto work = [](int n) { for (int i = 0; i < n; ++i) prof::ScopedTimer t(prof::Phase::Strategy); };
+    work(100);
+    std::thread t1(work, 50), t2(work, 50);
+    t1.join();
+    t2.join();
+    if (prof::histogram(prof::Phase::Strategy).count() != 200) { std::cout << "FAIL: per-thread records\n"; return 1; }
+    auto stats = prof::summary();
+    if (stats.size() != 1 || stats[0].count != 200 || std::string(stats[0].name) != "strategy" || stats[0].p50_ns > stats[0].max_ns) {
+        std::cout << "FAIL: profiler summary\n"; return 1;
+    }
+
+    // The trace ring keeps the newest events; the export has one X event each
+    prof::set_trace_capacity(8);
+    prof::reset();
+    for (int i = 0; i < 20; ++i) prof::ScopedTimer t(i % 2 ? prof::Phase::Fill : prof::Phase::Cost);
+    if (prof::local().events().size() != 8 || prof::local().dropped() != 12) { std::cout << "FAIL: trace ring\n"; return 1; }
+    const char* path = "test_profiler_tmp.json";
+    if (!prof::write_chrome_trace(path)) { std::cout << "FAIL: write trace\n"; return 1; }
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path);
+    std::size_t xs = 0;
+    for (std::size_t at = 0; (at = json.find("\"ph\":\"X\"", at)) != std::string::npos; ++at) ++xs;
+    if (json.compare(0, 18, "{\"displayTimeUnit\"") != 0 || xs != 8 || json.find("\"name\":\"fill\"") == std::string::npos) {
+        std::cout << "FAIL: chrome trace\n"; return 1;
+    }
+    prof::set_trace_capacity(1 << 16);
+    prof::reset();
+
+    // Engine scopes exist only in HFT_PROFILE builds
+    auto bars = generate_random_walk(500);
+    MeanReversionStrategy mr(10, 0.002, 1);
+    AdvancedBacktester::run("X", bars, mr, CostModel{0.0, 1.0}, RiskControl{}, OrderBook{100, 1, 1, 0.5});
+    std::uint64_t runs = prof::histogram(prof::Phase::Run).count();
+    std::uint64_t steps = prof::histogram(prof::Phase::MarkToMarket).count();
+    if (prof::kEnabled ? (runs != 1 || steps != bars.size()) : (runs != 0 || steps != 0)) {
+        std::cout << "FAIL: engine profile scopes\n"; return 1;
+    }
+    prof::reset();
+    return 0;
+}
+
+static int test_pipeline() {
+    // Odd batch sizes against a small ring: wraps, partial pushes, stalls
+    {
+        SpscRing<std::uint64_t> ring(64);
+        const std::uint64_t n = 200000;
+        std::thread producer([&] {
+            std::uint64_t buf[37];
+            for (std::uint64_t v = 0; v < n;) {
+                std::size_t k = 0;
+                while (k < 37 && v + k < n) { buf[k] = v + k; ++k; }
+                Backoff backoff;
+                for (std::size_t done = 0; done < k;) {
+                    std::size_t m = ring.push(buf + done, k - done);
+                    if (m) done += m;
+                    else backoff.wait();
+                }
+                v += k;
+            }
+            ring.close();
+        });
+        std::uint64_t expect = 0, buf[23];
+        bool ordered = true;
+        for (;;) {
+            std::size_t got = ring.pop(buf, 23);
+            if (!got && ring.closed()) got = ring.pop(buf, 23);
+            if (!got) {
+                if (ring.closed()) break;
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < got; ++i) ordered &= buf[i] == expect++;
+        }
+        producer.join();
+        if (!ordered || expect != n) { std::cout << "FAIL: spsc ring order\n"; return 1; }
+    }
+
+    // The pipelined engine gives exactly the serial result
+    auto bars = generate_random_walk(5000, 100.0, 0.0002, 0.01);
+    CostModel costs{0.001, 0.5};
+    RiskControl risk;
+    risk.max_position = 50;
+    risk.max_daily_loss = 2000;
+    OrderBook lob{100, 2, 2, 0.5};
+    MeanReversionStrategy a(20, 0.004, 3), b(20, 0.004, 3);
+    auto ref = AdvancedBacktester::run("X", bars, a, costs, risk, lob);
+    ViewBarSource src(BarView::of(bars));
+    PipelineOptions opt;
+    opt.batch = 7;
+    opt.queue_capacity = 16;
+    std::vector<StageStats> stats;
+    auto got = AdvancedBacktester::run_pipelined("X", src, b, costs, risk, lob, opt, &stats);
+    if (got.equity_curve != ref.equity_curve || got.pnl_series != ref.pnl_series ||
+        got.trades.size() != ref.trades.size() || got.final_equity != ref.final_equity ||
+        got.sharpe != ref.sharpe || got.max_dd != ref.max_dd || got.num_trades != ref.num_trades) {
+        std::cout << "FAIL: pipelined result differs\n"; return 1;
+    }
+    for (std::size_t i = 0; i < ref.trades.size(); ++i) {
+        if (got.trades[i].quantity != ref.trades[i].quantity || got.trades[i].entry_price != ref.trades[i].entry_price) {
+            std::cout << "FAIL: pipelined trades differ\n"; return 1;
+        }
+    }
+    if (stats.size() != 3) { std::cout << "FAIL: stage count\n"; return 1; }
+
+    // The sink streams the curve: every 100th bar plus the last one
+    const char* curve_path = "test_pipeline_curve.csv";
+    MeanReversionStrategy c(20, 0.004, 3);
+    ViewBarSource src2(BarView::of(bars));
+    opt.curve_path = curve_path;
+    opt.curve_every = 100;
+    AdvancedBacktester::run_pipelined("X", src2, c, costs, risk, lob, opt);
+    std::ifstream in(curve_path);
+    std::string line, last;
+    std::size_t lines = 0;
+    while (std::getline(in, line)) { ++lines; last = line; }
+    in.close();
+    std::remove(curve_path);
+    std::ostringstream want;
+    want << bars.size() - 1 << "," << bars.back().ts << "," << ref.equity_curve.back();
+    if (lines != 1 + bars.size() / 100 + 1 || last != want.str()) {
+        std::cout << "FAIL: pipelined curve file\n"; return 1;
+    }
+    for (const auto& st : stats) {
+        if (st.items != bars.size() || st.batches < bars.size() / 7 || st.queue_max > 16) {
+            std::cout << "FAIL: stage stats for " << st.name << "\n"; return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_work_stealing() {
+    // Owner pops while thieves steal: every item is taken exactly once,
+    // including across array growth
+    {
+        const std::size_t n = 50000;
+        ChaseLevDeque<std::size_t> dq(2);
+        std::vector<std::atomic<int>> taken(n);
+        for (auto& t : taken) t.store(0);
+        std::atomic<bool> done{false};
+        std::vector<std::thread> thieves;
+        for (int k = 0; k < 3; ++k) {
+            thieves.emplace_back([&] {
+                Backoff backoff;
+                for (std::size_t x; !done.load();) {
+                    if (dq.steal(x)) { taken[x].fetch_add(1); backoff.reset(); }
+                    else backoff.wait();
+                }
+            });
+        }
+        for (std::size_t i = 0, x; i < n; ++i) {
+            dq.push(i);
+            if (i % 3 == 0 && dq.pop(x)) taken[x].fetch_add(1);
+        }
+        for (std::size_t x; dq.pop(x);) taken[x].fetch_add(1);
+        while (dq.size() > 0) std::this_thread::yield();
+        done.store(true);
+        for (auto& t : thieves) t.join();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (taken[i].load() != 1) { std::cout << "FAIL: deque item " << i << " taken " << taken[i].load() << "x\n"; return 1; }
+        }
+    }
+
+    // Everything seeded on one worker still runs once, whoever runs it
+    {
+        WorkStealingPool pool(4);
+        std::vector<std::atomic<int>> ran(1000);
+        for (auto& r : ran) r.store(0);
+        std::vector<std::vector<std::size_t>> queues(1);
+        for (std::size_t i = 0; i < ran.size(); ++i) queues[0].push_back(i);
+        for (int round = 0; round < 2; ++round) {
+            pool.run(queues, [&](std::size_t j, std::size_t) { ran[j].fetch_add(1); });
+            std::size_t jobs = 0;
+            for (const auto& w : pool.stats()) jobs += w.jobs;
+            if (jobs != ran.size()) { std::cout << "FAIL: pool job count\n"; return 1; }
+        }
+        for (auto& r : ran) if (r.load() != 2) { std::cout << "FAIL: pool ran a job " << r.load() << "x\n"; return 1; }
+    }
+
+    // Workers with nothing left to steal sleep through a long job instead
+    // of spinning: process CPU time stays well under the job's length
+    {
+        WorkStealingPool pool(4);
+        std::vector<std::vector<std::size_t>> queues{{0}};
+        std::clock_t c0 = std::clock();
+        pool.run(queues, [](std::size_t, std::size_t) { std::this_thread::sleep_for(std::chrono::milliseconds(300)); });
+        double cpu = (double)(std::clock() - c0) / CLOCKS_PER_SEC;
+        if (cpu > 0.1) { std::cout << "FAIL: idle pool workers used " << cpu << " s of CPU\n"; return 1; }
+    }
+
+    // Heterogeneous batch: results match serial runs, in job order, for any thread count
+    std::vector<std::vector<Bar>> data;
+    for (int n : {100, 5000, 700, 2500}) data.push_back(generate_random_walk(n, 100.0, 0.0003, 0.01));
+    StrategyFactory factory = [](const std::vector<double>& p) {
+        return std::unique_ptr<Strategy>(new MeanReversionStrategy((int)p[0], p[1], 2));
+    };
+    RiskControl risk;
+    risk.max_position = 40;
+    std::vector<BacktestJob> jobs;
+    for (std::size_t a = 0; a < data.size(); ++a) {
+        for (double lb : {10.0, 20.0, 40.0}) {
+            std::string sym = "S" + std::to_string(a);
+            jobs.push_back({sym + "_" + std::to_string((int)lb), sym, BarView::of(data[a]), factory, {lb, 0.003},
+                            CostModel{0.001, 0.5}, risk, OrderBook{100, 2, 2, 0.5}});
+        }
+    }
+    auto queues = JobScheduler::place(jobs, 3);
+    std::vector<int> where(jobs.size(), -1);
+    for (std::size_t w = 0; w < queues.size(); ++w) {
+        for (std::size_t j : queues[w]) {
+            if (where[j] != -1) { std::cout << "FAIL: job placed twice\n"; return 1; }
+            where[j] = (int)w;
+        }
+    }
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        if (where[j] != where[j - j % 3]) { std::cout << "FAIL: symbol split across workers\n"; return 1; }
+    }
+    for (std::size_t threads : {1, 3}) {
+        SchedulerConfig cfg;
+        cfg.threads = threads;
+        auto got = JobScheduler::run(jobs, cfg);
+        if (got.results.size() != jobs.size() || got.workers.size() != threads || got.utilization() > 1.0) {
+            std::cout << "FAIL: schedule result shape\n"; return 1;
+        }
+        for (std::size_t j = 0; j < jobs.size(); ++j) {
+            auto strat = factory(jobs[j].params);
+            auto ref = AdvancedBacktester::run(jobs[j].name, jobs[j].bars, *strat, jobs[j].costs, jobs[j].risk, jobs[j].lob);
+            const auto& r = got.results[j];
+            if (r.asset != ref.asset || r.equity_curve != ref.equity_curve || r.num_trades != ref.num_trades || r.sharpe != ref.sharpe) {
+                std::cout << "FAIL: scheduled job " << j << " differs (threads=" << threads << ")\n"; return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Feeds bars [from, to) and returns the trades; ctx carries over between calls
+static std::vector<Trade> feed(Strategy& s, const std::vector<Bar>& bars, std::size_t from, std::size_t to, StrategyContext& ctx) {
+    std::vector<Trade> out;
+    for (std::size_t i = from; i < to; ++i) s.on_bar(bars[i], ctx, out);
+    return out;
+}
+
+static int test_strategy_state() {
+    auto bars = generate_random_walk(3000, 100.0, 0.0, 0.01);
+    const std::size_t half = 1500;
+    MomentumStrategy mom_proto(25, 2);
+    MeanReversionStrategy mr_proto(30, 0.003, 2);
+    for (const Strategy* proto : {(const Strategy*)&mom_proto, (const Strategy*)&mr_proto}) {
+        auto a = proto->clone();
+        StrategyContext ctx;
+        feed(*a, bars, 0, half, ctx);
+
+        // A clone, and a fresh instance restored from a snapshot, continue
+        // exactly like the original
+        auto b = a->clone();
+        auto c = proto->clone();
+        if (!c->restore(a->snapshot())) { std::cout << "FAIL: " << proto->name() << " restore\n"; return 1; }
+        StrategyContext cb = ctx, cc = ctx;
+        auto ta = feed(*a, bars, half, bars.size(), ctx);
+        auto tb = feed(*b, bars, half, bars.size(), cb);
+        auto tc = feed(*c, bars, half, bars.size(), cc);
+        if (ta.empty() || !same_trades(ta, tb) || !same_trades(ta, tc)) {
+            std::cout << "FAIL: " << proto->name() << " clone/snapshot continuation\n"; return 1;
+        }
+
+        // reset() is a fresh start
+        a->reset();
+        StrategyContext c1, c2;
+        auto fresh = proto->clone();
+        if (!same_trades(feed(*a, bars, 0, bars.size(), c1), feed(*fresh, bars, 0, bars.size(), c2))) {
+            std::cout << "FAIL: " << proto->name() << " reset\n"; return 1;
+        }
+    }
+
+    // Mismatched or damaged snapshots are refused and change nothing
+    MomentumStrategy m(25, 2), other_lb(26, 2);
+    StrategyContext ctx;
+    feed(m, bars, 0, half, ctx);
+    StrategyState state = m.snapshot();
+    StrategyState cut(state.begin(), state.end() - 3);
+    MomentumStrategy target(25, 2);
+    feed(target, bars, 0, 100, ctx);
+    StrategyState before = target.snapshot();
+    if (other_lb.restore(state) || mr_proto.clone()->restore(state) || target.restore(cut) || target.snapshot() != before) {
+        std::cout << "FAIL: bad snapshot accepted\n"; return 1;
+    }
+
+    // clone_factory hands out reset copies, whatever the prototype has seen
+    MomentumStrategy dirty(30, 5);
+    StrategyContext dctx;
+    feed(dirty, bars, 0, 2000, dctx);
+    StrategyFactory make = clone_factory(dirty);
+    auto x = make({});
+    MomentumStrategy clean(30, 5);
+    StrategyContext c1, c2;
+    if (!same_trades(feed(*x, bars, 0, bars.size(), c1), feed(clean, bars, 0, bars.size(), c2))) {
+        std::cout << "FAIL: clone_factory carries state\n"; return 1;
+    }
+    return 0;
+}
+
+// A run checkpointed part way and resumed over the remaining bars reports
+// exactly what one run over all of them does
+static int test_checkpoint() {
+    auto bars = generate_random_walk(4000, 100.0, 0.0002, 0.01);
+    const std::size_t k = 2600;
+    BarView all = BarView::of(bars);
+    RiskControl risk;
+    risk.max_position = 100;
+    risk.stop_loss_pct = 0.02;
+    risk.take_profit_pct = 0.05;
+    risk.max_daily_loss = 2000;
+    risk.use_vol_scaling = true;
+    OrderBook lob{100.0, 2.0, 2.0, 0.5};
+    CostModel costs{0.001, 0.5};
+
+    MomentumStrategy full_s(30, 5);
+    auto full = AdvancedBacktester::run("X", all, full_s, costs, risk, lob);
+
+    MomentumStrategy s1(30, 5);
+    AdvancedCheckpoint cp;
+    auto head = AdvancedBacktester::run("X", all.slice(0, k), s1, costs, risk, lob, &cp);
+    const char* path = "test_checkpoint_tmp.hftk";
+    AdvancedCheckpoint loaded;
+    bool io_ok = cp.write(path) && loaded.read(path) && loaded.bytes == cp.bytes;
+    std::remove(path);
+    if (!io_ok) { std::cout << "FAIL: checkpoint file round trip\n"; return 1; }
+
+    // A fresh strategy; its state comes from the checkpoint
+    MomentumStrategy s2(30, 5);
+    AssetBacktest tail;
+    if (!AdvancedBacktester::resume("X", all.slice(k, bars.size() - k), s2, costs, risk, lob, loaded, tail)) {
+        std::cout << "FAIL: resume refused\n"; return 1;
+    }
+    std::vector<double> eq = head.equity_curve;
+    eq.insert(eq.end(), tail.equity_curve.begin(), tail.equity_curve.end());
+    std::vector<Trade> trades = head.trades;
+    trades.insert(trades.end(), tail.trades.begin(), tail.trades.end());
+    if (full.trades.empty() || eq.size() != full.equity_curve.size() ||
+        std::memcmp(eq.data(), full.equity_curve.data(), eq.size() * sizeof(double)) != 0 ||
+        !same_trades(trades, full.trades) || tail.num_trades != full.num_trades ||
+        tail.final_equity != full.final_equity || tail.sharpe != full.sharpe || tail.max_dd != full.max_dd ||
+        tail.metrics.sortino(252.0) != full.metrics.sortino(252.0)) {
+        std::cout << "FAIL: resumed run differs from full run\n"; return 1;
+    }
+
+    // The checkpoint moved to the end: appending nothing keeps the totals,
+    // overlapping bars, another strategy or damaged bytes are refused
+    AssetBacktest none;
+    MomentumStrategy s3(30, 5), s4(30, 5);
+    MeanReversionStrategy other(20, 0.004, 3);
+    AdvancedCheckpoint cut = loaded;
+    cut.bytes.pop_back();
+    AssetBacktest untouched;
+    if (!AdvancedBacktester::resume("X", all.slice(0, 0), s3, costs, risk, lob, loaded, none) ||
+        none.final_equity != full.final_equity || none.num_trades != full.num_trades ||
+        AdvancedBacktester::resume("X", all.slice(bars.size() - 10, 10), s4, costs, risk, lob, loaded, untouched) ||
+        AdvancedBacktester::resume("X", all.slice(0, 0), other, costs, risk, lob, loaded, untouched) ||
+        AdvancedBacktester::resume("X", all.slice(0, 0), s4, costs, risk, lob, cut, untouched) ||
+        !untouched.equity_curve.empty()) {
+        std::cout << "FAIL: checkpoint append checks\n"; return 1;
+    }
+    return 0;
+}
+
+// The array engine holds the same positions as the event loop when the
+// strategy is a function of prices: momentum and mean reversion as
+// target series
+static int test_vector_backtester() {
+    auto bars = generate_random_walk(5003, 100.0, 0.0001, 0.01);
+    std::vector<double> close;
+    for (const auto& b : bars) close.push_back(b.close);
+    auto same_run = [](const BacktestResult& vec, const BacktestResult& ref) {
+        return !ref.trades.empty() && same_trades(vec.trades, ref.trades) &&
+               vec.equity_curve.size() == ref.equity_curve.size() &&
+               std::memcmp(vec.equity_curve.data(), ref.equity_curve.data(), ref.equity_curve.size() * sizeof(double)) == 0 &&
+               vec.final_equity == ref.final_equity && vec.drawdown == ref.drawdown &&
+               close_to(vec.sharpe, ref.sharpe) && close_to(vec.metrics.sortino(), ref.metrics.sortino()) &&
+               vec.metrics.win_rate() == ref.metrics.win_rate() &&
+               vec.metrics.profit_factor() == ref.metrics.profit_factor() &&
+               vec.metrics.max_drawdown_bars() == ref.metrics.max_drawdown_bars() &&
+               vec.metrics.total_return() == ref.metrics.total_return();
+    };
+    for (int lookback : {2, 20, 60}) {
+        for (CostModel costs : {CostModel{}, CostModel{0.001, 0.5}}) {
+            std::vector<double> signal(close.size(), std::nan(""));
+            for (std::size_t i = lookback - 1; i < close.size(); ++i) signal[i] = close[i] - close[i - lookback + 1];
+            MomentumStrategy mom(lookback, 3);
+            if (!same_run(VectorBacktester::run(bars, targets_from_signal(signal, 3), costs), Backtester::run(bars, mom, costs))) {
+                std::cout << "FAIL: vector backtester vs event loop, momentum " << lookback << "\n"; return 1;
+            }
+
+            std::vector<double> avg = sma(close, lookback);
+            for (std::size_t i = 0; i < close.size(); ++i) {
+                double dev = (close[i] - avg[i]) / avg[i];
+                signal[i] = dev > 0.004 ? -1.0 : dev < -0.004 ? 1.0 : 0.0;
+            }
+            MeanReversionStrategy mr(lookback, 0.004, 2);
+            if (!same_run(VectorBacktester::run(bars, targets_from_signal(signal, 2), costs), Backtester::run(bars, mr, costs))) {
+                std::cout << "FAIL: vector backtester vs event loop, mean reversion " << lookback << "\n"; return 1;
+            }
+        }
+    }
+
+    // Zero and NaN hold, reversals go flat first; a short target list
+    // stops the run
+    std::vector<int> t = targets_from_signal({std::nan(""), 0.0, 1.5, 2.0, 0.0, std::nan(""), -2.0, -1.0, 1.0}, 2);
+    if (t != std::vector<int>{0, 0, 2, 2, 2, 2, 0, -2, 0}) { std::cout << "FAIL: targets_from_signal\n"; return 1; }
+    auto short_run = VectorBacktester::run(bars, t);
+    auto none = VectorBacktester::run(bars, {});
+    if (short_run.equity_curve.size() != t.size() || short_run.trades.size() != 4 ||
+        short_run.trades[1].quantity != -2 || !none.equity_curve.empty() || none.final_equity != 100000.0) {
+        std::cout << "FAIL: vector backtester edge cases\n"; return 1;
+    }
+    return 0;
+}
+
+int main() {
+    int fails = 0;
+    fails += test_backtester_basic();
+    fails += test_load_csv_mmap();
+    fails += test_bar_store();
+    fails += test_streaming();
+    fails += test_parameter_sweep();
+    fails += test_rolling_volatility();
+    fails += test_streaming_indicators();
+    fails += test_simd_kernels();
+    fails += test_bar_columns();
+    fails += test_portfolio_backtester();
+    fails += test_limit_order_book();
+    fails += test_itch_feed();
+    fails += test_hot_loop_allocations();
+    fails += test_backtester_template();
+    fails += test_batch_momentum();
+    fails += test_walk_forward();
+    fails += test_monte_carlo();
+    fails += test_metrics_accumulator();
+    fails += test_report_writer();
+    fails += test_profiler();
+    fails += test_pipeline();
+    fails += test_work_stealing();
+    fails += test_strategy_state();
+    fails += test_checkpoint();
+    fails += test_vector_backtester();
+    if (fails) return 1;
     std::cout << "OK: tests passed\n";
     return 0;
 }